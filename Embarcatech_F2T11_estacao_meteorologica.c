@@ -8,10 +8,34 @@
 #include "hardware/pwm.h"
 #include "hardware/timer.h"
 #include "hardware/pio.h"
-#include "ws2812.pio.h"
+#include "hardware/sync.h"
 #include "aht20.h"
 #include "bmp280.h"
 #include "ssd1306.h"
+#include "telemetria_udp.h"
+#include "mqtt_cliente.h"
+#include "metricas.h"
+#include "trace.h"
+#include "log.h"
+#include "agendador.h"
+#include "i2c_fila.h"
+#include "sensores.h"
+#include "filtros.h"
+#include "amostragem.h"
+#include "alertas.h"
+#include "matriz.h"
+#include "tendencia.h"
+#include "derivadas.h"
+#include "gravacao.h"
+#include "telas.h"
+#include "http.h"
+#include "servidor_http.h"
+#include "memoria.h"
+#include "vigia.h"
+#include "conexao.h"
+#include "configuracao.h"
+#include "amostra.h"
+#include "estacao.h"
 #include "font.h"
 #include <math.h>
 #include "pico/bootrom.h"
@@ -28,15 +52,10 @@
 #define I2C_SDA 0 // Define o pino SDA na GPIO 0
 #define I2C_SCL 1 // Define o pino SCL na GPIO 1
 
-#define SEA_LEVEL_PRESSURE 101325.0 // Pressão ao nível do mar em Pa
-
-// Estrutura para o BMP 280
-struct bmp280_calib_param params;
-
-// Estrutura para o AHT10
-AHT20_Data data;
-int32_t raw_temp_bmp;
-int32_t raw_pressure;
+#define SEA_LEVEL_PRESSURE 101325.0f // Pressão ao nível do mar em Pa (referência da altitude estimada)
+#ifndef ALTITUDE_ESTACAO_M
+#define ALTITUDE_ESTACAO_M 0.0f // Altitude da estação (redução da pressão ao nível do mar)
+#endif
 
 // Porta I2C que está conectado o Display OLED (I2C1 e GPIOs 14 e 15)
 #define display_i2c_port i2c1 // Define a porta I2C1
@@ -45,30 +64,64 @@ int32_t raw_pressure;
 #define display_i2c_endereco 0x3C // Define o endereço I2C do Display
 ssd1306_t ssd; // Inicializa a estrutura do display
 
+// Transações I2C atendidas pela fila de cada controlador (DMA + interrupção)
+#define OLED_BLOCO 128 // Bytes do quadro por transação (uma leitura de sensor nunca espera o quadro inteiro)
+#define OLED_BLOCOS (WIDTH * HEIGHT / 8 / OLED_BLOCO)
+
+// Janela de escrita do display (colunas 0-127, páginas 0-7) seguida do quadro em blocos
+static const uint8_t oled_janela[6] = {SET_COL_ADDR, 0, WIDTH - 1, SET_PAGE_ADDR, 0, HEIGHT / 8 - 1};
+static i2c_transacao_t trans_oled_janela = {
+    .endereco = display_i2c_endereco, .prioridade = I2C_PRIORIDADE_BAIXA,
+    .cabecalho = {0x00}, .n_cabecalho = 1, .tx = oled_janela, .n_tx = sizeof(oled_janela)
+};
+static i2c_transacao_t trans_oled_quadro[OLED_BLOCOS];
+
 // GPIO
 #define button_A 5 // Botão A GPIO 5
 #define button_B 6 // Botão B GPIO 6
 #define button_J 22 // Botão do Joystick GPIO 22
 #define matriz_leds 7 // Matriz de LEDs GPIO 7
-#define NUM_LEDS 25 // Número de LEDs na matriz
 #define LED_Green 11 // LED Verde GPIO 11
 #define LED_Blue 12 // LED Azul GPIO 12
 #define LED_Red 13 // LED Vermelho GPIO 13
 #define buzzer_A 21 // Buzzer A GPIO 21
 #define buzzer_B 10 // Buzzer B GPIO 10
 
+// Modo de economia de energia (estações solares/bateria): períodos mais longos e Wi-Fi em power-save
+#ifndef MODO_ECONOMIA
+#define MODO_ECONOMIA 0
+#endif
+
+// Períodos das tarefas do agendador
+#if MODO_ECONOMIA
+#define PERIODO_REDE_MS 100 // Serviço da rede (lwIP/MQTT)
+#define PERIODO_AMOSTRAGEM_MS 5000 // Leitura dos sensores (período mínimo)
+#define PERIODO_AMOSTRAGEM_MAX_MS 600000 // Período máximo com os sinais estáveis
+#define PERIODO_DISPLAY_MS 1000 // Redesenho do display OLED
+#define PERIODO_OCIOSA_MS 500 // Log e comandos pela USB
+#define WIFI_PM CYW43_AGGRESSIVE_PM // Rádio dorme entre os beacons
+#else
+#define PERIODO_REDE_MS 20 // Serviço da rede (lwIP/MQTT)
+#define PERIODO_AMOSTRAGEM_MS 300 // Leitura dos sensores (período mínimo)
+#define PERIODO_AMOSTRAGEM_MAX_MS 60000 // Período máximo com os sinais estáveis
+#define PERIODO_DISPLAY_MS 250 // Redesenho do display OLED
+#define PERIODO_OCIOSA_MS 100 // Log e comandos pela USB
+#define WIFI_PM CYW43_PERFORMANCE_PM
+#endif
+
+// Prazos dos sinais de vida (lib/vigia)
+#define PRAZO_VIGIA_REDE_MS 3000 // Serviço da rede (cyw43_arch_poll, MQTT e o cyw43_arch_init na primeira vez)
+#define PRAZO_VIGIA_FOLGA_MS 1000 // Somada a múltiplos do período das outras atividades
+#define PRAZO_VIGIA_DISPLAY_MS (4 * PERIODO_DISPLAY_MS + PRAZO_VIGIA_FOLGA_MS)
+
 
 // -- Definição de variáveis globais
 
 static volatile uint32_t last_time = 0; // Armazena o tempo do último clique dos botões (debounce)
 
-volatile int32_t pressao = 0; // Armazena o valor da pressão medido pelo BMP280
-volatile double altitude = 0; // Armazena o valor de altitude calculado
-
-volatile float temperatura_final = 0; // Armazena o valor final da temperatura
-volatile float pressao_final = 0; // Armazena o valor final da pressão
-volatile float altitude_final = 0; // Armazena o valor final da altitude
-volatile float umidade_final = 0; // Armazena o valor final da umidade
+// Filtros, valores finais, tendência e regras de alerta ficam em lib/estacao (o mesmo código do tools/replay.c).
+// Só a coleta calcula a amostra corrente; os outros contextos (HTTP, display, alertas) leem a amostra publicada
+// com amostra_ler
 
 volatile float temperatura_offset = 0; // Armazena o valor do offset da temperatura
 volatile float pressao_offset = 0; // Armazena o valor do offset da pressão
@@ -80,21 +133,53 @@ volatile float temperatura_max = 35.0; // Armazena o valor de temperatura máxim
 volatile float umidade_min = 30.0; // Armazena o valor de umidade mínima
 volatile float umidade_max = 70.0; // Armazena o valor de umidade máxima
 
-volatile int tela = 1; // Armazena qual a tela está ativada no momento
+volatile int tela = TELA_GERAL; // Armazena qual a tela está ativada no momento (começa nos dados: o Wi-Fi conecta depois)
 volatile int text_wifi = 1; // Armazena qual texto do Wi-Fi será mostrado no display
 
-char str_ip[24];
-
-char str_temperatura[5]; // Armazena o valor da temperatura em string
-char str_pressao[6]; // Armazena o valor da pressão em string
-char str_altitude[5]; // Armazena o valor da altitude em string
-char str_umidade[5]; // Armazena o valor da umidade em string
+// Marcos do boot em /boot (µs desde o reset; 0 = ainda não aconteceu)
+typedef enum {
+    BOOT_DISPLAY,           // Primeiro quadro no OLED
+    BOOT_PRIMEIRA_AMOSTRA,  // Primeira coleta dos sensores concluída
+    BOOT_WIFI,              // Enlace Wi-Fi com IP
+    BOOT_PRIMEIRA_RESPOSTA, // Primeira resposta HTTP montada
+    BOOT_MARCOS
+} marco_boot_t;
+static uint64_t marcos_boot[BOOT_MARCOS];
+
+static int tarefa_amostra = -1; // Id da tarefa de amostragem no agendador
+static int tarefa_matriz = -1; // Id da tarefa da matriz de LEDs no agendador
+static int tarefa_display = -1; // Id da tarefa do display no agendador
+static int tarefa_coleta = -1; // Id da tarefa que recolhe as leituras dos sensores
+static int vigia_rede = -1; // Atividades supervisionadas pelo watchdog (lib/vigia)
+static int vigia_amostragem = -1;
+static int vigia_display = -1;
+
+static uint32_t intervalo_amostra_ms = 0; // Intervalo real desde a amostra anterior (0 = primeira)
+static bool coleta_pendente = false; // Sensores disparados, coleta ainda não executada
+
+// Pedidos de configuração recebidos por HTTP (contexto do lwIP). Só ficam registrados aqui: sensores,
+// amostragem adaptativa, agendador e derivadas são alterados pelo laço principal entre dois ciclos de leitura
+// (aplicar_pedidos)
+static volatile bool bmp280_pedido = false;
+static bmp280_config_t bmp280_config_pedida;
+static volatile bool periodo_pedido = false; // Limites da amostragem adaptativa (iguais = período fixo)
+static uint32_t periodo_pedido_min_ms, periodo_pedido_max_ms;
+static volatile bool altitude_pedida = false; // Altitude da estação (lib/derivadas só muda na coleta)
+static float altitude_pedida_m;
+static uint64_t instante_amostra_us = 0; // Instante da última coleta (tendência, alertas e gravação usam o mesmo)
+static int canal_temperatura = -1, canal_umidade = -1, canal_pressao = -1; // Canais da amostragem adaptativa
+
+static int sensor_bmp280 = -1; // Sensor de pressão usado no display e na telemetria
+static int sensor_aht20 = -1; // Sensor de temperatura/umidade usado no display e na telemetria
 
-char str_temperatura_min[5]; // Armazena o valor de temperatura mínima em string
-char str_temperatura_max[5]; // Armazena o valor de temperatura máxima em string
-char str_umidade_min[5]; // Armazena o valor de umidade mínima em string
-char str_umidade_max[5]; // Armazena o valor de umidade máxima em string
+char str_ip[24];
 
+static void marcar_boot(marco_boot_t marco){
+    if(!marcos_boot[marco]){
+        marcos_boot[marco] = time_us_64();
+        LOG(LOG_BOOT_MARCO, marco, (uint32_t)(marcos_boot[marco] / 1000));
+    }
+}
 
 
 // --- Inicio das funções necessárias para a manipulação do buzzer
@@ -103,8 +188,11 @@ void pwm_buzzer(uint gpio, bool active); // Esta função precisa ser declarada
 
 // Função de callback do alarme do buzzer
 int64_t alarm_callback_buzzer(alarm_id_t id, void *user_data){
+    MEMORIA_SONDA_IRQ();
+    TRACE_INICIO(TR_ALARME_BUZZER);
     pwm_buzzer(buzzer_A, false);
     pwm_buzzer(buzzer_B, false);
+    TRACE_FIM(TR_ALARME_BUZZER);
     return 0;
 }
 
@@ -132,277 +220,289 @@ void beep_buzzer(uint time){
     add_alarm_in_ms(time, alarm_callback_buzzer, NULL, false);
 }
 
+// Sequência de bipes de um alerta (cada alarme desliga ou religa o buzzer até acabar a sequência)
+static alerta_buzzer_t buzzer_padrao;
+static uint8_t buzzer_bipes = 0; // Bipes que ainda faltam terminar
+static bool buzzer_ligado = false;
+
+int64_t alarm_callback_padrao(alarm_id_t id, void *user_data){
+    MEMORIA_SONDA_IRQ();
+    buzzer_ligado = !buzzer_ligado;
+    if(!buzzer_ligado){
+        buzzer_bipes--;
+    }
+    if(buzzer_bipes == 0){
+        buzzer_ligado = false;
+    }
+    pwm_buzzer(buzzer_A, buzzer_ligado);
+    pwm_buzzer(buzzer_B, buzzer_ligado);
+    if(buzzer_bipes == 0){
+        return 0;
+    }
+    uint32_t espera_ms = buzzer_ligado ? buzzer_padrao.duracao_ms : buzzer_padrao.intervalo_ms;
+    return (int64_t)(espera_ms ? espera_ms : 1) * 1000;
+}
+
+void tocar_padrao_buzzer(const alerta_buzzer_t *p){
+    if(p->bipes == 0 || buzzer_bipes){
+        return; // Uma sequência por vez
+    }
+    buzzer_padrao = *p;
+    buzzer_bipes = p->bipes;
+    buzzer_ligado = true;
+    pwm_buzzer(buzzer_A, true);
+    pwm_buzzer(buzzer_B, true);
+    add_alarm_in_ms(p->duracao_ms, alarm_callback_padrao, NULL, false);
+}
+
 // --- Final das funções necessárias para a manipulação do buzzer
 
 
 
 // --- Funções necessária para a manipulação da matriz de LEDs
 
-// Estrutura do pixel GRB (Padrão do WS2812)
-struct pixel_t {
-    uint8_t G, R, B; // Define variáveis de 8-bits (0 a 255) para armazenar a cor
+// Cores dos quadros (palavras GRB prontas para a DMA)
+#define M_ 0
+#define MV MATRIZ_GRB(150, 0, 0)   // Vermelho
+#define MG MATRIZ_GRB(0, 150, 0)   // Verde
+#define MA MATRIZ_GRB(150, 100, 0) // Amarelo
+
+static const matriz_quadro_t quadros_ok[] = {
+    MATRIZ_QUADRO(M_, M_, M_, M_, M_,
+                  M_, M_, M_, M_, MG,
+                  M_, M_, M_, MG, M_,
+                  MG, M_, MG, M_, M_,
+                  M_, MG, M_, M_, M_), // "Check"
 };
-typedef struct pixel_t pixel_t;
-typedef pixel_t npLED_t; // Permite declarar variáveis utilizando apenas "npLED_t"
-
-// Declaração da Array que representa a matriz de LEDs
-npLED_t leds[NUM_LEDS];
 
-// Variáveis para máquina PIO
-PIO np_pio;
-uint sm;
-
-// Função para definir a cor de um LED específico
-void cor(const uint index, const uint8_t r, const uint8_t g, const uint8_t b) {
-    leds[index].R = r;
-    leds[index].G = g;
-    leds[index].B = b;
-}
+static const matriz_quadro_t quadros_alerta[] = {
+    MATRIZ_QUADRO(M_, M_, MV, M_, M_,
+                  M_, M_, MV, M_, M_,
+                  M_, M_, MV, M_, M_,
+                  M_, M_, M_, M_, M_,
+                  M_, M_, MV, M_, M_), // "!"
+    MATRIZ_QUADRO(M_, M_, M_, M_, M_,
+                  M_, M_, M_, M_, M_,
+                  M_, M_, M_, M_, M_,
+                  M_, M_, M_, M_, M_,
+                  M_, M_, M_, M_, M_), // Apagado (pisca)
+};
 
-// Função para desligar todos os LEDs
-void desliga() {
-    for (uint i = 0; i < NUM_LEDS; ++i) {
-        cor(i, 0, 0, 0);
-    }
-}
+static const matriz_quadro_t quadros_pressao[] = {
+    MATRIZ_QUADRO(M_, M_, MA, M_, M_,
+                  M_, M_, MA, M_, M_,
+                  MA, M_, MA, M_, MA,
+                  M_, MA, MA, MA, M_,
+                  M_, M_, MA, M_, M_), // Seta para baixo
+    MATRIZ_QUADRO(M_, M_, M_, M_, M_,
+                  M_, M_, MA, M_, M_,
+                  M_, M_, MA, M_, M_,
+                  MA, M_, MA, M_, MA,
+                  M_, MA, MA, MA, M_), // Seta descendo
+};
 
-// Função para enviar o estado atual dos LEDs ao hardware  - buffer de saída
-void buffer() {
-    for (uint i = 0; i < NUM_LEDS; ++i) {
-        pio_sm_put_blocking(np_pio, sm, leds[i].G);
-        pio_sm_put_blocking(np_pio, sm, leds[i].R);
-        pio_sm_put_blocking(np_pio, sm, leds[i].B);
-    }
-}
+#undef M_
+#undef MV
+#undef MG
+#undef MA
 
-// Função para converter a posição da matriz para uma posição do vetor.
-int getIndex(int x, int y) {
-    // Se a linha for par (0, 2, 4), percorremos da esquerda para a direita.
-    // Se a linha for ímpar (1, 3), percorremos da direita para a esquerda.
-    if (y % 2 == 0) {
-        return 24-(y * 5 + x); // Linha par (esquerda para direita).
-    } else {
-        return 24-(y * 5 + (4 - x)); // Linha ímpar (direita para esquerda).
-    }
-}
+// Padrões indexados por PADRAO_*
+static const matriz_padrao_t padroes_matriz[] = {
+    [PADRAO_OK] = { quadros_ok, 1, 0 },
+    [PADRAO_ALERTA] = { quadros_alerta, 2, 500 },
+    [PADRAO_PRESSAO] = { quadros_pressao, 2, 700 },
+};
 
 // --- Final das funções necessária para a manipulação da matriz de LEDs
 
 
 // -- Funções
 
-// Função que calcula a altitude do local com base no valor da pressão
-double calculo_altitude(double pressao){
-    return 44330.0 * (1.0 - pow(pressao / SEA_LEVEL_PRESSURE, 0.1903));
-}
 
-// Função para fazer a leitura do sensor BMP280
+// Função para fazer a leitura do sensor BMP280 (último resultado recolhido pelo registro de sensores)
 void ler_bmp280(){
-    // Leitura do BMP280
-    bmp280_read_raw(I2C_PORT, &raw_temp_bmp, &raw_pressure);
-    int32_t temperatura = bmp280_convert_temp(raw_temp_bmp, &params);
-    pressao = bmp280_convert_pressure(raw_pressure, raw_temp_bmp, &params);
-
-    // Cálculo da altitude
-    altitude = calculo_altitude(pressao);
-
-    printf("Pressao = %.3f kPa\n", pressao / 1000.0);
-    printf("Temperatura BMP: = %.2f C\n", temperatura / 100.0);
-    printf("Altitude estimada: %.2f m\n", altitude);  
+    const sensor_t *b = sensores_obter(sensor_bmp280);
+    if(!b || !b->valido || !b->novas){
+        return; // Mantém a última leitura válida (sem conversão nova desde a leitura anterior)
+    }
+    estacao_pressao(b->pressao);
+    LOG(LOG_BMP280, log_f(b->pressao / 1000.0f), log_f(b->temperatura));
 }
 
-// Função para fazer a leitura do sensor AHT10
+// Função para fazer a leitura do sensor AHT10 (último resultado recolhido pelo registro de sensores)
 void ler_aht10(){
-    // Leitura do AHT20
-    if(aht20_read(I2C_PORT, &data)){
-        printf("Temperatura AHT: %.2f C\n", data.temperature);
-        printf("Umidade: %.2f %%\n\n\n", data.humidity);
+    const sensor_t *a = sensores_obter(sensor_aht20);
+    if(a && a->valido){
+        estacao_temperatura_umidade(a->temperatura, a->umidade);
+        LOG(LOG_AHT20, log_f(a->temperatura), log_f(a->umidade));
     }else{
-        printf("Erro na leitura do AHT10!\n\n\n");
+        LOG(LOG_AHT20_ERRO);
     }
 }
 
-// Função para atualizar as informações do display
-void atualizar_display(){
-    ssd1306_fill(&ssd, false); // Limpa o display
-    ssd1306_rect(&ssd, 0, 0, 127, 63, true, false); // Borda principal
-
-    if(tela == 1){ // TELA 1 - INICIAL
-        // Cabeçalho
-        ssd1306_draw_string(&ssd, "EMB ESTACAO", 20, 3); // Desenha uma string
-        ssd1306_draw_string(&ssd, "METEOROLOGICA", 12, 12); // Desenha uma string
-
-        ssd1306_line(&ssd, 1, 21, 126, 21, true); // Desenha uma linha horizontal
-
-        // Status da conexão Wi-Fi
-        ssd1306_draw_string(&ssd, "Conexao Wi-Fi:", 8, 23); // Desenha uma string
-        if(text_wifi == 1){
-            ssd1306_draw_string(&ssd, "Iniciando...", 16, 32); // Desenha uma string    
-        }else if(text_wifi == 2){
-            ssd1306_draw_string(&ssd, "Conectando...", 12, 32); // Desenha uma string
-        }else if(text_wifi == 3){
-            ssd1306_draw_string(&ssd, "Falha!", 40, 32); // Desenha uma string
-        }else if(text_wifi == 4){
-            ssd1306_draw_string(&ssd, "Conectado!", 24, 32); // Desenha uma string
-        }else{
-            ssd1306_draw_string(&ssd, "Erro!", 44, 32); // Desenha uma string
-        }
-
-        ssd1306_line(&ssd, 1, 41, 126, 41, true); // Desenha uma linha horizontal
-
-        // IP do WebServer
-        ssd1306_draw_string(&ssd, "IP Web Server:", 8, 43); // Desenha uma string
-        ssd1306_draw_string(&ssd, str_ip, 16, 52); // Desenha uma string
-
-    }else if(tela == 2){ // TELA 2 - GERAL
-        // Cabeçalho
-        ssd1306_draw_string(&ssd, "Dados do local:", 4, 3); // Desenha uma string
-
-        ssd1306_line(&ssd, 1, 12, 126, 12, true); // Desenha uma linha horizontal
-
-        // Temperatura
-        sprintf(str_temperatura, "%.1fC", temperatura_final);  // Converte o float em string
-        ssd1306_draw_string(&ssd, "Tem:", 4, 15); // Desenha uma string
-        ssd1306_draw_string(&ssd, str_temperatura, 40, 15); // Desenha uma string
+// Fim do último bloco do quadro (executada na interrupção do I2C)
+static void oled_quadro_enviado(i2c_transacao_t *t){
+    metricas_observar(MH_SSD1306_ENVIO, t->fim_us - trans_oled_janela.inicio_us);
+}
 
-        ssd1306_line(&ssd, 1, 25, 126, 25, true); // Desenha uma linha horizontal
+// Enfileira a janela e o quadro no i2c1; o quadro precisa ficar intacto até o último bloco
+static bool enviar_quadro_oled(const uint8_t *quadro){
+    if(!i2c_fila_enviar(display_i2c_port, &trans_oled_janela)){
+        return false;
+    }
+    for(int i = 0; i < OLED_BLOCOS; i++){
+        i2c_transacao_t *t = &trans_oled_quadro[i];
+        t->endereco = display_i2c_endereco;
+        t->prioridade = I2C_PRIORIDADE_BAIXA;
+        t->cabecalho[0] = 0x40; // Byte de controle: dados
+        t->n_cabecalho = 1;
+        t->tx = quadro + 1 + i * OLED_BLOCO; // quadro[0] é o byte de controle do envio bloqueante
+        t->n_tx = OLED_BLOCO;
+        t->callback = i == OLED_BLOCOS - 1 ? oled_quadro_enviado : NULL;
+        if(!i2c_fila_enviar(display_i2c_port, t)){
+            return false;
+        }
+    }
+    return true;
+}
 
-        // Pressão
-        sprintf(str_pressao, "%.2fkPa", pressao_final);  // Converte o float em string
-        ssd1306_draw_string(&ssd, "Pre:", 4, 28); // Desenha uma string
-        ssd1306_draw_string(&ssd, str_pressao, 40, 28); // Desenha uma string
+static bool oled_ocupado(){
+    if(!i2c_fila_livre(&trans_oled_janela)){
+        return true;
+    }
+    for(int i = 0; i < OLED_BLOCOS; i++){
+        if(!i2c_fila_livre(&trans_oled_quadro[i])){
+            return true;
+        }
+    }
+    return false;
+}
 
-        ssd1306_line(&ssd, 1, 38, 126, 38, true); // Desenha uma linha horizontal
+// Grandezas sem leitura válida no último ciclo (AMOSTRA_VELHA_*): mantêm o último valor
+static uint8_t grandezas_velhas(){
+    const sensor_t *b = sensores_obter(sensor_bmp280);
+    const sensor_t *a = sensores_obter(sensor_aht20);
+    uint8_t velhos = 0;
+    if(!b || !b->valido){
+        velhos |= AMOSTRA_VELHA_PRESSAO;
+    }
+    if(!a || !a->valido){
+        velhos |= AMOSTRA_VELHA_TEMPERATURA | AMOSTRA_VELHA_UMIDADE;
+    }
+    return velhos;
+}
 
-        // Altitude
-        sprintf(str_altitude, "%.0fm", altitude_final);  // Converte o float em string
-        ssd1306_draw_string(&ssd, "Alt:", 4, 41); // Desenha uma string
-        ssd1306_draw_string(&ssd, str_altitude, 40, 41); // Desenha uma string
+// Função para atualizar as informações do display
+void atualizar_display(){
+    static amostra_derivadas_t derivadas; // Só as telas que mostram derivadas as calculam
+    amostra_t a;
+    amostra_ler(&a);
+    telas_dados_t dados = {
+        .temperatura = a.temperatura, .pressao_kpa = a.pressao_kpa, .altitude = a.altitude, .umidade = a.umidade,
+        .temperatura_min = temperatura_min, .temperatura_max = temperatura_max,
+        .umidade_min = umidade_min, .umidade_max = umidade_max,
+        .wifi = text_wifi, .ip = str_ip,
+        .alerta_temperatura = alertas_ativo(REGRA_TEMP_ALTA) ? 1 : alertas_ativo(REGRA_TEMP_BAIXA) ? -1 : 0,
+        .alerta_umidade = alertas_ativo(REGRA_UMI_ALTA) ? 1 : alertas_ativo(REGRA_UMI_BAIXA) ? -1 : 0,
+        .velhos = a.velhos,
+        .amostra = &a, .derivadas = &derivadas,
+    };
+    telas_desenhar(&ssd, tela, &dados); // Só desenha no buffer
+
+    // Só transfere o quadro pelo I2C quando o conteúdo mudou
+    static uint8_t ultimo_quadro[WIDTH * HEIGHT / 8 + 1];
+    static bool quadro_valido = false;
+    if(quadro_valido && memcmp(ultimo_quadro, ssd.ram_buffer, ssd.bufsize) == 0){
+        return;
+    }
 
-        ssd1306_line(&ssd, 1, 51, 126, 51, true); // Desenha uma linha horizontal
+    if(i2c_fila_ativa(display_i2c_port)){
+        // Quadro anterior ainda no barramento: o próximo redesenho tenta de novo
+        if(oled_ocupado()){
+            return;
+        }
+        memcpy(ultimo_quadro, ssd.ram_buffer, ssd.bufsize);
+        quadro_valido = enviar_quadro_oled(ultimo_quadro);
+        return;
+    }
 
-        // Umidade
-        sprintf(str_umidade, "%.1f%%", umidade_final);  // Converte o float em string
-        ssd1306_draw_string(&ssd, "Umi:", 4, 53); // Desenha uma string
-        ssd1306_draw_string(&ssd, str_umidade, 40, 53); // Desenha uma string
+    memcpy(ultimo_quadro, ssd.ram_buffer, ssd.bufsize);
+    quadro_valido = true;
 
-    }else if(tela == 3){ // TELA 3 - DETALHES DA TEMPERATURA
-        // Cabeçalho
-        ssd1306_draw_string(&ssd, "TEMPERATURA", 20, 3); // Desenha uma string
+    uint32_t t0 = metricas_inicio();
+    ssd1306_send_data(&ssd); // Atualiza o display
+    metricas_fim(MH_SSD1306_ENVIO, t0);
+}
 
-        ssd1306_line(&ssd, 1, 12, 126, 12, true); // Desenha uma linha horizontal
+// Função para atualizar a matriz de LEDs com um dos padrões (PADRAO_*)
+void atualizar_matriz(int padrao){
+    matriz_mostrar(&padroes_matriz[padrao]); // Só a DMA trabalha; animações seguem por alarme
+}
 
-        // Temperatura medida
-        sprintf(str_temperatura, "%.1fC", temperatura_final);  // Converte o float em string
-        ssd1306_draw_string(&ssd, "Atual:", 4, 15); // Desenha uma string
-        ssd1306_draw_string(&ssd, str_temperatura, 56, 15); // Desenha uma string
+// Ações de uma regra de alerta na ativação/desativação (a matriz é resolvida em tarefa_alerta)
+static void transicao_alerta(int regra, const alerta_regra_t *r, bool ativo, float valor){
+    LOG(LOG_ALERTA, (uint32_t)regra, (uint32_t)ativo, log_f(valor));
+    if(ativo && (r->acoes & ALERTA_ACAO_BUZZER)){
+        tocar_padrao_buzzer(&r->buzzer);
+    }
+    if(r->acoes & ALERTA_ACAO_REDE){
+        mqtt_cliente_evento(r->nome, ativo, valor);
+    }
+}
 
-        ssd1306_line(&ssd, 1, 25, 126, 25, true); // Desenha uma linha horizontal
+// Copia os limites configurados (HTTP/MQTT) para as regras de nível
+static void atualizar_limites_alerta(){
+    alertas_definir_limiar(REGRA_TEMP_ALTA, temperatura_max);
+    alertas_definir_limiar(REGRA_TEMP_BAIXA, temperatura_min);
+    alertas_definir_limiar(REGRA_UMI_ALTA, umidade_max);
+    alertas_definir_limiar(REGRA_UMI_BAIXA, umidade_min);
+}
 
-        // Temperatura mínima
-        sprintf(str_temperatura_min, "%.1fC", temperatura_min);  // Converte o float em string
-        ssd1306_draw_string(&ssd, "Min:", 4, 28); // Desenha uma string
-        ssd1306_draw_string(&ssd, str_temperatura_min, 40, 28); // Desenha uma string
+// Limites e offsets persistidos em lib/configuracao.c (na ordem dos parâmetros de definir_limites/definir_offsets)
+static volatile float *const limites[] = { &temperatura_min, &temperatura_max, &umidade_min, &umidade_max };
+static const config_chave_t chaves_limites[] = {
+    CONFIG_TEMPERATURA_MIN, CONFIG_TEMPERATURA_MAX, CONFIG_UMIDADE_MIN, CONFIG_UMIDADE_MAX,
+};
+static volatile float *const offsets[] = { &temperatura_offset, &pressao_offset, &altitude_offset, &umidade_offset };
+static const config_chave_t chaves_offsets[] = {
+    CONFIG_TEMPERATURA_OFFSET, CONFIG_PRESSAO_OFFSET, CONFIG_ALTITUDE_OFFSET, CONFIG_UMIDADE_OFFSET,
+};
 
-        ssd1306_line(&ssd, 1, 38, 126, 38, true); // Desenha uma linha horizontal
+// Altera os valores e agenda a gravação na flash (agrupada: várias alterações seguidas gravam uma vez)
+static void definir_valores(volatile float *const *vars, const config_chave_t *chaves, const float *valores){
+    for(int i = 0; i < 4; i++){
+        *vars[i] = valores[i];
+        config_definir_float(chaves[i], valores[i]);
+    }
+}
 
-        // Temperatura máxima
-        sprintf(str_temperatura_max, "%.1fC", temperatura_max);  // Converte o float em string
-        ssd1306_draw_string(&ssd, "Max:", 4, 41); // Desenha uma string
-        ssd1306_draw_string(&ssd, str_temperatura_max, 40, 41); // Desenha uma string
+static void definir_limites(float t_min, float t_max, float u_min, float u_max){
+    definir_valores(limites, chaves_limites, (const float[]){ t_min, t_max, u_min, u_max });
+    atualizar_limites_alerta();
+}
 
-        ssd1306_line(&ssd, 1, 51, 126, 51, true); // Desenha uma linha horizontal
+static void definir_offsets(float t_off, float p_off, float a_off, float u_off){
+    definir_valores(offsets, chaves_offsets, (const float[]){ t_off, p_off, a_off, u_off });
+}
 
-        // Status da temperatura
-        if(temperatura_final >= temperatura_max){
-            ssd1306_draw_string(&ssd, "Alerta: T > Max", 2, 53); // Desenha uma string
-        }else if(temperatura_final <= temperatura_min){
-            ssd1306_draw_string(&ssd, "Alerta: T < Min", 2, 53); // Desenha uma string
-        }else{
-            ssd1306_draw_string(&ssd, "Status: Ok", 24, 53); // Desenha uma string
+// Valores gravados no boot anterior (os que não existem mantêm o padrão do firmware)
+static void carregar_configuracao(){
+    config_carregar();
+    for(int i = 0; i < 4; i++){
+        float v;
+        if(config_obter_float(chaves_limites[i], &v)){
+            *limites[i] = v;
         }
-    }else if(tela == 4){ // TELA 4 - DETALHES DA UMIDADE
-        // Cabeçalho
-        ssd1306_draw_string(&ssd, "UMIDADE", 36, 3); // Desenha uma string
-
-        ssd1306_line(&ssd, 1, 12, 126, 12, true); // Desenha uma linha horizontal
-
-        // Umidade medida
-        sprintf(str_umidade, "%.1f%%", umidade_final);  // Converte o float em string
-        ssd1306_draw_string(&ssd, "Atual:", 4, 15); // Desenha uma string
-        ssd1306_draw_string(&ssd, str_umidade, 56, 15); // Desenha uma string
-
-        ssd1306_line(&ssd, 1, 25, 126, 25, true); // Desenha uma linha horizontal
-
-        // Umidade mínima
-        sprintf(str_umidade_min, "%.1f%%", umidade_min);  // Converte o float em string
-        ssd1306_draw_string(&ssd, "Min:", 4, 28); // Desenha uma string
-        ssd1306_draw_string(&ssd, str_umidade_min, 40, 28); // Desenha uma string
-
-        ssd1306_line(&ssd, 1, 38, 126, 38, true); // Desenha uma linha horizontal
-
-        // Umidade máxima
-        sprintf(str_umidade_max, "%.1f%%", umidade_max);  // Converte o float em string
-        ssd1306_draw_string(&ssd, "Max:", 4, 41); // Desenha uma string
-        ssd1306_draw_string(&ssd, str_umidade_max, 40, 41); // Desenha uma string
-
-        ssd1306_line(&ssd, 1, 51, 126, 51, true); // Desenha uma linha horizontal
-
-        // Status da temperatura
-        if(umidade_final >= umidade_max){
-            ssd1306_draw_string(&ssd, "Alerta: U > Max", 2, 53); // Desenha uma string
-        }else if(umidade_final <= umidade_min){
-            ssd1306_draw_string(&ssd, "Alerta: U < Min", 2, 53); // Desenha uma string
-        }else{
-            ssd1306_draw_string(&ssd, "Status: Ok", 24, 53); // Desenha uma string
+        if(config_obter_float(chaves_offsets[i], &v)){
+            *offsets[i] = v;
         }
     }
-    ssd1306_send_data(&ssd); // Atualiza o display
-}
-
-// Função para atualizar a matriz de LEDs
-void atualizar_matriz(bool alerta){
-    desliga();
-    if(alerta){
-        // Frame "!"
-        int frame0[5][5][3] = {
-            {{0, 0, 0}, {0, 0, 0}, {150, 0, 0}, {0, 0, 0}, {0, 0, 0}},
-            {{0, 0, 0}, {0, 0, 0}, {150, 0, 0}, {0, 0, 0}, {0, 0, 0}},    
-            {{0, 0, 0}, {0, 0, 0}, {150, 0, 0}, {0, 0, 0}, {0, 0, 0}},
-            {{0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0}},
-            {{0, 0, 0}, {0, 0, 0}, {150, 0, 0}, {0, 0, 0}, {0, 0, 0}}
-        };
-        for (int linha = 0; linha < 5; linha++){
-            for (int coluna = 0; coluna < 5; coluna++){
-                int posicao = getIndex(linha, coluna);
-                cor(posicao, frame0[coluna][linha][0], frame0[coluna][linha][1], frame0[coluna][linha][2]);
-            }
-        };
-        buffer();
-    }else{
-        // Frame "Check"
-        int frame1[5][5][3] = {
-            {{0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0}},
-            {{0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 150, 0}},    
-            {{0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 150, 0}, {0, 0, 0}},
-            {{0, 150, 0}, {0, 0, 0}, {0, 150, 0}, {0, 0, 0}, {0, 0, 0}},
-            {{0, 0, 0}, {0, 150, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0}}
-        };
-        for (int linha = 0; linha < 5; linha++){
-            for (int coluna = 0; coluna < 5; coluna++){
-                int posicao = getIndex(linha, coluna);
-                cor(posicao, frame1[coluna][linha][0], frame1[coluna][linha][1], frame1[coluna][linha][2]);
-            }
-        };
-        buffer();
-    }
 }
 
-void atualizar_valores(){
-    temperatura_final = data.temperature + temperatura_offset;
-    pressao_final = (pressao / 1000) + pressao_offset;
-    altitude_final = altitude + altitude_offset;
-    umidade_final = data.humidity +umidade_offset;
+// Calcula a amostra corrente e a publica inteira (lib/estacao e lib/amostra)
+const amostra_t *atualizar_valores(){
+    const estacao_offsets_t offsets = { temperatura_offset, pressao_offset, altitude_offset, umidade_offset };
+    return estacao_atualizar(&offsets, grandezas_velhas(), intervalo_amostra_ms);
 }
 
 // --- Inicio das funções necessárias para a manipulação do modulo Wi-Fi
@@ -520,182 +620,579 @@ const char HTML_BODY[] =
 "</script></body></html>";
 
 
-struct http_state
-{
-    char response[20000];
-    size_t len;
-    size_t sent;
-};
+// --- Rotas HTTP: cada tratador escreve só o corpo; lib/http.c escolhe a rota e monta o cabeçalho
 
-static err_t http_sent(void *arg, struct tcp_pcb *tpcb, u16_t len)
-{
-    struct http_state *hs = (struct http_state *)arg;
-    hs->sent += len;
-    if (hs->sent >= hs->len)
-    {
-        tcp_close(tpcb);
-        free(hs);
+static size_t rota_set_limits(const char *req, char *corpo, size_t cap, const char **tipo){
+    beep_buzzer(200);
+    float t_min, t_max, u_min, u_max;
+    if(sscanf(req, "GET /set_limits?temp_min=%f&temp_max=%f&umi_min=%f&umi_max=%f", &t_min, &t_max, &u_min, &u_max) != 4){
+        return http_texto(corpo, cap, "Limites invalidos");
     }
-    return ERR_OK;
+    definir_limites(t_min, t_max, u_min, u_max);
+    return http_texto(corpo, cap, "Limites atualizados com sucesso");
 }
 
-static err_t http_recv(void *arg, struct tcp_pcb *tpcb, struct pbuf *p, err_t err)
-{
-    if (!p)
-    {
-        tcp_close(tpcb);
-        return ERR_OK;
+static size_t rota_dados(const char *req, char *corpo, size_t cap, const char **tipo){
+    amostra_t a;
+    amostra_ler(&a); // Contexto do lwIP: cópia consistente, sem misturar duas amostras
+    LOG(LOG_HTTP_DADOS, log_f(a.temperatura), log_f(a.pressao_kpa), log_f(a.altitude), log_f(a.umidade));
+    *tipo = HTTP_JSON;
+    return amostra_json(corpo, cap, &a);
+}
+
+static size_t rota_set_offsets(const char *req, char *corpo, size_t cap, const char **tipo){
+    beep_buzzer(200);
+    float t_off, p_off, a_off, u_off;
+    if(sscanf(req, "GET /set_offsets?temp_off=%f&pres_off=%f&alt_off=%f&umi_off=%f", &t_off, &p_off, &a_off, &u_off) != 4){
+        return http_texto(corpo, cap, "Offsets invalidos");
     }
+    definir_offsets(t_off, p_off, a_off, u_off);
+    return http_texto(corpo, cap, "Offsets atualizados com sucesso");
+}
 
-    char *req = (char *)p->payload;
-    struct http_state *hs = malloc(sizeof(struct http_state));
-    if (!hs)
-    {
-        pbuf_free(p);
-        tcp_close(tpcb);
-        return ERR_MEM;
+// Registra o pedido; a tarefa de amostragem o aplica (o agendador e lib/amostragem só mudam no laço principal)
+static void pedir_periodo(uint32_t min_ms, uint32_t max_ms){
+    periodo_pedido_min_ms = min_ms;
+    periodo_pedido_max_ms = max_ms;
+    periodo_pedido = true;
+    agendador_sinalizar(tarefa_amostra); // Aplica já, sem esperar o fim do período atual (até 60 s)
+}
+
+static size_t rota_set_periodo(const char *req, char *corpo, size_t cap, const char **tipo){
+    unsigned periodo_ms;
+    const char *txt = "Periodo invalido";
+    if (sscanf(req, "GET /set_periodo?amostragem_ms=%u", &periodo_ms) == 1 && periodo_ms >= 100) {
+        pedir_periodo(periodo_ms, periodo_ms); // Período fixo: desliga a adaptação
+        txt = "Periodo de amostragem atualizado";
     }
-    hs->sent = 0;
+    return http_texto(corpo, cap, txt);
+}
 
-    if (strstr(req, "GET /set_limits?")) {
-        beep_buzzer(200);
-        float t_min, t_max, u_min, u_max;
-        // Exemplo de sscanf para pegar os valores (ajuste se necessário)
-        sscanf(req, "GET /set_limits?temp_min=%f&temp_max=%f&umi_min=%f&umi_max=%f", &t_min, &t_max, &u_min, &u_max);
-
-        // Atualize suas variáveis globais com os novos limites
-        temperatura_min = t_min;
-        temperatura_max = t_max;
-        umidade_min = u_min;
-        umidade_max = u_max;
-
-        const char *txt = "Limites atualizados com sucesso";
-        hs->len = snprintf(hs->response, sizeof(hs->response),
-                        "HTTP/1.1 200 OK\r\n"
-                        "Content-Type: text/plain\r\n"
-                        "Content-Length: %d\r\n"
-                        "Connection: close\r\n"
-                        "\r\n"
-                        "%s",
-                        (int)strlen(txt), txt);
-    }
-    else if (strstr(req, "GET /dados"))
-    {
-        char json_payload[2048];
-        int json_len = snprintf(json_payload, sizeof(json_payload),
-                                "{\"tem\":%.1f,\"pre\":%.2f,\"alt\":%.0f,\"umi\":%.1f}\r\n",
-                                temperatura_final, pressao_final, altitude_final, umidade_final);
-
-        printf("[DEBUG] JSON: %s\n", json_payload);
-
-        hs->len = snprintf(hs->response, sizeof(hs->response),
-                           "HTTP/1.1 200 OK\r\n"
-                           "Content-Type: application/json\r\n"
-                           "Content-Length: %d\r\n"
-                           "Connection: close\r\n"
-                           "\r\n"
-                           "%s",
-                           json_len, json_payload);
-    }
-    else if (strstr(req, "GET /set_offsets?")) {
-        beep_buzzer(200);
-        float t_off, p_off, a_off, u_off;
-        sscanf(req, "GET /set_offsets?temp_off=%f&pres_off=%f&alt_off=%f&umi_off=%f", &t_off, &p_off, &a_off, &u_off);
-
-        temperatura_offset = t_off;
-        pressao_offset = p_off;
-        altitude_offset = a_off;
-        umidade_offset = u_off;
-
-        const char *txt = "Offsets atualizados com sucesso";
-        hs->len = snprintf(hs->response, sizeof(hs->response),
-                        "HTTP/1.1 200 OK\r\n"
-                        "Content-Type: text/plain\r\n"
-                        "Content-Length: %d\r\n"
-                        "Connection: close\r\n"
-                        "\r\n"
-                        "%s",
-                        (int)strlen(txt), txt);
-    }
-    else
-    {
-        hs->len = snprintf(hs->response, sizeof(hs->response),
-                           "HTTP/1.1 200 OK\r\n"
-                           "Content-Type: text/html\r\n"
-                           "Content-Length: %d\r\n"
-                           "Connection: close\r\n"
-                           "\r\n"
-                           "%s",
-                           (int)strlen(HTML_BODY), HTML_BODY);
+static size_t rota_set_amostragem(const char *req, char *corpo, size_t cap, const char **tipo){
+    unsigned min_ms, max_ms;
+    const char *txt = "Limites invalidos";
+    if (sscanf(req, "GET /set_amostragem?min_ms=%u&max_ms=%u", &min_ms, &max_ms) == 2 && min_ms >= 100 && max_ms >= min_ms) {
+        pedir_periodo(min_ms, max_ms);
+        txt = "Amostragem adaptativa atualizada";
     }
+    return http_texto(corpo, cap, txt);
+}
 
-    tcp_arg(tpcb, hs);
-    tcp_sent(tpcb, http_sent);
+static size_t rota_set_altitude(const char *req, char *corpo, size_t cap, const char **tipo){
+    float metros;
+    const char *txt = "Altitude invalida";
+    if (sscanf(req, "GET /set_altitude?m=%f", &metros) == 1 && metros > -500.0f && metros < 9000.0f) {
+        altitude_pedida_m = metros;
+        altitude_pedida = true; // Vale a partir da próxima amostra
+        txt = "Altitude da estacao atualizada";
+    }
+    return http_texto(corpo, cap, txt);
+}
+
+static size_t rota_set_gravacao(const char *req, char *corpo, size_t cap, const char **tipo){
+    unsigned ativa;
+    if (sscanf(req, "GET /set_gravacao?ativa=%u", &ativa) != 1) {
+        return http_texto(corpo, cap, "Parametro invalido");
+    }
+    gravacao_ativar(ativa != 0);
+    const gravacao_stats_t *g = gravacao_stats();
+    int len = snprintf(corpo, cap, "Gravacao %s: %lu ciclos, %lu registros, %lu descartados",
+                       g->ativa ? "ligada" : "desligada", (unsigned long)g->ciclos, (unsigned long)g->registros,
+                       (unsigned long)g->descartados);
+    return len > 0 ? (size_t)len : 0;
+}
+
+static size_t rota_tendencia(const char *req, char *corpo, size_t cap, const char **tipo){
+    amostra_t a;
+    static amostra_derivadas_t derivadas; // Contexto do lwIP
+    amostra_ler(&a); // Pressão ao nível do mar calculada da amostra publicada (lib/derivadas só na coleta)
+    *tipo = HTTP_JSON;
+    return tendencia_relatorio(corpo, cap, amostra_derivada(&a, DERIVADA_PRESSAO_MAR, &derivadas));
+}
+
+static size_t rota_alertas(const char *req, char *corpo, size_t cap, const char **tipo){
+    *tipo = HTTP_JSON;
+    return alertas_relatorio(corpo, cap);
+}
 
-    tcp_write(tpcb, hs->response, hs->len, TCP_WRITE_FLAG_COPY);
-    tcp_output(tpcb);
+static size_t rota_amostragem(const char *req, char *corpo, size_t cap, const char **tipo){
+    *tipo = HTTP_JSON;
+    return amostragem_relatorio(corpo, cap);
+}
+
+static size_t rota_tarefas(const char *req, char *corpo, size_t cap, const char **tipo){
+    *tipo = HTTP_JSON;
+    return agendador_relatorio(corpo, cap);
+}
+
+static size_t rota_set_bmp280(const char *req, char *corpo, size_t cap, const char **tipo){
+    // Ruído e taxa do BMP280: sobreamostragem, filtro IIR, t_standby e modo (mesma codificação do datasheet)
+    unsigned osrs_t, osrs_p, filtro, standby, modo;
+    const char *txt = "Configuracao invalida";
+    if (sscanf(req, "GET /set_bmp280?osrs_t=%u&osrs_p=%u&filtro=%u&standby=%u&modo=%u",
+               &osrs_t, &osrs_p, &filtro, &standby, &modo) == 5) {
+        bmp280_config_t cfg = { osrs_t, osrs_p, filtro, standby, modo };
+        if (bmp280_config_valid(&cfg)) {
+            // Aplicada pela tarefa de amostragem (o resultado aparece em /sensores)
+            bmp280_config_pedida = cfg;
+            bmp280_pedido = true;
+            agendador_sinalizar(tarefa_amostra);
+            txt = "Reconfiguracao do BMP280 agendada";
+        }
+    }
+    return http_texto(corpo, cap, txt);
+}
 
-    pbuf_free(p);
-    return ERR_OK;
+static size_t rota_sensores(const char *req, char *corpo, size_t cap, const char **tipo){
+    *tipo = HTTP_JSON;
+    return sensores_relatorio(corpo, cap);
 }
 
-static err_t connection_callback(void *arg, struct tcp_pcb *newpcb, err_t err)
+static size_t rota_i2c(const char *req, char *corpo, size_t cap, const char **tipo){
+    *tipo = HTTP_JSON;
+    return i2c_fila_relatorio(corpo, cap);
+}
+
+static size_t rota_memoria(const char *req, char *corpo, size_t cap, const char **tipo){
+    *tipo = HTTP_JSON;
+    return memoria_relatorio(corpo, cap);
+}
+
+static size_t rota_vigia(const char *req, char *corpo, size_t cap, const char **tipo){
+    *tipo = HTTP_JSON;
+    return vigia_relatorio(corpo, cap);
+}
+
+static size_t rota_config(const char *req, char *corpo, size_t cap, const char **tipo){
+    *tipo = HTTP_JSON;
+    return config_relatorio(corpo, cap);
+}
+
+static size_t rota_boot(const char *req, char *corpo, size_t cap, const char **tipo){
+    static const char *const nomes[BOOT_MARCOS] = {
+        [BOOT_DISPLAY] = "display", [BOOT_PRIMEIRA_AMOSTRA] = "primeira_amostra",
+        [BOOT_WIFI] = "wifi", [BOOT_PRIMEIRA_RESPOSTA] = "primeira_resposta_http",
+    };
+    *tipo = HTTP_JSON;
+    size_t len = snprintf(corpo, cap, "{\"marcos_ms\":{");
+    for(int i = 0; i < BOOT_MARCOS && len < cap; i++){
+        if(marcos_boot[i]){
+            len += snprintf(corpo + len, cap - len, "%s\"%s\":%.3f", i ? "," : "", nomes[i], marcos_boot[i] / 1000.0);
+        }else{
+            len += snprintf(corpo + len, cap - len, "%s\"%s\":null", i ? "," : "", nomes[i]);
+        }
+    }
+    if(len < cap){
+        len += snprintf(corpo + len, cap - len, "},\"conexao\":");
+    }
+    if(len < cap){
+        len += conexao_relatorio(corpo + len, cap - len);
+    }
+    if(len < cap){
+        len += snprintf(corpo + len, cap - len, "}");
+    }
+    return len < cap ? len : cap - 1;
+}
+
+static size_t rota_metrics(const char *req, char *corpo, size_t cap, const char **tipo){
+    *tipo = "application/openmetrics-text; version=1.0.0; charset=utf-8";
+    return metricas_renderizar(corpo, cap);
+}
+
+#if TRACE_HABILITADO
+static size_t rota_trace(const char *req, char *corpo, size_t cap, const char **tipo){
+    *tipo = HTTP_JSON;
+    return trace_exportar_json(corpo, cap);
+}
+#endif
+
+static size_t rota_pagina(const char *req, char *corpo, size_t cap, const char **tipo){
+    *tipo = HTTP_HTML;
+    return http_texto(corpo, cap, HTML_BODY);
+}
+
+static const http_rota_t rotas_http[] = {
+    { "/dados", rota_dados },
+    { "/set_limits", rota_set_limits },
+    { "/set_offsets", rota_set_offsets },
+    { "/set_periodo", rota_set_periodo },
+    { "/set_amostragem", rota_set_amostragem },
+    { "/set_altitude", rota_set_altitude },
+    { "/set_gravacao", rota_set_gravacao },
+    { "/set_bmp280", rota_set_bmp280 },
+    { "/tendencia", rota_tendencia },
+    { "/alertas", rota_alertas },
+    { "/amostragem", rota_amostragem },
+    { "/tarefas", rota_tarefas },
+    { "/sensores", rota_sensores },
+    { "/i2c", rota_i2c },
+    { "/memoria", rota_memoria },
+    { "/vigia", rota_vigia },
+    { "/boot", rota_boot },
+    { "/config", rota_config },
+    { "/metrics", rota_metrics },
+#if TRACE_HABILITADO
+    { "/trace", rota_trace },
+#endif
+    { NULL, rota_pagina }, // Qualquer outro caminho: página principal
+};
+
+// Atendimento de uma requisição (chamado por lib/servidor_http.c no contexto do lwIP)
+static const char *atender_http(const char *req, char *buf, size_t cap, size_t *len)
+{
+    TRACE_INICIO(TR_HTTP_RECV);
+    uint32_t t0 = metricas_inicio();
+    metricas_contar(MC_HTTP_REQUISICOES);
+
+    const char *resposta = http_responder(rotas_http, sizeof(rotas_http) / sizeof(rotas_http[0]), req, buf, cap, len);
+    if(resposta){
+        marcar_boot(BOOT_PRIMEIRA_RESPOSTA);
+    }
+
+    metricas_fim(MH_HTTP, t0);
+    TRACE_FIM(TR_HTTP_RECV);
+    return resposta;
+}
+
+// Função de callback das mensagens de configuração recebidas via MQTT (mesmo formato das rotas HTTP)
+static void mqtt_config_callback(const char *topico, const char *payload)
 {
-    tcp_recv(newpcb, http_recv);
-    return ERR_OK;
+    if (strstr(topico, "/config/limites")) {
+        float t_min, t_max, u_min, u_max;
+        if (sscanf(payload, "temp_min=%f&temp_max=%f&umi_min=%f&umi_max=%f", &t_min, &t_max, &u_min, &u_max) == 4) {
+            definir_limites(t_min, t_max, u_min, u_max);
+            beep_buzzer(200);
+        }
+    } else if (strstr(topico, "/config/offsets")) {
+        float t_off, p_off, a_off, u_off;
+        if (sscanf(payload, "temp_off=%f&pres_off=%f&alt_off=%f&umi_off=%f", &t_off, &p_off, &a_off, &u_off) == 4) {
+            definir_offsets(t_off, p_off, a_off, u_off);
+            beep_buzzer(200);
+        }
+    }
 }
 
 static void start_http_server(void)
 {
-    struct tcp_pcb *pcb = tcp_new();
-    if (!pcb)
+    // Chamada da tarefa de rede com o lwIP já rodando na interrupção: tcp_new/tcp_bind/tcp_listen sob a trava
+    // (a telemetria UDP trava por conta própria em telemetria_udp_init)
+    cyw43_arch_lwip_begin();
+    bool iniciado = servidor_http_iniciar(80, atender_http);
+    cyw43_arch_lwip_end();
+    if (!iniciado)
     {
-        printf("Erro ao criar PCB TCP\n");
+        printf("Erro ao iniciar o servidor HTTP na porta 80\n");
         return;
     }
-    if (tcp_bind(pcb, IP_ADDR_ANY, 80) != ERR_OK)
+    printf("Servidor HTTP rodando na porta 80...\n");
+}
+
+// Troca de estado do Wi-Fi (lib/conexao, no contexto da tarefa de rede): LEDs, display e serviços de rede
+static void conexao_mudou(conexao_estado_t estado)
+{
+    static bool servicos_iniciados = false;
+    switch (estado)
     {
-        printf("Erro ao ligar o servidor na porta 80\n");
-        return;
+    case CONEXAO_ASSOCIANDO:
+        text_wifi = TELAS_WIFI_CONECTANDO;
+        gpio_put(LED_Green, 1);
+        gpio_put(LED_Blue, 0);
+        gpio_put(LED_Red, 1);
+        break;
+    case CONEXAO_CONECTADA:
+    {
+        text_wifi = TELAS_WIFI_CONECTADO;
+        gpio_put(LED_Green, 1);
+        gpio_put(LED_Blue, 0);
+        gpio_put(LED_Red, 0);
+        uint8_t *ip = (uint8_t *)&(cyw43_state.netif[0].ip_addr.addr);
+        snprintf(str_ip, sizeof(str_ip), "%d.%d.%d.%d", ip[0], ip[1], ip[2], ip[3]);
+        marcar_boot(BOOT_WIFI);
+
+        // Os serviços usam o lwIP, inicializado junto com o rádio: só na primeira conexão
+        if (!servicos_iniciados)
+        {
+            servicos_iniciados = true;
+            start_http_server();
+
+            // Telemetria UDP (modo push)
+            if (!telemetria_udp_init(TELEMETRIA_UDP_DESTINO, TELEMETRIA_UDP_PORTA))
+            {
+                printf("Erro ao iniciar a telemetria UDP\n");
+            }
+
+            // Cliente MQTT (publicação dos dados e recebimento de limites/offsets)
+            if (!mqtt_cliente_init(MQTT_BROKER, MQTT_PORTA, mqtt_config_callback))
+            {
+                printf("Erro ao iniciar o cliente MQTT\n");
+            }
+        }
+        break;
     }
-    pcb = tcp_listen(pcb);
-    tcp_accept(pcb, connection_callback);
-    printf("Servidor HTTP rodando na porta 80...\n");
+    default: // Espera para reconectar ou rádio sem resposta
+        text_wifi = TELAS_WIFI_FALHA;
+        gpio_put(LED_Green, 0);
+        gpio_put(LED_Blue, 0);
+        gpio_put(LED_Red, 1);
+        break;
+    }
+    agendador_sinalizar(tarefa_display);
 }
 
 // --- Final das funções necessárias para a manipulação do modulo Wi-Fi
 
 
+// --- Tarefas do agendador
+
+// Serviço da pilha de rede e do cliente MQTT
+void tarefa_rede(){
+    // O rádio só é inicializado depois da primeira amostra: cyw43_arch_init bloqueia por centenas de ms
+    if(marcos_boot[BOOT_PRIMEIRA_AMOSTRA]){
+        if(conexao_inicializacao_pendente()){
+            // Nenhuma outra tarefa executa durante o cyw43_arch_init (boot e novas tentativas sem rádio): amostragem
+            // e display ganham PRAZO_VIGIA_REDE_MS a mais, e cada uma volta ao prazo normal no próximo sinal
+            vigia_prazo(vigia_amostragem, 2 * agendador_periodo_ms(tarefa_amostra) + PRAZO_VIGIA_FOLGA_MS + PRAZO_VIGIA_REDE_MS);
+            vigia_prazo(vigia_display, PRAZO_VIGIA_DISPLAY_MS + PRAZO_VIGIA_REDE_MS);
+        }
+        conexao_executar(); // Associação em segundo plano e reconexão com espera
+    }
+    if(conexao_radio_pronto()){
+        TRACE_INICIO(TR_CYW43_POLL);
+        cyw43_arch_poll();
+        TRACE_FIM(TR_CYW43_POLL);
+    }
+    if(conexao_stats()->primeira_ms){ // Cliente MQTT iniciado na primeira conexão (conexao_mudou)
+        TRACE_INICIO(TR_REDE);
+        mqtt_cliente_poll(); // Mantém a conexão MQTT e publica as amostras pendentes
+        TRACE_FIM(TR_REDE);
+    }
+    vigia_sinal(vigia_rede);
+}
+
+// Fim da conversão do AHT20: recolhe as leituras fora da interrupção
+static int64_t alarme_coleta(alarm_id_t id, void *user_data){
+    MEMORIA_SONDA_IRQ();
+    agendador_sinalizar(tarefa_coleta);
+    return 0;
+}
+
+// Aplica os pedidos de configuração do HTTP (só entre dois ciclos de leitura)
+static void aplicar_pedidos(){
+    if(bmp280_pedido){
+        uint32_t estado = save_and_disable_interrupts(); // O pedido pode ser trocado por outra requisição
+        bmp280_config_t cfg = bmp280_config_pedida;
+        bmp280_pedido = false;
+        restore_interrupts(estado);
+        for(int i = 0; i < sensores_quantidade(); i++){
+            if(sensores_obter(i)->tipo == SENSOR_BMP280){
+                sensores_configurar_bmp280(i, &cfg);
+            }
+        }
+    }
+    if(periodo_pedido){
+        uint32_t estado = save_and_disable_interrupts();
+        uint32_t min_ms = periodo_pedido_min_ms, max_ms = periodo_pedido_max_ms;
+        periodo_pedido = false;
+        restore_interrupts(estado);
+        amostragem_configurar(min_ms, max_ms);
+        agendador_definir_periodo(tarefa_amostra, min_ms);
+    }
+    if(altitude_pedida){
+        uint32_t estado = save_and_disable_interrupts();
+        float metros = altitude_pedida_m;
+        altitude_pedida = false;
+        restore_interrupts(estado);
+        derivadas_configurar(metros, SEA_LEVEL_PRESSURE);
+    }
+}
+
+// Dispara as leituras dos sensores; a CPU fica livre durante a conversão do AHT20
+void tarefa_amostragem(){
+    if(coleta_pendente){
+        return; // Sinalizada no meio de um ciclo: os pedidos são aplicados no fim da coleta
+    }
+    aplicar_pedidos();
+
+    static uint32_t t_amostra = 0;
+    uint32_t agora = metricas_inicio();
+    if(t_amostra){
+        metricas_fim(MH_LOOP, t_amostra); // Período real entre amostras
+        intervalo_amostra_ms = (agora - t_amostra) / 1000;
+    }
+    t_amostra = agora;
+
+    // Todos os sensores convertem ao mesmo tempo: espera só a conversão mais longa
+    coleta_pendente = true;
+    uint32_t espera_ms = sensores_disparar();
+    if(espera_ms && add_alarm_in_ms(espera_ms, alarme_coleta, NULL, true) < 0){
+        // Pool de alarmes esgotado: sem o alarme a coleta pararia até o watchdog; espera a conversão aqui
+        LOG(LOG_ALARME_ESGOTADO, espera_ms);
+        sleep_ms(espera_ms);
+        espera_ms = 0;
+    }
+    if(!espera_ms){
+        agendador_sinalizar(tarefa_coleta);
+    }
+}
+
+// Leitura dos sensores e envio da amostra (por evento, após a conversão)
+void tarefa_coleta_sensores(){
+    instante_amostra_us = time_us_64();
+    // Sem efeito se a gravação das leituras brutas está desligada
+    gravacao_ciclo(instante_amostra_us, intervalo_amostra_ms);
+    sensores_coletar();
+    coleta_pendente = false;
+    aplicar_pedidos();
+
+    TRACE_INICIO(TR_LER_BMP280);
+    ler_bmp280(); // Leitura do sensor BMP280
+    TRACE_FIM(TR_LER_BMP280);
+
+    TRACE_INICIO(TR_LER_AHT10);
+    ler_aht10();  // Leitura do sensor AHT10
+    TRACE_FIM(TR_LER_AHT10);
+
+    TRACE_INICIO(TR_ATUALIZAR_VALORES);
+    const amostra_t *a = atualizar_valores();
+    TRACE_FIM(TR_ATUALIZAR_VALORES);
+
+    // Período da próxima amostra: volatilidade de cada canal e proximidade dos limites de alerta.
+    // Canal sem leitura válida não é observado (o valor parado, ou 0 antes da primeira leitura, não é medida)
+    const filtro_canal_t *ft = estacao_filtro(ESTACAO_TEMPERATURA);
+    const filtro_canal_t *fu = estacao_filtro(ESTACAO_UMIDADE);
+    const filtro_canal_t *fp = estacao_filtro(ESTACAO_PRESSAO);
+    if(!(a->velhos & AMOSTRA_VELHA_TEMPERATURA)){
+        amostragem_observar(canal_temperatura, ft->bruto, ft->filtrado,
+                            fminf(a->temperatura - temperatura_min, temperatura_max - a->temperatura), a->intervalo_ms);
+    }
+    if(!(a->velhos & AMOSTRA_VELHA_UMIDADE)){
+        amostragem_observar(canal_umidade, fu->bruto, fu->filtrado,
+                            fminf(a->umidade - umidade_min, umidade_max - a->umidade), a->intervalo_ms);
+    }
+    if(!(a->velhos & AMOSTRA_VELHA_PRESSAO)){
+        amostragem_observar(canal_pressao, fp->bruto, fp->filtrado, NAN, a->intervalo_ms);
+    }
+    agendador_definir_periodo(tarefa_amostra, amostragem_proximo_periodo());
+
+    uint8_t previsao;
+    float tendencia_3h = estacao_tendencia(a, instante_amostra_us, &previsao);
+
+    TRACE_INICIO(TR_REDE);
+    telemetria_udp_enviar(a->temperatura, a->umidade, a->pressao_kpa, a->altitude, a->intervalo_ms,
+                          tendencia_3h, previsao); // Envia a amostra ao coletor
+    mqtt_cliente_publicar(a->temperatura, a->umidade, a->pressao_kpa, a->altitude, a->intervalo_ms,
+                          tendencia_3h, previsao); // Enfileira a amostra no MQTT
+    TRACE_FIM(TR_REDE);
+
+    agendador_sinalizar(tarefa_matriz); // Nova amostra: reavalia os alertas
+    if(!marcos_boot[BOOT_PRIMEIRA_AMOSTRA]){
+        marcar_boot(BOOT_PRIMEIRA_AMOSTRA);
+        agendador_sinalizar(tarefa_display); // Mostra a primeira amostra sem esperar o período do display
+    }
+
+    // Amostra completa (disparo, conversão e coleta); o prazo acompanha o período adaptativo
+    vigia_prazo(vigia_amostragem, 2 * agendador_periodo_ms(tarefa_amostra) + PRAZO_VIGIA_FOLGA_MS);
+    vigia_sinal(vigia_amostragem);
+}
+
+// Avaliação dos alertas e atualização da matriz de LEDs (por evento)
+void tarefa_alerta(){
+    static int ultimo_padrao = -1; // -1 = matriz ainda não desenhada
+    TRACE_INICIO(TR_ATUALIZAR_MATRIZ);
+    amostra_t a;
+    amostra_ler(&a);
+    estacao_alertas(&a, instante_amostra_us); // As ações de buzzer e rede saem em transicao_alerta
+
+    int regra = alertas_prioritario(ALERTA_ACAO_MATRIZ);
+    int padrao = regra < 0 ? PADRAO_OK : alertas_regra(regra)->padrao_matriz;
+    if(padrao != ultimo_padrao){ // A matriz só é reescrita quando o padrão muda
+        atualizar_matriz(padrao);
+        ultimo_padrao = padrao;
+    }
+    TRACE_FIM(TR_ATUALIZAR_MATRIZ);
+}
+
+// Redesenho do display OLED (periódico e ao trocar de tela)
+void tarefa_display_oled(){
+    TRACE_INICIO(TR_ATUALIZAR_DISPLAY);
+    atualizar_display(); // Atualiza o display OLED
+    TRACE_FIM(TR_ATUALIZAR_DISPLAY);
+    vigia_prazo(vigia_display, PRAZO_VIGIA_DISPLAY_MS); // Desfaz a folga dada durante o cyw43_arch_init
+    vigia_sinal(vigia_display);
+}
+
+// Trabalho de baixa prioridade: log, gravação e comandos pela USB
+void tarefa_ociosa(){
+    int comando = getchar_timeout_us(0);
+#if TRACE_HABILITADO
+    // Comando 't' pela USB exporta o trace
+    if(comando == 't'){
+        trace_imprimir_json();
+    }
+#endif
+    // Comando 'g' liga/desliga a gravação das leituras brutas (reprodução com tools/replay.c)
+    if(comando == 'g'){
+        gravacao_ativar(!gravacao_ativa());
+    }
+    // Comando 'm' imprime o uso de memória (pilhas, heap e lwIP)
+    if(comando == 'm'){
+        memoria_imprimir();
+    }
+    // Comando 'w' repete o diagnóstico do último reinício pelo watchdog (o boot não espera a USB)
+    if(comando == 'w'){
+        vigia_imprimir();
+    }
+    memoria_amostrar();
+    config_executar(); // Grava na flash os limites/offsets alterados há mais de CONFIG_ATRASO_MS
+
+    log_descarregar(); // Envia o log pendente pela USB
+    gravacao_descarregar(); // Envia os registros de gravação pendentes pela USB
+}
+
+
 // Função de interrupção dos botões
 void gpio_irq_handler(uint gpio, uint32_t events){
+    MEMORIA_SONDA_IRQ();
+    TRACE_INICIO(TR_GPIO_IRQ);
     //Debouncing
     uint32_t current_time = to_us_since_boot(get_absolute_time()); // Pega o tempo atual e transforma em us
     if(current_time - last_time > 1000000){
         last_time = current_time; // Atualização de tempo do último clique
         if(gpio == button_A){
             if(tela <= 1){
-                tela = 4;
+                tela = TELAS_N;
             }else{
                 tela = tela - 1;
             }
-            atualizar_display(); // Atualiza o display OLED
+            if(tarefa_display >= 0){
+                agendador_sinalizar(tarefa_display); // Redesenha fora da interrupção
+            }else{
+                atualizar_display(); // Atualiza o display OLED (agendador ainda não iniciado)
+            }
         }else if(gpio == button_B){
-            if(tela >= 4){
+            if(tela >= TELAS_N){
                 tela = 1;
             }else{
                 tela = tela + 1;
             }
-            atualizar_display(); // Atualiza o display OLED
+            if(tarefa_display >= 0){
+                agendador_sinalizar(tarefa_display); // Redesenha fora da interrupção
+            }else{
+                atualizar_display(); // Atualiza o display OLED (agendador ainda não iniciado)
+            }
         }else if(gpio == button_J){
             reset_usb_boot(0, 0);
         }
     }
+    TRACE_FIM(TR_GPIO_IRQ);
 }
 
 // Função principal
 int main(){
-    stdio_init_all();
-    sleep_ms(2000);
+    memoria_iniciar(); // Pinta as pilhas antes de qualquer outra chamada
+    stdio_init_all(); // Sem esperar a USB enumerar: as mensagens do boot podem se perder, os marcos ficam em /boot
+    vigia_iniciar(); // Diagnóstico do reinício anterior, se foi pelo watchdog
+    carregar_configuracao(); // Limites e offsets gravados na flash
 
     // Inicialização dos LEDs
     gpio_init(LED_Green);
@@ -725,13 +1222,8 @@ int main(){
     gpio_set_irq_enabled_with_callback(button_B, GPIO_IRQ_EDGE_FALL, true, &gpio_irq_handler); // Interrupção do botão B
     gpio_set_irq_enabled_with_callback(button_J, GPIO_IRQ_EDGE_FALL, true, &gpio_irq_handler); // Interrupção do botão do joystick
 
-    // Inicialização do PIO
-    np_pio = pio0;
-    sm = pio_claim_unused_sm(np_pio, true);
-    uint offset = pio_add_program(pio0, &ws2818b_program);
-    ws2818b_program_init(np_pio, sm, offset, matriz_leds, 800000);
-    desliga(); // Para limpar o buffer dos LEDs
-    buffer(); // Atualiza a matriz de LEDs
+    // Inicialização do PIO e da DMA da matriz de LEDs (já apagada)
+    matriz_init(pio0, matriz_leds);
 
     // Inicialização do Display OLED
     i2c_init(display_i2c_port, 400 * 1000); // Inicializa o I2C usando 400kHz
@@ -752,79 +1244,64 @@ int main(){
     gpio_pull_up(I2C_SDA); // Ativa o resistor de pull up para o pino SDA (GPIO 0)
     gpio_pull_up(I2C_SCL); // Ativa o resistor de pull up para o pino SCL (GPIO 1)
 
-    // Inicialização do BMP280
-    bmp280_init(I2C_PORT);
-    bmp280_get_calib_params(I2C_PORT, &params);
+    // Registro dos sensores (outras alturas de sonda: canal do TCA9548A e/ou BMP280 em ADDR_ALT)
+    int bmp280_registrado = sensores_registrar("bmp280", SENSOR_BMP280, SENSOR_SEM_MUX, ADDR);
+    int aht20_registrado = sensores_registrar("aht20", SENSOR_AHT20, SENSOR_SEM_MUX, AHT20_I2C_ADDR);
+    // sensores_registrar("bmp280_2m", SENSOR_BMP280, 1, ADDR_ALT);
+    // sensores_registrar("aht20_2m", SENSOR_AHT20, 1, AHT20_I2C_ADDR);
+    sensores_iniciar(I2C_PORT);
+    // Primeiro sensor presente de cada tipo; se nenhum respondeu, o principal, que é reinicializado quando voltar
+    sensor_bmp280 = sensores_primeiro(SENSOR_BMP280);
+    sensor_aht20 = sensores_primeiro(SENSOR_AHT20);
+    if(sensor_bmp280 < 0){
+        sensor_bmp280 = bmp280_registrado;
+    }
+    if(sensor_aht20 < 0){
+        sensor_aht20 = aht20_registrado;
+    }
+    // Amostragem adaptativa: limiares de variação por minuto e de ruído de cada canal
+    amostragem_configurar(PERIODO_AMOSTRAGEM_MS, PERIODO_AMOSTRAGEM_MAX_MS);
+    canal_temperatura = amostragem_canal("temperatura", 0.2f, 0.1f); // °C/min, °C
+    canal_umidade = amostragem_canal("umidade", 1.0f, 0.5f); // %/min, %
+    canal_pressao = amostragem_canal("pressao", 10.0f, 5.0f); // Pa/min, Pa
 
-    // Inicialização do AHT20
-    aht20_reset(I2C_PORT);
-    aht20_init(I2C_PORT);
+    tendencia_configurar(TENDENCIA_JANELA_CURTA, TENDENCIA_JANELA_LONGA);
+    derivadas_configurar(ALTITUDE_ESTACAO_M, SEA_LEVEL_PRESSURE);
+
+    estacao_iniciar(transicao_alerta); // Filtros e regras de alerta
+    atualizar_limites_alerta();
 
     gpio_put(LED_Green, 0);
     gpio_put(LED_Blue, 1);
     gpio_put(LED_Red, 0);
 
     atualizar_display(); // Atualiza o display OLED
-
-    // Inicialização do servidor
-
-    if (cyw43_arch_init())
-    {
-        text_wifi = 3;
-        gpio_put(LED_Green, 0);
-        gpio_put(LED_Blue, 0);
-        gpio_put(LED_Red, 1);
-        atualizar_display(); // Atualiza o display OLED
-        return 1;
-    }
-
-    cyw43_arch_enable_sta_mode();
-    text_wifi = 2;
-    gpio_put(LED_Green, 1);
-    gpio_put(LED_Blue, 0);
-    gpio_put(LED_Red, 1);
-    atualizar_display(); // Atualiza o display OLED
-    if (cyw43_arch_wifi_connect_timeout_ms(WIFI_SSID, WIFI_PASS, CYW43_AUTH_WPA2_AES_PSK, 10000))
-    {
-        text_wifi = 3;
-        gpio_put(LED_Green, 0);
-        gpio_put(LED_Blue, 0);
-        gpio_put(LED_Red, 1);
-        atualizar_display(); // Atualiza o display OLED
-        return 1;
-    }
-
-    text_wifi = 4;
-    gpio_put(LED_Green, 1);
-    gpio_put(LED_Blue, 0);
-    gpio_put(LED_Red, 0);
-    atualizar_display(); // Atualiza o display OLED
-
-    uint8_t *ip = (uint8_t *)&(cyw43_state.netif[0].ip_addr.addr);
-    snprintf(str_ip, sizeof(str_ip), "%d.%d.%d.%d", ip[0], ip[1], ip[2], ip[3]);
-    atualizar_display(); // Atualiza o display OLED
-
-    start_http_server();
-
-    while (true) {
-
-        cyw43_arch_poll();
-        
-        ler_bmp280(); // Leitura do sensor BMP280
-        ler_aht10();  // Leitura do sensor AHT10
-
-        atualizar_valores();
-        
-        if(temperatura_final <= temperatura_min || temperatura_final >= temperatura_max || umidade_final <= umidade_min || umidade_final >= umidade_max){
-            atualizar_matriz(true);
-        }else{
-            atualizar_matriz(false);
-        }
-        
-        atualizar_display(); // Atualiza o display OLED
-
-        sleep_ms(300); // Delay de 300ms
-    }
+    marcar_boot(BOOT_DISPLAY);
+
+    // Wi-Fi: inicializado e associado pela tarefa de rede, sem bloquear o boot
+    conexao_configurar(WIFI_SSID, WIFI_PASS, CYW43_AUTH_WPA2_AES_PSK, WIFI_PM, conexao_mudou);
+
+    // A partir daqui os dois barramentos I2C só são usados pelas filas de transações
+    i2c_fila_init(I2C_PORT);
+    i2c_fila_init(display_i2c_port);
+    i2c_fila_pinos(I2C_PORT, I2C_SDA, I2C_SCL, 400 * 1000); // Recuperação do barramento travado
+    i2c_fila_pinos(display_i2c_port, display_i2c_sda, display_i2c_scl, 400 * 1000);
+
+    // Tarefas
+    agendador_adicionar("rede", tarefa_rede, PERIODO_REDE_MS);
+    tarefa_amostra = agendador_adicionar("amostragem", tarefa_amostragem, PERIODO_AMOSTRAGEM_MS);
+    tarefa_coleta = agendador_adicionar("coleta", tarefa_coleta_sensores, 0);
+    tarefa_matriz = agendador_adicionar("alerta", tarefa_alerta, 0);
+    tarefa_display = agendador_adicionar("display", tarefa_display_oled, PERIODO_DISPLAY_MS);
+    agendador_adicionar("ociosa", tarefa_ociosa, PERIODO_OCIOSA_MS);
+
+    // Atividades supervisionadas: o watchdog só é alimentado com todas dando sinal dentro do prazo
+    vigia_rede = vigia_registrar("rede", PRAZO_VIGIA_REDE_MS);
+    vigia_amostragem = vigia_registrar("amostragem", 2 * PERIODO_AMOSTRAGEM_MS + PRAZO_VIGIA_FOLGA_MS);
+    vigia_display = vigia_registrar("display", PRAZO_VIGIA_DISPLAY_MS);
+    vigia_armar();
+
+    agendador_executar(); // Não retorna
 
     cyw43_arch_deinit();
     return 0;
@@ -0,0 +1,174 @@
+#include <stdio.h>
+#include "pico/stdlib.h"
+#include "hardware/sync.h"
+#include "agendador.h"
+
+static tarefa_t tarefas[AGENDADOR_MAX_TAREFAS];
+static int n_tarefas = 0;
+
+// Tarefa em execução, consultada pelas interrupções (diagnóstico do watchdog)
+static volatile int atual = -1;
+static volatile uint32_t atual_inicio_us;
+
+// Contabilidade de energia: tempo dormindo em WFE e instante de início do agendador
+static uint64_t dormindo_us = 0;
+static absolute_time_t inicio_agendador;
+
+int agendador_adicionar(const char *nome, tarefa_funcao_t funcao, uint32_t periodo_ms) {
+    if (n_tarefas >= AGENDADOR_MAX_TAREFAS) {
+        return -1;
+    }
+    tarefa_t *t = &tarefas[n_tarefas];
+    t->nome = nome;
+    t->funcao = funcao;
+    t->periodo_us = periodo_ms * 1000;
+    t->proximo = periodo_ms ? get_absolute_time() : at_the_end_of_time;
+    t->pendente = false;
+    return n_tarefas++;
+}
+
+void agendador_definir_periodo(int id, uint32_t periodo_ms) {
+    if (id < 0 || id >= n_tarefas || periodo_ms == 0 || tarefas[id].periodo_us == 0) {
+        return;
+    }
+    // O próximo prazo passa a contar da última liberação com o novo período
+    // (encurtar vale já, sem esperar o fim do período antigo)
+    tarefa_t *t = &tarefas[id];
+    uint64_t ultima = to_us_since_boot(t->proximo) - t->periodo_us;
+    t->periodo_us = periodo_ms * 1000;
+    t->proximo = from_us_since_boot(ultima + t->periodo_us);
+}
+
+uint32_t agendador_periodo_ms(int id) {
+    return (id < 0 || id >= n_tarefas) ? 0 : tarefas[id].periodo_us / 1000;
+}
+
+void agendador_sinalizar(int id) {
+    if (id < 0 || id >= n_tarefas) {
+        return;
+    }
+    tarefas[id].pendente = true;
+    __sev(); // Acorda o núcleo se estiver em WFE
+}
+
+// Tarefa pronta com o prazo mais antigo (eventos têm prazo "agora")
+static tarefa_t *proxima_pronta(absolute_time_t agora) {
+    tarefa_t *escolhida = NULL;
+    int64_t menor = 0;
+    for (int i = 0; i < n_tarefas; i++) {
+        tarefa_t *t = &tarefas[i];
+        int64_t folga = t->pendente ? 0 : absolute_time_diff_us(agora, t->proximo);
+        if (folga <= 0 && (!escolhida || folga < menor)) {
+            escolhida = t;
+            menor = folga;
+        }
+    }
+    return escolhida;
+}
+
+static void executar(tarefa_t *t, absolute_time_t agora) {
+    bool por_evento = t->pendente;
+    t->pendente = false;
+
+    // Jitter: atraso entre a liberação (prazo) e o início efetivo
+    uint32_t jitter = por_evento ? 0 : (uint32_t)absolute_time_diff_us(t->proximo, agora);
+
+    atual_inicio_us = time_us_32();
+    atual = t - tarefas;
+    t->funcao();
+    atual = -1;
+
+    absolute_time_t fim = get_absolute_time();
+    uint32_t duracao = (uint32_t)absolute_time_diff_us(agora, fim);
+    t->execucoes++;
+    t->duracao_soma_us += duracao;
+    t->jitter_soma_us += jitter;
+    if (jitter > t->jitter_max_us) {
+        t->jitter_max_us = jitter;
+    }
+    if (duracao > t->duracao_max_us) {
+        t->duracao_max_us = duracao;
+    }
+
+    if (t->periodo_us && !por_evento) {
+        // Próximo prazo relativo ao prazo anterior (sem deriva acumulada)
+        t->proximo = delayed_by_us(t->proximo, t->periodo_us);
+        if (absolute_time_diff_us(t->proximo, fim) > 0) {
+            // Perdeu a liberação seguinte: conta o atraso e realinha a partir de agora
+            t->atrasos++;
+            t->proximo = delayed_by_us(fim, t->periodo_us);
+        }
+    }
+}
+
+void agendador_executar(void) {
+    inicio_agendador = get_absolute_time();
+    while (true) {
+        absolute_time_t agora = get_absolute_time();
+        tarefa_t *t = proxima_pronta(agora);
+        if (t) {
+            executar(t, agora);
+            continue;
+        }
+
+        // Nenhuma tarefa pronta: dorme até o prazo mais próximo ou até um evento
+        absolute_time_t prazo = at_the_end_of_time;
+        for (int i = 0; i < n_tarefas; i++) {
+            if (absolute_time_diff_us(tarefas[i].proximo, prazo) > 0) {
+                prazo = tarefas[i].proximo;
+            }
+        }
+        // (o tempo gasto em IRQs durante o WFE é contado como dormindo)
+        absolute_time_t antes = get_absolute_time();
+        bool evento = false;
+        while (!evento && !time_reached(prazo)) {
+            best_effort_wfe_or_timeout(prazo);
+            for (int i = 0; i < n_tarefas; i++) {
+                evento |= tarefas[i].pendente;
+            }
+        }
+        dormindo_us += absolute_time_diff_us(antes, get_absolute_time());
+    }
+}
+
+int agendador_tarefa_atual(uint32_t *inicio_us) {
+    int id = atual;
+    if (inicio_us) {
+        *inicio_us = atual_inicio_us;
+    }
+    return id;
+}
+
+const char *agendador_nome(int id) {
+    return (id < 0 || id >= n_tarefas) ? "" : tarefas[id].nome;
+}
+
+void agendador_ciclo_ativo(uint64_t *acordado, uint64_t *dormindo) {
+    uint64_t total = is_nil_time(inicio_agendador) ? 0 : absolute_time_diff_us(inicio_agendador, get_absolute_time());
+    *dormindo = dormindo_us;
+    *acordado = total > dormindo_us ? total - dormindo_us : 0;
+}
+
+size_t agendador_relatorio(char *buf, size_t cap) {
+    uint64_t acordado, dormindo;
+    agendador_ciclo_ativo(&acordado, &dormindo);
+    size_t len = snprintf(buf, cap, "{\"acordado_ms\":%llu,\"dormindo_ms\":%llu,\"ciclo_ativo\":%.4f,\"tarefas\":[",
+                          (unsigned long long)(acordado / 1000), (unsigned long long)(dormindo / 1000),
+                          acordado + dormindo ? (double)acordado / (acordado + dormindo) : 0.0);
+    for (int i = 0; i < n_tarefas && len < cap; i++) {
+        const tarefa_t *t = &tarefas[i];
+        len += snprintf(buf + len, cap - len,
+                        "%s{\"nome\":\"%s\",\"periodo_ms\":%lu,\"execucoes\":%lu,\"atrasos\":%lu,"
+                        "\"jitter_medio_us\":%lu,\"jitter_max_us\":%lu,\"duracao_media_us\":%lu,\"duracao_max_us\":%lu}",
+                        i ? "," : "", t->nome, (unsigned long)(t->periodo_us / 1000), (unsigned long)t->execucoes,
+                        (unsigned long)t->atrasos,
+                        (unsigned long)(t->execucoes ? t->jitter_soma_us / t->execucoes : 0),
+                        (unsigned long)t->jitter_max_us,
+                        (unsigned long)(t->execucoes ? t->duracao_soma_us / t->execucoes : 0),
+                        (unsigned long)t->duracao_max_us);
+    }
+    if (len < cap) {
+        len += snprintf(buf + len, cap - len, "]}");
+    }
+    return len < cap ? len : cap - 1;
+}
@@ -0,0 +1,54 @@
+#ifndef AGENDADOR_H
+#define AGENDADOR_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "pico/stdlib.h"
+
+#define AGENDADOR_MAX_TAREFAS 8
+
+typedef void (*tarefa_funcao_t)(void);
+
+typedef struct {
+    const char *nome;
+    tarefa_funcao_t funcao;
+    uint32_t periodo_us;       // 0 = tarefa executada apenas por evento
+    absolute_time_t proximo;   // Próximo prazo de liberação
+    volatile bool pendente;    // Sinalizada por evento (IRQ ou outra tarefa)
+
+    // Estatísticas
+    uint32_t execucoes;
+    uint32_t atrasos;          // Execuções que terminaram depois da liberação seguinte
+    uint32_t jitter_max_us;    // Maior atraso entre a liberação e o início
+    uint64_t jitter_soma_us;
+    uint32_t duracao_max_us;
+    uint64_t duracao_soma_us;  // Tempo acordado gasto pela tarefa
+} tarefa_t;
+
+// Cadastra uma tarefa periódica (periodo_ms > 0) ou por evento (periodo_ms = 0) e retorna seu id
+int agendador_adicionar(const char *nome, tarefa_funcao_t funcao, uint32_t periodo_ms);
+
+// Altera o período de uma tarefa periódica (o próximo prazo é recalculado a partir da última liberação)
+void agendador_definir_periodo(int id, uint32_t periodo_ms);
+
+uint32_t agendador_periodo_ms(int id);
+
+// Marca a tarefa para execução imediata (pode ser chamada de IRQ)
+void agendador_sinalizar(int id);
+
+// Executa as tarefas por ordem de prazo e dorme com WFE até o próximo prazo (não retorna)
+void agendador_executar(void);
+
+// Tarefa em execução (-1 se o agendador está entre tarefas ou dormindo) e o instante em que começou
+int agendador_tarefa_atual(uint32_t *inicio_us);
+
+const char *agendador_nome(int id);
+
+// Tempo total acordado e dormindo (WFE) desde o início do agendador
+void agendador_ciclo_ativo(uint64_t *acordado_us, uint64_t *dormindo_us);
+
+// Gera um JSON com as estatísticas de cada tarefa e o ciclo ativo
+size_t agendador_relatorio(char *buf, size_t cap);
+
+#endif // AGENDADOR_H
@@ -1,24 +1,31 @@
 #include <stdio.h>
 #include "pico/stdlib.h"
 #include "hardware/i2c.h"
+#include "i2c_fila.h"
 #include "aht20.h"
 
-#define AHT20_I2C_ADDR      0x38
-#define AHT20_CMD_INIT      0xBE
-#define AHT20_CMD_TRIGGER   0xAC
-#define AHT20_CMD_RESET     0xBA
-#define AHT20_STATUS_BUSY   0x80  // Bit de status ocupado
-#define AHT20_STATUS_CALIBRATED 0x08  // Bit de calibração
+// Escrita e leitura com prazo: false se o sensor não respondeu (NACK ou barramento preso)
+static bool escrever(i2c_inst_t *i2c, const uint8_t *buf, size_t n) {
+    return i2c_write_timeout_us(i2c, AHT20_I2C_ADDR, buf, n, false, I2C_PRAZO_US(n)) == (int)n;
+}
+
+static bool ler(i2c_inst_t *i2c, uint8_t *buf, size_t n) {
+    return i2c_read_timeout_us(i2c, AHT20_I2C_ADDR, buf, n, false, I2C_PRAZO_US(n)) == (int)n;
+}
 
 bool aht20_init(i2c_inst_t *i2c) {
     uint8_t init_cmd[3] = {AHT20_CMD_INIT, 0x08, 0x00};
-    i2c_write_blocking(i2c, AHT20_I2C_ADDR, init_cmd, 3, false);
+    if (!escrever(i2c, init_cmd, 3)) {
+        return false; // Sem resposta: não adianta esperar a calibração
+    }
     sleep_ms(50);  // Aguarda o sensor inicializar
 
     // Verifica status até que o sensor esteja pronto
     uint8_t status;
     for (int i = 0; i < 10; i++) {
-        i2c_read_blocking(i2c, AHT20_I2C_ADDR, &status, 1, false);
+        if (!ler(i2c, &status, 1)) {
+            return false;
+        }
         if ((status & AHT20_STATUS_CALIBRATED) == AHT20_STATUS_CALIBRATED) {
             return true;  // Sensor calibrado e pronto
         }
@@ -33,12 +40,16 @@ bool aht20_read(i2c_inst_t *i2c, AHT20_Data *data) {
     uint8_t buffer[6];
 
     // Envia comando de medição
-    i2c_write_blocking(i2c, AHT20_I2C_ADDR, trigger_cmd, 3, false);
-    
+    if (!escrever(i2c, trigger_cmd, 3)) {
+        return false;
+    }
+
     // Aguarda até o sensor estar pronto
-    uint8_t status;
+    uint8_t status = AHT20_STATUS_BUSY;
     for (int i = 0; i < 10; i++) {
-        i2c_read_blocking(i2c, AHT20_I2C_ADDR, &status, 1, false);
+        if (!ler(i2c, &status, 1)) {
+            return false;
+        }
         if (!(status & AHT20_STATUS_BUSY)) {
             break;
         }
@@ -51,29 +62,32 @@ bool aht20_read(i2c_inst_t *i2c, AHT20_Data *data) {
     }
 
     // Lê os 6 bytes de dados
-    if (i2c_read_blocking(i2c, AHT20_I2C_ADDR, buffer, 6, false) != 6) {
+    if (!ler(i2c, buffer, 6)) {
         return false;
     }
 
-    // Processa os dados de umidade (20 bits)
-    uint32_t raw_humidity = ((uint32_t)buffer[1] << 12) | ((uint32_t)buffer[2] << 4) | (buffer[3] >> 4);
-    data->humidity = (float)raw_humidity * 100.0 / 1048576.0;
-
-    // Processa os dados de temperatura (20 bits)
-    uint32_t raw_temp = ((uint32_t)(buffer[3] & 0x0F) << 16) | ((uint32_t)buffer[4] << 8) | buffer[5];
-    data->temperature = ((float)raw_temp * 200.0 / 1048576.0) - 50.0;
-
-    return true;
+    return aht20_parse(buffer, data);
 }
 
-void aht20_reset(i2c_inst_t *i2c) {
+bool aht20_reset(i2c_inst_t *i2c) {
     uint8_t reset_cmd = AHT20_CMD_RESET;
-    i2c_write_blocking(i2c, AHT20_I2C_ADDR, &reset_cmd, 1, false);
+    if (!escrever(i2c, &reset_cmd, 1)) {
+        return false;
+    }
     sleep_ms(20);
-    aht20_init(i2c);
+    return aht20_init(i2c);
 }
 
 bool aht20_check(i2c_inst_t *i2c) {
     uint8_t status;
-    return i2c_read_blocking(i2c, AHT20_I2C_ADDR, &status, 1, false) == 1;
+    return ler(i2c, &status, 1);
+}
+
+bool aht20_status(i2c_inst_t *i2c, uint8_t *status) {
+    return ler(i2c, status, 1);
+}
+
+bool aht20_calibrate(i2c_inst_t *i2c) {
+    uint8_t init_cmd[3] = {AHT20_CMD_INIT, 0x08, 0x00};
+    return escrever(i2c, init_cmd, 3);
 }
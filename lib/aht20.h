@@ -1,6 +1,7 @@
 #ifndef AHT20_H
 #define AHT20_H
 
+#include "conversao.h"
 
 // Endereço I2C do AHT20
 #define AHT20_I2C_ADDR  0x38
@@ -10,11 +11,12 @@
 #define AHT20_CMD_TRIGGER   0xAC
 #define AHT20_CMD_RESET     0xBA
 
-// Estrutura para armazenar os valores de temperatura e umidade
-typedef struct {
-    float temperature;
-    float humidity;
-} AHT20_Data;
+#define AHT20_STATUS_CALIBRATED 0x08 // Bit de calibração no byte de status
+
+// Tempo de conversão após o comando de medição (datasheet: 80 ms)
+#define AHT20_TEMPO_MEDICAO_MS 80
+
+// Operações bloqueantes com prazo por transferência (I2C_PRAZO_US); false se o sensor não respondeu
 
 // Inicializa o sensor AHT20
 bool aht20_init(i2c_inst_t *i2c);
@@ -22,9 +24,15 @@ bool aht20_init(i2c_inst_t *i2c);
 // Faz a leitura de temperatura e umidade do AHT20
 bool aht20_read(i2c_inst_t *i2c, AHT20_Data *data);
 
-// Reseta o sensor AHT20
-void aht20_reset(i2c_inst_t *i2c);
+// Reseta e inicializa o sensor AHT20
+bool aht20_reset(i2c_inst_t *i2c);
 
 bool aht20_check(i2c_inst_t *i2c);
 
+// Lê o byte de status (sem esperas)
+bool aht20_status(i2c_inst_t *i2c, uint8_t *status);
+
+// Envia o comando de inicialização sem aguardar a calibração (cerca de 10 ms no sensor)
+bool aht20_calibrate(i2c_inst_t *i2c);
+
 #endif // AHT20_H
@@ -0,0 +1,164 @@
+#include <stdio.h>
+#include <math.h>
+#include "alertas.h"
+
+static alerta_regra_t regras[ALERTAS_MAX];
+static alerta_estado_t estados[ALERTAS_MAX];
+static int n_regras = 0;
+static alerta_transicao_cb_t transicao_cb = NULL;
+
+// Taxa de variação por canal, medida entre amostras separadas por pelo menos ALERTAS_JANELA_TAXA_MS
+static struct {
+    bool iniciado;
+    float referencia;
+    uint64_t referencia_us;
+    float taxa; // Unidade do canal por minuto
+} canais[ALERTA_CANAIS];
+
+void alertas_iniciar(const alerta_regra_t *tabela, int n, alerta_transicao_cb_t cb) {
+    if (n > ALERTAS_MAX) {
+        n = ALERTAS_MAX;
+    }
+    for (int i = 0; i < n; i++) {
+        regras[i] = tabela[i];
+        estados[i] = (alerta_estado_t){0};
+    }
+    for (int c = 0; c < ALERTA_CANAIS; c++) {
+        canais[c].iniciado = false;
+        canais[c].taxa = 0;
+    }
+    n_regras = n;
+    transicao_cb = cb;
+}
+
+static void atualizar_taxa(int c, float x, uint64_t agora_us) {
+    if (!canais[c].iniciado) {
+        canais[c].iniciado = true;
+        canais[c].referencia = x;
+        canais[c].referencia_us = agora_us;
+        return;
+    }
+    uint64_t dt = agora_us - canais[c].referencia_us;
+    if (dt >= (uint64_t)ALERTAS_JANELA_TAXA_MS * 1000) {
+        canais[c].taxa = (x - canais[c].referencia) * 60e6f / (float)dt;
+        canais[c].referencia = x;
+        canais[c].referencia_us = agora_us;
+    }
+}
+
+// Condição de entrada e de permanência (com a histerese aplicada a quem já está ativo)
+static bool condicao(const alerta_regra_t *r, bool ativo, float v) {
+    float h = ativo ? r->histerese : 0;
+    switch (r->condicao) {
+    case ALERTA_ACIMA:
+    case ALERTA_SUBIDA:
+    case ALERTA_QUEDA:
+        return ativo ? v > r->limiar - h : v >= r->limiar;
+    case ALERTA_ABAIXO:
+        return ativo ? v < r->limiar + h : v <= r->limiar;
+    }
+    return false;
+}
+
+void alertas_avaliar(const float valores[ALERTA_CANAIS], uint64_t agora_us) {
+    for (int c = 0; c < ALERTA_CANAIS; c++) {
+        if (!isnan(valores[c])) {
+            atualizar_taxa(c, valores[c], agora_us);
+        }
+    }
+
+    for (int i = 0; i < n_regras; i++) {
+        const alerta_regra_t *r = &regras[i];
+        alerta_estado_t *e = &estados[i];
+        float v = valores[r->canal];
+        if (isnan(v)) {
+            continue; // Canal sem leitura: mantém o estado
+        }
+        if (r->condicao == ALERTA_SUBIDA) {
+            v = canais[r->canal].taxa;
+        } else if (r->condicao == ALERTA_QUEDA) {
+            v = -canais[r->canal].taxa;
+        }
+        e->valor = v;
+
+        bool ativar = condicao(r, e->ativo, v);
+        if (e->ativo) {
+            if (!ativar) {
+                e->ativo = false;
+                e->pendente = false;
+                if (transicao_cb) {
+                    transicao_cb(i, r, false, v);
+                }
+            }
+            continue;
+        }
+
+        if (!ativar) {
+            e->pendente = false;
+            continue;
+        }
+        if (!e->pendente) {
+            e->pendente = true;
+            e->desde_us = agora_us;
+        }
+        if (agora_us - e->desde_us >= (uint64_t)r->duracao_ms * 1000) {
+            e->ativo = true;
+            e->pendente = false;
+            e->desde_us = agora_us;
+            e->ativacoes++;
+            if (transicao_cb) {
+                transicao_cb(i, r, true, v);
+            }
+        }
+    }
+}
+
+void alertas_definir_limiar(int regra, float limiar) {
+    if (regra >= 0 && regra < n_regras) {
+        regras[regra].limiar = limiar;
+    }
+}
+
+int alertas_quantidade(void) {
+    return n_regras;
+}
+
+const alerta_regra_t *alertas_regra(int regra) {
+    return (regra >= 0 && regra < n_regras) ? &regras[regra] : NULL;
+}
+
+const alerta_estado_t *alertas_estado(int regra) {
+    return (regra >= 0 && regra < n_regras) ? &estados[regra] : NULL;
+}
+
+bool alertas_ativo(int regra) {
+    return regra >= 0 && regra < n_regras && estados[regra].ativo;
+}
+
+int alertas_prioritario(uint8_t acao) {
+    for (int i = 0; i < n_regras; i++) {
+        if (estados[i].ativo && (regras[i].acoes & acao)) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+size_t alertas_relatorio(char *buf, size_t cap) {
+    static const char *condicoes[] = { "acima", "abaixo", "subida", "queda" };
+    size_t len = snprintf(buf, cap, "{\"regras\":[");
+    for (int i = 0; i < n_regras && len < cap; i++) {
+        const alerta_regra_t *r = &regras[i];
+        const alerta_estado_t *e = &estados[i];
+        len += snprintf(buf + len, cap - len,
+                        "%s{\"nome\":\"%s\",\"condicao\":\"%s\",\"limiar\":%.3f,\"histerese\":%.3f,\"duracao_ms\":%lu,"
+                        "\"ativo\":%s,\"pendente\":%s,\"valor\":%.3f,\"ativacoes\":%lu}",
+                        i ? "," : "", r->nome, condicoes[r->condicao], r->limiar, r->histerese,
+                        (unsigned long)r->duracao_ms, e->ativo ? "true" : "false", e->pendente ? "true" : "false",
+                        e->valor, (unsigned long)e->ativacoes);
+    }
+    if (len < cap) {
+        len += snprintf(buf + len, cap - len, "]}");
+    }
+    return len < cap ? len : cap - 1;
+}
@@ -0,0 +1,85 @@
+#ifndef ALERTAS_H
+#define ALERTAS_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+// Motor de regras de alerta: cada regra compara um canal com um limiar (nível ou taxa de variação),
+// com banda de histerese e tempo mínimo de permanência. A avaliação é incremental e o callback só é
+// chamado nas transições (ativou/desativou), então as saídas não são reescritas a cada amostra.
+
+#define ALERTAS_MAX 12
+#define ALERTAS_JANELA_TAXA_MS 60000 // Janela mínima para medir a taxa de variação (filtra o ruído)
+
+// Canais avaliados (índices do vetor passado a alertas_avaliar)
+typedef enum {
+    ALERTA_TEMPERATURA,
+    ALERTA_UMIDADE,
+    ALERTA_PRESSAO, // kPa
+    ALERTA_INDICE_CALOR, // °C (grandeza derivada)
+    ALERTA_CANAIS
+} alerta_canal_t;
+
+typedef enum {
+    ALERTA_ACIMA,  // valor >= limiar; desativa abaixo de limiar - histerese
+    ALERTA_ABAIXO, // valor <= limiar; desativa acima de limiar + histerese
+    ALERTA_SUBIDA, // variação >= limiar por minuto; desativa abaixo de limiar - histerese
+    ALERTA_QUEDA   // queda >= limiar por minuto; desativa abaixo de limiar - histerese
+} alerta_condicao_t;
+
+// Ações executadas nas transições (máscara de bits)
+#define ALERTA_ACAO_MATRIZ (1u << 0) // Padrão na matriz de LEDs enquanto ativa (ordem da tabela = prioridade)
+#define ALERTA_ACAO_BUZZER (1u << 1) // Sequência de bipes ao ativar
+#define ALERTA_ACAO_REDE   (1u << 2) // Evento MQTT na ativação e na desativação
+
+typedef struct {
+    uint8_t bipes;        // 0 = sem som
+    uint16_t duracao_ms;  // Duração de cada bipe
+    uint16_t intervalo_ms; // Silêncio entre bipes
+} alerta_buzzer_t;
+
+typedef struct {
+    const char *nome;
+    alerta_canal_t canal;
+    alerta_condicao_t condicao;
+    float limiar;
+    float histerese;
+    uint32_t duracao_ms;  // Condição deve se manter por este tempo antes de ativar (0 = imediato)
+    uint8_t acoes;        // ALERTA_ACAO_*
+    uint8_t padrao_matriz; // Índice do padrão na matriz (interpretado pelo chamador)
+    alerta_buzzer_t buzzer;
+} alerta_regra_t;
+
+typedef struct {
+    bool ativo;
+    bool pendente;        // Condição verdadeira, aguardando duracao_ms
+    uint64_t desde_us;    // Início da condição pendente ou da ativação
+    float valor;          // Último valor avaliado (nível ou taxa por minuto)
+    uint32_t ativacoes;
+} alerta_estado_t;
+
+// Chamado em cada transição de uma regra
+typedef void (*alerta_transicao_cb_t)(int regra, const alerta_regra_t *r, bool ativo, float valor);
+
+// Carrega a tabela de regras (copiada: os limiares podem ser alterados depois) e zera os estados
+void alertas_iniciar(const alerta_regra_t *regras, int n, alerta_transicao_cb_t cb);
+
+// Avalia todas as regras com uma nova amostra (valores indexados por alerta_canal_t)
+void alertas_avaliar(const float valores[ALERTA_CANAIS], uint64_t agora_us);
+
+// Altera o limiar de uma regra (a regra é reavaliada na próxima amostra)
+void alertas_definir_limiar(int regra, float limiar);
+
+int alertas_quantidade(void);
+const alerta_regra_t *alertas_regra(int regra);
+const alerta_estado_t *alertas_estado(int regra);
+bool alertas_ativo(int regra);
+
+// Regra ativa de maior prioridade com a ação pedida (-1 = nenhuma)
+int alertas_prioritario(uint8_t acao);
+
+// Gera um JSON com as regras e seus estados
+size_t alertas_relatorio(char *buf, size_t cap);
+
+#endif // ALERTAS_H
@@ -0,0 +1,89 @@
+#include <stdio.h>
+#include <math.h>
+#include "derivadas.h"
+#include "amostra.h"
+
+typedef struct {
+    volatile uint32_t versao; // Ímpar enquanto a amostra é escrita
+    amostra_t amostra;
+} copia_t;
+
+static copia_t copias[2];
+static volatile uint32_t publicada = 0; // Índice da cópia mais recente
+static uint32_t sequencia = 0;
+
+// Barreira de memória (DMB no RP2040) e do compilador: ordena a versão em relação aos valores
+#define BARREIRA() __atomic_thread_fence(__ATOMIC_SEQ_CST)
+
+uint32_t amostra_publicar(const amostra_t *a) {
+    copia_t *c = &copias[publicada ^ 1];
+    c->versao++;
+    BARREIRA();
+    c->amostra = *a;
+    c->amostra.sequencia = ++sequencia;
+    BARREIRA();
+    c->versao++;
+    BARREIRA();
+    publicada ^= 1;
+    return sequencia;
+}
+
+uint32_t amostra_ler(amostra_t *dest) {
+    for (;;) {
+        const copia_t *c = &copias[publicada];
+        uint32_t versao = c->versao;
+        BARREIRA();
+        *dest = c->amostra;
+        BARREIRA();
+        if (!(versao & 1) && c->versao == versao) {
+            return dest->sequencia;
+        }
+    }
+}
+
+float amostra_derivada(const amostra_t *a, derivada_t d, amostra_derivadas_t *cache) {
+    if (d >= DERIVADAS_N) {
+        return NAN;
+    }
+    if (cache->sequencia != a->sequencia) {
+        cache->sequencia = a->sequencia;
+        cache->calculadas = 0;
+    }
+    if (!(cache->calculadas & (1u << d))) {
+        // Mesmas entradas que a coleta passa a lib/derivadas (a pressão só depois da primeira leitura)
+        const float entradas[DERIVADAS_ENTRADAS] = {
+            [DERIVADAS_TEMPERATURA] = a->temperatura,
+            [DERIVADAS_UMIDADE] = a->umidade,
+            [DERIVADAS_PRESSAO] = a->pressao_bruta > 0 ? a->pressao_kpa : NAN,
+        };
+        cache->valores[d] = derivadas_calcular(d, entradas);
+        cache->calculadas |= 1u << d;
+    }
+    return cache->valores[d];
+}
+
+size_t amostra_json(char *buf, size_t cap, const amostra_t *a) {
+    static amostra_derivadas_t cache; // Pedidos repetidos de /dados na mesma amostra não recalculam
+    float valores[DERIVADAS_N];
+    for (int d = 0; d < DERIVADAS_N; d++) {
+        valores[d] = amostra_derivada(a, (derivada_t)d, &cache);
+    }
+    char derivadas_json[256];
+    derivadas_relatorio(derivadas_json, sizeof(derivadas_json), valores);
+    float altitude_bruta = a->pressao_bruta > 0 ? derivadas_altitude(a->pressao_bruta) : 0.0f;
+    int len = snprintf(buf, cap,
+                       "{\"seq\":%lu,\"dt\":%lu,\"tem\":%.1f,\"pre\":%.2f,\"alt\":%.0f,\"umi\":%.1f,"
+                       "\"bruto\":{\"tem\":%.2f,\"pre\":%.3f,\"alt\":%.1f,\"umi\":%.2f},"
+                       "\"velho\":{\"tem\":%s,\"pre\":%s,\"umi\":%s},"
+                       "\"derivadas\":%s}\r\n",
+                       (unsigned long)a->sequencia, (unsigned long)a->intervalo_ms, a->temperatura, a->pressao_kpa, a->altitude, a->umidade,
+                       a->temperatura_bruta, a->pressao_bruta / 1000.0f,
+                       altitude_bruta, a->umidade_bruta,
+                       a->velhos & AMOSTRA_VELHA_TEMPERATURA ? "true" : "false",
+                       a->velhos & AMOSTRA_VELHA_PRESSAO ? "true" : "false",
+                       a->velhos & AMOSTRA_VELHA_UMIDADE ? "true" : "false", derivadas_json);
+    if (len < 0) {
+        return 0;
+    }
+    return (size_t)len < cap ? (size_t)len : cap - 1;
+}
@@ -0,0 +1,58 @@
+#ifndef AMOSTRA_H
+#define AMOSTRA_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "derivadas.h"
+
+// Amostra corrente como é servida em /dados: valores finais (filtrados, com offset) e a última leitura bruta.
+// As grandezas derivadas não são guardadas: cada leitor as calcula da cópia que leu com amostra_derivada, só as
+// que usa e uma vez por amostra (o cache é do leitor, então nada é compartilhado com a coleta).
+// Grandezas cujo sensor não deu leitura válida no último ciclo mantêm o último valor e são marcadas em velhos.
+// A coleta publica cada amostra inteira com amostra_publicar; HTTP, display, alertas e interrupções leem com
+// amostra_ler, sem trava, e nunca recebem valores misturados de duas amostras.
+// São duas cópias, cada uma com um contador de versão (ímpar durante a escrita): a escrita vai sempre para a
+// cópia que não está publicada e só depois troca o índice. Um leitor que interrompe a escrita no mesmo núcleo lê
+// a cópia publicada, que não está sendo alterada, e não precisa repetir; no outro núcleo, repete a leitura só se
+// a escrita alcançou a cópia durante a cópia (duas publicações nesse intervalo).
+
+// Bits de amostra_t.velhos
+#define AMOSTRA_VELHA_TEMPERATURA 1 // AHT20
+#define AMOSTRA_VELHA_UMIDADE 2     // AHT20
+#define AMOSTRA_VELHA_PRESSAO 4     // BMP280 (e a altitude, calculada da pressão)
+
+typedef struct {
+    float temperatura;       // °C
+    float pressao_kpa;
+    float altitude;          // m
+    float umidade;           // %
+    float temperatura_bruta; // °C (AHT20)
+    float umidade_bruta;     // %
+    int32_t pressao_bruta;   // Pa (BMP280; 0 = ainda sem leitura)
+    uint32_t intervalo_ms;   // Intervalo real desde a amostra anterior (0 = primeira)
+    uint8_t velhos;          // AMOSTRA_VELHA_*
+    uint32_t sequencia;      // Número da amostra, preenchido por amostra_publicar (0 = nenhuma publicada)
+} amostra_t;
+
+// Grandezas derivadas já calculadas por um leitor (um por contexto: HTTP, display, alertas)
+typedef struct {
+    uint32_t sequencia;  // Amostra a que os valores se referem
+    uint32_t calculadas; // Bit d: valores[d] já calculado
+    float valores[DERIVADAS_N];
+} amostra_derivadas_t;
+
+// Publica a amostra (um único escritor; não chamar de interrupção) e retorna a sequência atribuída a ela
+uint32_t amostra_publicar(const amostra_t *a);
+
+// Cópia consistente da última amostra publicada; retorna sua sequência. Pode ser chamada de qualquer contexto.
+uint32_t amostra_ler(amostra_t *dest);
+
+// Grandeza derivada da amostra (NAN = indisponível), calculada na primeira vez que o leitor a pede para essa
+// sequência
+float amostra_derivada(const amostra_t *a, derivada_t d, amostra_derivadas_t *cache);
+
+// Gera o JSON de /dados com os campos e as grandezas derivadas da amostra, além da altitude da pressão bruta
+// (calculadas aqui, só quando /dados é servido; chamar de um só contexto)
+size_t amostra_json(char *buf, size_t cap, const amostra_t *a);
+
+#endif // AMOSTRA_H
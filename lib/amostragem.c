@@ -0,0 +1,109 @@
+#include <stdio.h>
+#include <math.h>
+#include "amostragem.h"
+
+static amostragem_canal_t canais[AMOSTRAGEM_CANAIS_MAX];
+static int n_canais = 0;
+
+static uint32_t periodo_min_ms = 300;
+static uint32_t periodo_max_ms = 300;
+static uint32_t periodo_ms = 300;
+
+void amostragem_configurar(uint32_t min_ms, uint32_t max_ms) {
+    if (min_ms == 0 || max_ms < min_ms) {
+        return;
+    }
+    periodo_min_ms = min_ms;
+    periodo_max_ms = max_ms;
+    periodo_ms = min_ms; // Recomeça rápido e deixa as observações alongarem
+}
+
+void amostragem_limites(uint32_t *min_ms, uint32_t *max_ms) {
+    *min_ms = periodo_min_ms;
+    *max_ms = periodo_max_ms;
+}
+
+int amostragem_canal(const char *nome, float limiar_taxa, float limiar_desvio) {
+    if (n_canais >= AMOSTRAGEM_CANAIS_MAX) {
+        return -1;
+    }
+    amostragem_canal_t *c = &canais[n_canais];
+    c->nome = nome;
+    c->limiar_taxa = limiar_taxa;
+    c->limiar_desvio = limiar_desvio;
+    c->distancia = NAN;
+    return n_canais++;
+}
+
+void amostragem_observar(int canal, float bruto, float filtrado, float distancia_limite, uint32_t intervalo_ms) {
+    if (canal < 0 || canal >= n_canais) {
+        return;
+    }
+    amostragem_canal_t *c = &canais[canal];
+    float residuo = bruto - filtrado;
+    if (!c->iniciado || intervalo_ms == 0) {
+        c->taxa = 0;
+        c->variancia = residuo * residuo;
+        c->iniciado = true;
+    } else {
+        c->taxa = fabsf(filtrado - c->anterior) * 60000.0f / intervalo_ms;
+        c->variancia += 0.2f * (residuo * residuo - c->variancia);
+    }
+    c->anterior = filtrado;
+    c->distancia = distancia_limite;
+
+    float escore_taxa = c->taxa / c->limiar_taxa;
+    float escore_desvio = sqrtf(c->variancia) / c->limiar_desvio;
+    c->escore = escore_taxa > escore_desvio ? escore_taxa : escore_desvio;
+}
+
+uint32_t amostragem_proximo_periodo(void) {
+    float escore = 0;
+    float proximo = periodo_ms * AMOSTRAGEM_CRESCIMENTO;
+
+    for (int i = 0; i < n_canais; i++) {
+        const amostragem_canal_t *c = &canais[i];
+        if (c->escore > escore) {
+            escore = c->escore;
+        }
+        // Na taxa atual o limite seria cruzado em distancia / taxa: amostra algumas vezes antes disso
+        if (!isnan(c->distancia) && c->taxa > 0) {
+            float cruzamento_ms = fabsf(c->distancia) / c->taxa * 60000.0f;
+            if (cruzamento_ms / AMOSTRAGEM_ANTECEDENCIA < proximo) {
+                proximo = cruzamento_ms / AMOSTRAGEM_ANTECEDENCIA;
+            }
+        }
+    }
+
+    if (escore >= 1.0f) {
+        proximo = periodo_min_ms; // Mudança rápida ou ruído: resolução máxima
+    } else if (escore >= 0.5f && proximo > periodo_ms) {
+        proximo = periodo_ms; // Atividade moderada: mantém o período
+    }
+
+    periodo_ms = proximo < periodo_min_ms ? periodo_min_ms : proximo > periodo_max_ms ? periodo_max_ms : (uint32_t)proximo;
+    return periodo_ms;
+}
+
+uint32_t amostragem_periodo_atual(void) {
+    return periodo_ms;
+}
+
+size_t amostragem_relatorio(char *buf, size_t cap) {
+    size_t len = snprintf(buf, cap, "{\"periodo_ms\":%lu,\"min_ms\":%lu,\"max_ms\":%lu,\"canais\":[",
+                          (unsigned long)periodo_ms, (unsigned long)periodo_min_ms, (unsigned long)periodo_max_ms);
+    for (int i = 0; i < n_canais && len < cap; i++) {
+        const amostragem_canal_t *c = &canais[i];
+        char distancia[16] = "null";
+        if (!isnan(c->distancia)) {
+            snprintf(distancia, sizeof(distancia), "%.3f", c->distancia);
+        }
+        len += snprintf(buf + len, cap - len,
+                        "%s{\"nome\":\"%s\",\"taxa_min\":%.4f,\"desvio\":%.4f,\"distancia\":%s,\"escore\":%.3f}",
+                        i ? "," : "", c->nome, c->taxa, sqrtf(c->variancia), distancia, c->escore);
+    }
+    if (len < cap) {
+        len += snprintf(buf + len, cap - len, "]}");
+    }
+    return len < cap ? len : cap - 1;
+}
@@ -0,0 +1,47 @@
+#ifndef AMOSTRAGEM_H
+#define AMOSTRAGEM_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+// Período de amostragem adaptativo: cresce aos poucos enquanto os canais estão estáveis e volta ao
+// mínimo quando um canal muda rápido, fica ruidoso ou se aproxima de um limite de alerta.
+
+#define AMOSTRAGEM_CANAIS_MAX 4
+#define AMOSTRAGEM_CRESCIMENTO 1.25f // Fator de aumento do período por amostra estável
+#define AMOSTRAGEM_ANTECEDENCIA 4    // Amostras desejadas antes de um cruzamento de limite previsto
+
+typedef struct {
+    const char *nome;
+    float limiar_taxa;   // Variação por minuto considerada significativa (unidade do canal)
+    float limiar_desvio; // Desvio do ruído (bruto - filtrado) considerado significativo
+
+    // Estado
+    bool iniciado;
+    float anterior;  // Último valor filtrado
+    float variancia; // Média móvel de (bruto - filtrado)^2
+    float taxa;      // |variação| por minuto na última amostra
+    float distancia; // Distância até o limite de alerta mais próximo (NAN = sem limite)
+    float escore;    // max(taxa, desvio) normalizado pelos limiares (>= 1: atividade)
+} amostragem_canal_t;
+
+// Limites do período (min_ms = max_ms desliga a adaptação)
+void amostragem_configurar(uint32_t min_ms, uint32_t max_ms);
+void amostragem_limites(uint32_t *min_ms, uint32_t *max_ms);
+
+// Cadastra um canal e retorna seu id
+int amostragem_canal(const char *nome, float limiar_taxa, float limiar_desvio);
+
+// Registra a amostra de um canal; distancia_limite = NAN se o canal não tem limite de alerta
+void amostragem_observar(int canal, float bruto, float filtrado, float distancia_limite, uint32_t intervalo_ms);
+
+// Calcula o próximo período a partir das observações da última amostra
+uint32_t amostragem_proximo_periodo(void);
+
+uint32_t amostragem_periodo_atual(void);
+
+// Gera um JSON com o período, os limites e o estado de cada canal
+size_t amostragem_relatorio(char *buf, size_t cap);
+
+#endif // AMOSTRAGEM_H
@@ -1,104 +1,59 @@
 #include "bmp280.h"
 #include "hardware/i2c.h"
+#include "i2c_fila.h"
 
-#define ADDR _u(0x76)
-
-void bmp280_init(i2c_inst_t *i2c) {
-    uint8_t buf[2];
-    const uint8_t reg_config_val = ((0x04 << 5) | (0x05 << 2)) & 0xFC;
-    buf[0] = REG_CONFIG;
-    buf[1] = reg_config_val;
-   
-    i2c_write_blocking(i2c, ADDR, buf, 2, false);
-
-    const uint8_t reg_ctrl_meas_val = (0x01 << 5) | (0x03 << 2) | (0x03);
-    buf[0] = REG_CTRL_MEAS;
-    buf[1] = reg_ctrl_meas_val;
-    i2c_write_blocking(i2c, ADDR, buf, 2, false);
- //   printf("Ctrl_meas register value: %x\n", reg_ctrl_meas_val);
+bool bmp280_init(i2c_inst_t *i2c, uint8_t addr) {
+    const bmp280_config_t padrao = BMP280_CONFIG_PADRAO;
+    return bmp280_configure(i2c, addr, &padrao);
 }
 
-void bmp280_read_raw(i2c_inst_t *i2c, int32_t* temp, int32_t* pressure) {
-    uint8_t buf[6];
-    uint8_t reg = REG_PRESSURE_MSB;
-    i2c_write_blocking(i2c, ADDR, &reg, 1, true);
-    i2c_read_blocking(i2c, ADDR, buf, 6, false);
-
-    *pressure = (buf[0] << 12) | (buf[1] << 4) | (buf[2] >> 4);
-    *temp = (buf[3] << 12) | (buf[4] << 4) | (buf[5] >> 4);
-
-
+// Escreve config com o sensor em sleep (no modo normal a escrita em REG_CONFIG pode ser ignorada)
+bool bmp280_configure(i2c_inst_t *i2c, uint8_t addr, const bmp280_config_t *cfg) {
+    uint8_t buf[6] = {
+        REG_CTRL_MEAS, bmp280_reg_ctrl_meas(cfg, BMP280_MODO_SLEEP),
+        REG_CONFIG, bmp280_reg_config(cfg),
+        REG_CTRL_MEAS, bmp280_reg_ctrl_meas(cfg, cfg->modo == BMP280_MODO_NORMAL ? BMP280_MODO_NORMAL : BMP280_MODO_SLEEP),
+    };
+    return i2c_write_timeout_us(i2c, addr, buf, sizeof(buf), false, I2C_PRAZO_US(sizeof(buf))) == (int)sizeof(buf);
 }
 
-void bmp280_reset(i2c_inst_t *i2c) {
-    uint8_t buf[2] = { REG_RESET, 0xB6 };
-    i2c_write_blocking(i2c, ADDR, buf, 2, false);
+bool bmp280_config_valid(const bmp280_config_t *cfg) {
+    return cfg->osrs_t <= BMP280_OS_X16 && cfg->osrs_p <= BMP280_OS_X16 && cfg->filtro <= BMP280_FILTRO_16 &&
+           cfg->standby <= 7 &&
+           (cfg->modo == BMP280_MODO_SLEEP || cfg->modo == BMP280_MODO_FORCADO || cfg->modo == BMP280_MODO_NORMAL);
 }
 
-// função intermediária que calcula a temperatura de resolução fina
-// usada tanto para conversões de pressão quanto de temperatura
-int32_t bmp280_convert(int32_t temp, struct bmp280_calib_param* params) {
-    // usa os 32 bits de compensação de ponto fixo implementados no datasheet
-    int32_t var1, var2;
-    var1 = ((((temp >> 3) - ((int32_t)params->dig_t1 << 1))) * ((int32_t)params->dig_t2)) >> 11;
-    var2 = (((((temp >> 4) - ((int32_t)params->dig_t1)) * ((temp >> 4) - ((int32_t)params->dig_t1))) >> 12) * ((int32_t)params->dig_t3)) >> 14;
-    return var1 + var2;
+uint8_t bmp280_reg_config(const bmp280_config_t *cfg) {
+    return (cfg->standby << 5) | (cfg->filtro << 2);
 }
 
-int32_t bmp280_convert_temp(int32_t temp, struct bmp280_calib_param* params) {
-    // Utiliza os parâmetros de calibração do BMP280 para compensar o valor de temperatura lido de seus registradores
-    int32_t t_fine = bmp280_convert(temp, params);
-    return (t_fine * 5 + 128) >> 8;
+uint8_t bmp280_reg_ctrl_meas(const bmp280_config_t *cfg, uint8_t mode) {
+    return (cfg->osrs_t << 5) | (cfg->osrs_p << 2) | mode;
 }
 
+// Lê n registradores a partir de reg (escrita do endereço + RESTART + leitura), com prazo
+static bool ler_registradores(i2c_inst_t *i2c, uint8_t addr, uint8_t reg, uint8_t *buf, size_t n) {
+    return i2c_write_timeout_us(i2c, addr, &reg, 1, true, I2C_PRAZO_US(1)) == 1 &&
+           i2c_read_timeout_us(i2c, addr, buf, n, false, I2C_PRAZO_US(n)) == (int)n;
+}
 
-int32_t bmp280_convert_pressure(int32_t pressure, int32_t temp, struct bmp280_calib_param* params) {
-    // Utiliza os parâmetros de calibração do BMP280 para compensar o valor de pressão lido de seus registradores
-
-    int32_t t_fine = bmp280_convert(temp, params);
-
-    int32_t var1, var2;
-    uint32_t converted = 0.0;
-    var1 = (((int32_t)t_fine) >> 1) - (int32_t)64000;
-    var2 = (((var1 >> 2) * (var1 >> 2)) >> 11) * ((int32_t)params->dig_p6);
-    var2 += ((var1 * ((int32_t)params->dig_p5)) << 1);
-    var2 = (var2 >> 2) + (((int32_t)params->dig_p4) << 16);
-    var1 = (((params->dig_p3 * (((var1 >> 2) * (var1 >> 2)) >> 13)) >> 3) + ((((int32_t)params->dig_p2) * var1) >> 1)) >> 18;
-    var1 = ((((32768 + var1)) * ((int32_t)params->dig_p1)) >> 15);
-    if (var1 == 0) {
-        return 0;  // avoid exception caused by division by zero
-    }
-    converted = (((uint32_t)(((int32_t)1048576) - pressure) - (var2 >> 12))) * 3125;
-    if (converted < 0x80000000) {
-        converted = (converted << 1) / ((uint32_t)var1);
-    } else {
-        converted = (converted / (uint32_t)var1) * 2;
+bool bmp280_read_raw(i2c_inst_t *i2c, uint8_t addr, int32_t* temp, int32_t* pressure) {
+    uint8_t buf[6];
+    if (!ler_registradores(i2c, addr, REG_PRESSURE_MSB, buf, 6)) {
+        return false;
     }
-    var1 = (((int32_t)params->dig_p9) * ((int32_t)(((converted >> 3) * (converted >> 3)) >> 13))) >> 12;
-    var2 = (((int32_t)(converted >> 2)) * ((int32_t)params->dig_p8)) >> 13;
-    converted = (uint32_t)((int32_t)converted + ((var1 + var2 + params->dig_p7) >> 4));
-    return converted;
+    bmp280_decode_raw(buf, temp, pressure);
+    return true;
 }
 
-void bmp280_get_calib_params(i2c_inst_t *i2c, struct bmp280_calib_param* params) {
-    uint8_t buf[NUM_CALIB_PARAMS] = { 0 };
-    uint8_t reg = REG_DIG_T1_LSB;
-    i2c_write_blocking(i2c, ADDR, &reg, 1, true);
-    i2c_read_blocking(i2c, ADDR, buf, NUM_CALIB_PARAMS, false);
-
-    params->dig_t1 = (uint16_t)(buf[1] << 8) | buf[0];
-    params->dig_t2 = (int16_t)(buf[3] << 8) | buf[2];
-    params->dig_t3 = (int16_t)(buf[5] << 8) | buf[4];
-
-    params->dig_p1 = (uint16_t)(buf[7] << 8) | buf[6];
-    params->dig_p2 = (int16_t)(buf[9] << 8) | buf[8];
-    params->dig_p3 = (int16_t)(buf[11] << 8) | buf[10];
-    params->dig_p4 = (int16_t)(buf[13] << 8) | buf[12];
-    params->dig_p5 = (int16_t)(buf[15] << 8) | buf[14];
-    params->dig_p6 = (int16_t)(buf[17] << 8) | buf[16];
-    params->dig_p7 = (int16_t)(buf[19] << 8) | buf[18];
-    params->dig_p8 = (int16_t)(buf[21] << 8) | buf[20];
-    params->dig_p9 = (int16_t)(buf[23] << 8) | buf[22];
-
+bool bmp280_reset(i2c_inst_t *i2c, uint8_t addr) {
+    uint8_t buf[2] = { REG_RESET, 0xB6 };
+    return i2c_write_timeout_us(i2c, addr, buf, 2, false, I2C_PRAZO_US(2)) == 2;
+}
 
+bool bmp280_get_calib_params(i2c_inst_t *i2c, uint8_t addr, struct bmp280_calib_param* params) {
+    uint8_t buf[NUM_CALIB_PARAMS] = { 0 };
+    bool ok = ler_registradores(i2c, addr, REG_DIG_T1_LSB, buf, NUM_CALIB_PARAMS);
+    bmp280_parse_calib(buf, params); // Zerada se o sensor não respondeu
+    return ok && params->dig_t1 != 0;
 }
@@ -2,10 +2,13 @@
 #define BMP280_H
 
 #include "hardware/i2c.h"
+#include "conversao.h"
 
 // Defina os endereços e registros conforme o código original
-#define ADDR _u(0x76)
+#define ADDR _u(0x76)      // SDO em GND
+#define ADDR_ALT _u(0x77)  // SDO em VDDIO
 
+#define REG_STATUS _u(0xF3)
 #define REG_CONFIG _u(0xF5)
 #define REG_CTRL_MEAS _u(0xF4)
 #define REG_RESET _u(0xE0)
@@ -43,30 +46,17 @@
 #define REG_DIG_P9_LSB _u(0x9E)
 #define REG_DIG_P9_MSB _u(0x9F)
 
-#define NUM_CALIB_PARAMS 24
-
-struct bmp280_calib_param {
-    uint16_t dig_t1;
-    int16_t dig_t2;
-    int16_t dig_t3;
-
-    uint16_t dig_p1;
-    int16_t dig_p2;
-    int16_t dig_p3;
-    int16_t dig_p4;
-    int16_t dig_p5;
-    int16_t dig_p6;
-    int16_t dig_p7;
-    int16_t dig_p8;
-    int16_t dig_p9;
-};
+#define NUM_CALIB_PARAMS BMP280_CALIB_LEN
 
 //void bmp280_init(void);
-void bmp280_init(i2c_inst_t *i2c);
-void bmp280_read_raw(i2c_inst_t *i2c, int32_t* temp, int32_t* pressure);
-void bmp280_reset(i2c_inst_t *i2c);
-int32_t bmp280_convert_temp(int32_t temp, struct bmp280_calib_param* params);
-int32_t bmp280_convert_pressure(int32_t pressure, int32_t temp, struct bmp280_calib_param* params);
-void bmp280_get_calib_params(i2c_inst_t *i2c, struct bmp280_calib_param* params);
+// Operações bloqueantes com prazo (I2C_PRAZO_US): retornam false se o sensor não respondeu
+bool bmp280_init(i2c_inst_t *i2c, uint8_t addr);
+bool bmp280_configure(i2c_inst_t *i2c, uint8_t addr, const bmp280_config_t *cfg);
+bool bmp280_config_valid(const bmp280_config_t *cfg);
+uint8_t bmp280_reg_config(const bmp280_config_t *cfg);
+uint8_t bmp280_reg_ctrl_meas(const bmp280_config_t *cfg, uint8_t mode);
+bool bmp280_read_raw(i2c_inst_t *i2c, uint8_t addr, int32_t* temp, int32_t* pressure);
+bool bmp280_reset(i2c_inst_t *i2c, uint8_t addr);
+bool bmp280_get_calib_params(i2c_inst_t *i2c, uint8_t addr, struct bmp280_calib_param* params);
 
 #endif
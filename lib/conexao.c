@@ -0,0 +1,156 @@
+#include <stdio.h>
+#include "pico/stdlib.h"
+#include "pico/cyw43_arch.h"
+#include "conexao.h"
+
+static const char *ssid_rede;
+static const char *senha_rede;
+static uint32_t autenticacao_rede;
+static uint32_t modo_energia_radio;
+static conexao_cb_t callback;
+
+static conexao_estado_t estado = CONEXAO_DESLIGADA;
+static bool radio_pronto = false;
+static uint32_t inicio_associacao_ms;
+static uint32_t espera_ms = CONEXAO_ESPERA_MIN_MS;
+static uint32_t proxima_tentativa_ms;
+static conexao_stats_t stats;
+
+static const char *const nomes_estados[] = {
+    [CONEXAO_DESLIGADA] = "desligada",
+    [CONEXAO_ASSOCIANDO] = "associando",
+    [CONEXAO_CONECTADA] = "conectada",
+    [CONEXAO_ESPERA] = "espera",
+    [CONEXAO_SEM_RADIO] = "sem_radio",
+};
+
+static uint32_t agora_ms(void) {
+    return to_ms_since_boot(get_absolute_time());
+}
+
+static void mudar(conexao_estado_t novo) {
+    if (novo == estado) {
+        return;
+    }
+    estado = novo;
+    if (callback) {
+        callback(novo);
+    }
+}
+
+// Agenda a próxima tentativa e dobra a espera seguinte
+static void esperar(conexao_estado_t novo, uint32_t agora) {
+    proxima_tentativa_ms = agora + espera_ms;
+    espera_ms = espera_ms * 2 < CONEXAO_ESPERA_MAX_MS ? espera_ms * 2 : CONEXAO_ESPERA_MAX_MS;
+    mudar(novo);
+}
+
+static void associar(uint32_t agora) {
+    stats.tentativas++;
+    inicio_associacao_ms = agora;
+    if (cyw43_arch_wifi_connect_async(ssid_rede, senha_rede, autenticacao_rede)) {
+        stats.falhas++;
+        esperar(CONEXAO_ESPERA, agora);
+        return;
+    }
+    mudar(CONEXAO_ASSOCIANDO);
+}
+
+static void falhar(int status, uint32_t agora) {
+    stats.ultimo_status = status;
+    cyw43_wifi_leave(&cyw43_state, CYW43_ITF_STA); // Encerra a associação pendente antes de tentar de novo
+    esperar(CONEXAO_ESPERA, agora);
+}
+
+void conexao_configurar(const char *ssid, const char *senha, uint32_t autenticacao, uint32_t modo_energia, conexao_cb_t cb) {
+    ssid_rede = ssid;
+    senha_rede = senha;
+    autenticacao_rede = autenticacao;
+    modo_energia_radio = modo_energia;
+    callback = cb;
+}
+
+void conexao_executar(void) {
+    uint32_t agora = agora_ms();
+    switch (estado) {
+        case CONEXAO_SEM_RADIO:
+            if ((int32_t)(agora - proxima_tentativa_ms) < 0) {
+                break;
+            }
+            // fall through
+        case CONEXAO_DESLIGADA:
+            if (cyw43_arch_init()) {
+                esperar(CONEXAO_SEM_RADIO, agora_ms());
+                break;
+            }
+            radio_pronto = true;
+            cyw43_arch_enable_sta_mode();
+            associar(agora_ms());
+            break;
+
+        case CONEXAO_ASSOCIANDO: {
+            int status = cyw43_tcpip_link_status(&cyw43_state, CYW43_ITF_STA);
+            if (status == CYW43_LINK_UP) {
+                cyw43_wifi_pm(&cyw43_state, modo_energia_radio); // Modo de economia do rádio
+                stats.conexao_ms = agora - inicio_associacao_ms;
+                if (!stats.primeira_ms) {
+                    stats.primeira_ms = agora;
+                }
+                espera_ms = CONEXAO_ESPERA_MIN_MS;
+                mudar(CONEXAO_CONECTADA);
+            } else if (status < 0 || agora - inicio_associacao_ms > CONEXAO_PRAZO_ASSOCIACAO_MS) {
+                stats.falhas++;
+                falhar(status, agora);
+            }
+            break;
+        }
+
+        case CONEXAO_CONECTADA: {
+            int status = cyw43_tcpip_link_status(&cyw43_state, CYW43_ITF_STA);
+            if (status != CYW43_LINK_UP) {
+                stats.quedas++;
+                falhar(status, agora);
+            }
+            break;
+        }
+
+        case CONEXAO_ESPERA:
+            if ((int32_t)(agora - proxima_tentativa_ms) >= 0) {
+                associar(agora);
+            }
+            break;
+    }
+}
+
+conexao_estado_t conexao_estado(void) {
+    return estado;
+}
+
+bool conexao_inicializacao_pendente(void) {
+    return estado == CONEXAO_DESLIGADA ||
+           (estado == CONEXAO_SEM_RADIO && (int32_t)(agora_ms() - proxima_tentativa_ms) >= 0);
+}
+
+bool conexao_radio_pronto(void) {
+    return radio_pronto;
+}
+
+const conexao_stats_t *conexao_stats(void) {
+    return &stats;
+}
+
+size_t conexao_relatorio(char *buf, size_t cap) {
+    uint32_t agora = agora_ms();
+    bool aguardando = estado == CONEXAO_ESPERA || estado == CONEXAO_SEM_RADIO;
+    int len = snprintf(buf, cap,
+                       "{\"estado\":\"%s\",\"proxima_tentativa_ms\":%ld,\"tentativas\":%lu,\"falhas\":%lu,"
+                       "\"quedas\":%lu,\"ultimo_status\":%ld,\"conexao_ms\":%lu,\"primeira_ms\":%lu}",
+                       nomes_estados[estado],
+                       aguardando ? (long)(int32_t)(proxima_tentativa_ms - agora) : -1L,
+                       (unsigned long)stats.tentativas, (unsigned long)stats.falhas, (unsigned long)stats.quedas,
+                       (long)stats.ultimo_status, (unsigned long)stats.conexao_ms, (unsigned long)stats.primeira_ms);
+    if (len < 0) {
+        return 0;
+    }
+    return (size_t)len < cap ? (size_t)len : cap - 1;
+}
@@ -0,0 +1,57 @@
+#ifndef CONEXAO_H
+#define CONEXAO_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+// Supervisor da conexão Wi-Fi, executado pela tarefa de rede: inicializa o rádio, associa em segundo
+// plano (cyw43_arch_wifi_connect_async) e acompanha o enlace. Se a associação falha, passa do prazo ou
+// o enlace cai, tenta de novo com espera dobrando de CONEXAO_ESPERA_MIN_MS até CONEXAO_ESPERA_MAX_MS.
+// O único trecho bloqueante é o cyw43_arch_init (carga do firmware do rádio), na primeira chamada e nas novas
+// tentativas depois de CONEXAO_SEM_RADIO.
+
+#define CONEXAO_PRAZO_ASSOCIACAO_MS 20000 // Associação + DHCP
+#define CONEXAO_ESPERA_MIN_MS 1000
+#define CONEXAO_ESPERA_MAX_MS 60000
+
+typedef enum {
+    CONEXAO_DESLIGADA,  // Rádio ainda não inicializado
+    CONEXAO_ASSOCIANDO, // Associação e DHCP em andamento
+    CONEXAO_CONECTADA,
+    CONEXAO_ESPERA,     // Falhou: aguardando a próxima tentativa
+    CONEXAO_SEM_RADIO,  // cyw43_arch_init falhou (também tenta de novo após a espera)
+} conexao_estado_t;
+
+// Chamada a cada troca de estado, no contexto de conexao_executar
+typedef void (*conexao_cb_t)(conexao_estado_t estado);
+
+typedef struct {
+    uint32_t tentativas;    // Associações iniciadas
+    uint32_t falhas;        // Associações que falharam ou passaram do prazo
+    uint32_t quedas;        // Enlace perdido depois de conectado
+    int32_t ultimo_status;  // Último CYW43_LINK_* de falha
+    uint32_t conexao_ms;    // Duração da última associação bem-sucedida
+    uint32_t primeira_ms;   // Instante da primeira conexão (ms desde o boot; 0 = ainda não)
+} conexao_stats_t;
+
+void conexao_configurar(const char *ssid, const char *senha, uint32_t autenticacao, uint32_t modo_energia, conexao_cb_t cb);
+
+// Avança a máquina de estados (chamar periodicamente)
+void conexao_executar(void);
+
+conexao_estado_t conexao_estado(void);
+
+// A próxima conexao_executar vai chamar o cyw43_arch_init (bloqueante): primeira chamada ou nova tentativa
+// em CONEXAO_SEM_RADIO com a espera vencida
+bool conexao_inicializacao_pendente(void);
+
+// cyw43_arch_init concluído: lwIP e cyw43_arch_poll podem ser usados
+bool conexao_radio_pronto(void);
+
+const conexao_stats_t *conexao_stats(void);
+
+// JSON com o estado, a espera atual e as estatísticas
+size_t conexao_relatorio(char *buf, size_t cap);
+
+#endif // CONEXAO_H
@@ -0,0 +1,269 @@
+#include <stdio.h>
+#include <string.h>
+#include "pico/stdlib.h"
+#include "pico/flash.h"
+#include "hardware/flash.h"
+#include "hardware/sync.h"
+#include "configuracao.h"
+
+#define CONFIG_MAGICO 0x31474643u // "CFG1"
+#define CONFIG_FORMATO 1          // Layout do registro (entradas de 8 bytes)
+#define CONFIG_SETORES 2
+#define CONFIG_PAGINAS (FLASH_SECTOR_SIZE / FLASH_PAGE_SIZE) // Registros por setor
+#define CONFIG_OFFSET (PICO_FLASH_SIZE_BYTES - CONFIG_SETORES * FLASH_SECTOR_SIZE)
+
+#define TIPO_FLOAT 1
+
+typedef struct {
+    uint16_t chave;
+    uint16_t tipo;
+    uint32_t valor; // Bits do float
+} entrada_t;
+
+typedef struct {
+    uint32_t magico;
+    uint32_t crc;       // CRC-32 de formato até a última entrada usada
+    uint16_t formato;
+    uint16_t n;
+    uint32_t sequencia; // Cresce a cada gravação; vale o registro íntegro de maior sequência
+    entrada_t entradas[CONFIG_ENTRADAS_MAX];
+} registro_t;
+
+_Static_assert(sizeof(registro_t) == FLASH_PAGE_SIZE, "registro deve ocupar uma página");
+
+extern uint8_t __flash_binary_end;
+
+static entrada_t tabela[CONFIG_ENTRADAS_MAX];
+static int n_tabela = 0;
+static bool disponivel = false; // Região reservada não sobrepõe o binário
+static int setor_atual = -1;    // Setor e página do último registro (-1 = nenhum)
+static int pagina_atual = -1;
+// config_definir_float também é chamada de IRQ (rotas HTTP e MQTT, no lwIP): tabela, n_tabela e o estado
+// das alterações só mudam com as interrupções desligadas, e versao conta as alterações para a gravação
+// saber se alguma chegou depois da cópia que ela gravou
+static volatile bool pendente = false;
+static volatile uint32_t primeira_alteracao_ms, ultima_alteracao_ms;
+static volatile uint32_t versao = 0;
+static config_stats_t stats;
+
+static const registro_t *pagina(int setor, int p) {
+    return (const registro_t *)(uintptr_t)(XIP_BASE + CONFIG_OFFSET + setor * FLASH_SECTOR_SIZE + p * FLASH_PAGE_SIZE);
+}
+
+static uint32_t crc32(const uint8_t *dados, size_t n) {
+    uint32_t crc = 0xFFFFFFFFu;
+    for (size_t i = 0; i < n; i++) {
+        crc ^= dados[i];
+        for (int b = 0; b < 8; b++) {
+            crc = (crc >> 1) ^ (0xEDB88320u & -(crc & 1));
+        }
+    }
+    return ~crc;
+}
+
+static uint32_t crc_registro(const registro_t *r) {
+    return crc32((const uint8_t *)&r->formato,
+                 offsetof(registro_t, entradas) - offsetof(registro_t, formato) + r->n * sizeof(entrada_t));
+}
+
+static bool integro(const registro_t *r) {
+    return r->magico == CONFIG_MAGICO && r->formato == CONFIG_FORMATO && r->n <= CONFIG_ENTRADAS_MAX &&
+           r->crc == crc_registro(r);
+}
+
+static bool apagada(const registro_t *r) {
+    const uint32_t *p = (const uint32_t *)r;
+    for (size_t i = 0; i < FLASH_PAGE_SIZE / 4; i++) {
+        if (p[i] != 0xFFFFFFFFu) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void config_carregar(void) {
+    uint32_t t0 = time_us_32();
+    disponivel = (uintptr_t)&__flash_binary_end <= XIP_BASE + CONFIG_OFFSET;
+    if (!disponivel) {
+        printf("Configuracao: binario ocupa a regiao reservada, sem persistencia\n");
+        return;
+    }
+
+    // Registro íntegro de maior sequência nos dois setores (páginas com CRC errado são ignoradas)
+    const registro_t *melhor = NULL;
+    for (int s = 0; s < CONFIG_SETORES; s++) {
+        for (int p = 0; p < CONFIG_PAGINAS; p++) {
+            const registro_t *r = pagina(s, p);
+            if (r->magico == 0xFFFFFFFFu) {
+                break; // Primeira página apagada: o setor é gravado em ordem
+            }
+            if (integro(r) && (!melhor || (int32_t)(r->sequencia - melhor->sequencia) > 0)) {
+                melhor = r;
+                setor_atual = s;
+                pagina_atual = p;
+            }
+        }
+    }
+    if (melhor) {
+        n_tabela = melhor->n;
+        memcpy(tabela, melhor->entradas, n_tabela * sizeof(entrada_t));
+        stats.sequencia = melhor->sequencia;
+    }
+    stats.carga_us = time_us_32() - t0;
+}
+
+static entrada_t *procurar(config_chave_t chave) {
+    for (int i = 0; i < n_tabela; i++) {
+        if (tabela[i].chave == chave) {
+            return &tabela[i];
+        }
+    }
+    return NULL;
+}
+
+bool config_obter_float(config_chave_t chave, float *valor) {
+    const entrada_t *e = procurar(chave);
+    if (!e || e->tipo != TIPO_FLOAT) {
+        return false;
+    }
+    memcpy(valor, &e->valor, sizeof(*valor));
+    return true;
+}
+
+void config_definir_float(config_chave_t chave, float valor) {
+    uint32_t bits;
+    memcpy(&bits, &valor, sizeof(bits));
+    uint32_t agora = to_ms_since_boot(get_absolute_time());
+    uint32_t estado = save_and_disable_interrupts();
+    entrada_t *e = procurar(chave);
+    if (e && e->tipo == TIPO_FLOAT && e->valor == bits) {
+        restore_interrupts(estado);
+        return;
+    }
+    if (!e) {
+        if (n_tabela >= CONFIG_ENTRADAS_MAX) {
+            restore_interrupts(estado);
+            return;
+        }
+        e = &tabela[n_tabela];
+        e->chave = chave;
+        n_tabela++;
+    }
+    e->tipo = TIPO_FLOAT;
+    e->valor = bits;
+
+    if (!pendente) {
+        primeira_alteracao_ms = agora;
+        pendente = true;
+    }
+    ultima_alteracao_ms = agora;
+    versao++;
+    stats.alteracoes++;
+    restore_interrupts(estado);
+}
+
+// Operação na flash executada por flash_safe_execute (IRQs desligadas e o outro núcleo parado)
+typedef struct {
+    uint32_t offset;
+    const registro_t *registro; // NULL = apagar o setor
+} operacao_flash_t;
+
+static void executar_na_flash(void *param) {
+    const operacao_flash_t *op = param;
+    if (op->registro) {
+        flash_range_program(op->offset, (const uint8_t *)op->registro, FLASH_PAGE_SIZE);
+    } else {
+        flash_range_erase(op->offset, FLASH_SECTOR_SIZE);
+    }
+}
+
+bool config_gravar(void) {
+    if (!pendente) {
+        return true;
+    }
+    if (!disponivel) {
+        pendente = false; // Sem região reservada: as alterações ficam só na RAM
+        return false;
+    }
+
+    static registro_t novo; // Fora da pilha: uma página inteira
+    memset(&novo, 0xFF, sizeof(novo));
+    novo.magico = CONFIG_MAGICO;
+    novo.formato = CONFIG_FORMATO;
+    novo.sequencia = stats.sequencia + 1;
+    uint32_t estado = save_and_disable_interrupts(); // Cópia consistente da tabela e da versão que ela contém
+    novo.n = n_tabela;
+    memcpy(novo.entradas, tabela, n_tabela * sizeof(entrada_t));
+    uint32_t versao_gravada = versao;
+    restore_interrupts(estado);
+    novo.crc = crc_registro(&novo);
+
+    // Próxima página apagada do setor atual; com o setor cheio (ou nenhum registro), apaga o outro
+    int setor = setor_atual < 0 ? 0 : setor_atual;
+    int p = pagina_atual + 1;
+    if (setor_atual < 0 || p >= CONFIG_PAGINAS || !apagada(pagina(setor, p))) {
+        setor = setor_atual < 0 ? 0 : 1 - setor_atual;
+        p = 0;
+        operacao_flash_t apagar = {CONFIG_OFFSET + setor * FLASH_SECTOR_SIZE, NULL};
+        if (flash_safe_execute(executar_na_flash, &apagar, 100) != PICO_OK) {
+            stats.falhas++;
+            return false; // Continua pendente: nova tentativa no próximo config_executar
+        }
+        stats.apagamentos++;
+    }
+
+    operacao_flash_t programar = {CONFIG_OFFSET + setor * FLASH_SECTOR_SIZE + p * FLASH_PAGE_SIZE, &novo};
+    if (flash_safe_execute(executar_na_flash, &programar, 100) != PICO_OK ||
+        memcmp(pagina(setor, p), &novo, sizeof(novo)) != 0) {
+        stats.falhas++;
+        return false;
+    }
+    setor_atual = setor;
+    pagina_atual = p;
+    stats.sequencia = novo.sequencia;
+    stats.gravacoes++;
+
+    // Uma alteração chegou durante a gravação: continua pendente, com o atraso contado a partir dela
+    estado = save_and_disable_interrupts();
+    if (versao == versao_gravada) {
+        pendente = false;
+    } else {
+        primeira_alteracao_ms = ultima_alteracao_ms;
+    }
+    restore_interrupts(estado);
+    return true;
+}
+
+void config_executar(void) {
+    if (!pendente) {
+        return;
+    }
+    uint32_t agora = to_ms_since_boot(get_absolute_time());
+    if (agora - ultima_alteracao_ms >= CONFIG_ATRASO_MS || agora - primeira_alteracao_ms >= CONFIG_ATRASO_MAX_MS) {
+        config_gravar();
+    }
+}
+
+const config_stats_t *config_stats(void) {
+    return &stats;
+}
+
+size_t config_relatorio(char *buf, size_t cap) {
+    size_t len = snprintf(buf, cap,
+                          "{\"disponivel\":%s,\"sequencia\":%lu,\"setor\":%d,\"pagina\":%d,\"pendente\":%s,"
+                          "\"gravacoes\":%lu,\"apagamentos\":%lu,\"alteracoes\":%lu,\"falhas\":%lu,\"carga_us\":%lu,"
+                          "\"entradas\":{",
+                          disponivel ? "true" : "false", (unsigned long)stats.sequencia, setor_atual, pagina_atual,
+                          pendente ? "true" : "false", (unsigned long)stats.gravacoes,
+                          (unsigned long)stats.apagamentos, (unsigned long)stats.alteracoes,
+                          (unsigned long)stats.falhas, (unsigned long)stats.carga_us);
+    for (int i = 0; i < n_tabela && len < cap; i++) {
+        float v;
+        memcpy(&v, &tabela[i].valor, sizeof(v));
+        len += snprintf(buf + len, cap - len, "%s\"%u\":%g", i ? "," : "", tabela[i].chave, v);
+    }
+    if (len < cap) {
+        len += snprintf(buf + len, cap - len, "}}");
+    }
+    return len < cap ? len : cap - 1;
+}
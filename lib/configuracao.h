@@ -0,0 +1,64 @@
+#ifndef CONFIGURACAO_H
+#define CONFIGURACAO_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+// Configuração persistente em chave/valor nos dois últimos setores da flash.
+// Cada gravação é um registro de uma página (cabeçalho, entradas e CRC-32) escrito na próxima página
+// apagada do setor atual; com o setor cheio, o outro é apagado e recebe o registro. O registro anterior
+// só deixa de valer depois que o novo está completo, então um corte de energia no meio da gravação
+// mantém a configuração anterior. Na carga vale o registro íntegro de maior sequência (leitura pelo
+// XIP, sem acesso ao barramento da flash além do cache).
+// As alterações são agrupadas: a gravação acontece CONFIG_ATRASO_MS depois da última alteração
+// (no máximo CONFIG_ATRASO_MAX_MS depois da primeira pendente), em config_executar.
+
+#define CONFIG_ENTRADAS_MAX 30   // Entradas por registro (uma página de 256 bytes)
+#define CONFIG_ATRASO_MS 5000
+#define CONFIG_ATRASO_MAX_MS 30000
+
+// Chaves gravadas. Os valores são fixos: nunca renumerar nem reutilizar uma chave removida.
+// Chaves desconhecidas (de outra versão do firmware) são mantidas e regravadas sem alteração.
+typedef enum {
+    CONFIG_TEMPERATURA_MIN = 1,
+    CONFIG_TEMPERATURA_MAX = 2,
+    CONFIG_UMIDADE_MIN = 3,
+    CONFIG_UMIDADE_MAX = 4,
+    CONFIG_TEMPERATURA_OFFSET = 5,
+    CONFIG_PRESSAO_OFFSET = 6,
+    CONFIG_ALTITUDE_OFFSET = 7,
+    CONFIG_UMIDADE_OFFSET = 8,
+} config_chave_t;
+
+typedef struct {
+    uint32_t sequencia;   // Sequência do registro carregado ou gravado por último (0 = nenhum)
+    uint32_t gravacoes;   // Registros gravados desde o boot
+    uint32_t apagamentos; // Setores apagados desde o boot
+    uint32_t alteracoes;  // Chamadas a config_definir_* que mudaram um valor
+    uint32_t falhas;      // Gravações que não conferiram na releitura
+    uint32_t carga_us;    // Duração de config_carregar
+} config_stats_t;
+
+// Lê o registro mais recente (chamar uma vez no boot, antes de config_obter_*)
+void config_carregar(void);
+
+// Valor gravado da chave; false (e *valor intocado) se a chave não existe
+bool config_obter_float(config_chave_t chave, float *valor);
+
+// Altera o valor na memória e agenda a gravação (nada acontece se o valor não mudou). Pode ser chamada de
+// IRQ: uma alteração feita durante config_gravar fica pendente para a próxima gravação
+void config_definir_float(config_chave_t chave, float valor);
+
+// Grava as alterações pendentes cujo atraso terminou (chamar periodicamente, fora de IRQ)
+void config_executar(void);
+
+// Grava já as alterações pendentes
+bool config_gravar(void);
+
+const config_stats_t *config_stats(void);
+
+// JSON com as entradas, a sequência e as estatísticas
+size_t config_relatorio(char *buf, size_t cap);
+
+#endif // CONFIGURACAO_H
@@ -0,0 +1,141 @@
+#include "conversao.h"
+
+// --- BMP280
+
+void bmp280_parse_calib(const uint8_t buf[BMP280_CALIB_LEN], struct bmp280_calib_param *params) {
+    params->dig_t1 = (uint16_t)(buf[1] << 8) | buf[0];
+    params->dig_t2 = (int16_t)(buf[3] << 8) | buf[2];
+    params->dig_t3 = (int16_t)(buf[5] << 8) | buf[4];
+
+    params->dig_p1 = (uint16_t)(buf[7] << 8) | buf[6];
+    params->dig_p2 = (int16_t)(buf[9] << 8) | buf[8];
+    params->dig_p3 = (int16_t)(buf[11] << 8) | buf[10];
+    params->dig_p4 = (int16_t)(buf[13] << 8) | buf[12];
+    params->dig_p5 = (int16_t)(buf[15] << 8) | buf[14];
+    params->dig_p6 = (int16_t)(buf[17] << 8) | buf[16];
+    params->dig_p7 = (int16_t)(buf[19] << 8) | buf[18];
+    params->dig_p8 = (int16_t)(buf[21] << 8) | buf[20];
+    params->dig_p9 = (int16_t)(buf[23] << 8) | buf[22];
+}
+
+// Dados de uma rajada a partir de REG_STATUS; falha se a conversão forçada ainda não terminou
+// (no modo normal os registradores de dados são protegidos durante a rajada e a leitura é sempre consistente)
+bool bmp280_decode_burst(const uint8_t buf[BMP280_BURST_LEN], int32_t* temp, int32_t* pressure) {
+    uint8_t status = buf[0];
+    uint8_t mode = buf[1] & 0x03;
+    if ((status & BMP280_STATUS_IM_UPDATE) || (mode != BMP280_MODO_NORMAL && (status & BMP280_STATUS_MEASURING))) {
+        return false;
+    }
+    bmp280_decode_raw(&buf[4], temp, pressure);
+    return true;
+}
+
+// Separa os valores de 20 bits lidos a partir de REG_PRESSURE_MSB (pressão e temperatura)
+void bmp280_decode_raw(const uint8_t buf[6], int32_t* temp, int32_t* pressure) {
+    *pressure = (buf[0] << 12) | (buf[1] << 4) | (buf[2] >> 4);
+    *temp = (buf[3] << 12) | (buf[4] << 4) | (buf[5] >> 4);
+}
+
+// função intermediária que calcula a temperatura de resolução fina
+// usada tanto para conversões de pressão quanto de temperatura
+int32_t bmp280_convert(int32_t temp, struct bmp280_calib_param* params) {
+    // usa os 32 bits de compensação de ponto fixo implementados no datasheet
+    int32_t var1, var2;
+    var1 = ((((temp >> 3) - ((int32_t)params->dig_t1 << 1))) * ((int32_t)params->dig_t2)) >> 11;
+    var2 = (((((temp >> 4) - ((int32_t)params->dig_t1)) * ((temp >> 4) - ((int32_t)params->dig_t1))) >> 12) * ((int32_t)params->dig_t3)) >> 14;
+    return var1 + var2;
+}
+
+int32_t bmp280_convert_temp(int32_t temp, struct bmp280_calib_param* params) {
+    // Utiliza os parâmetros de calibração do BMP280 para compensar o valor de temperatura lido de seus registradores
+    int32_t t_fine = bmp280_convert(temp, params);
+    return (t_fine * 5 + 128) >> 8;
+}
+
+
+int32_t bmp280_convert_pressure(int32_t pressure, int32_t temp, struct bmp280_calib_param* params) {
+    // Utiliza os parâmetros de calibração do BMP280 para compensar o valor de pressão lido de seus registradores
+
+    int32_t t_fine = bmp280_convert(temp, params);
+
+    int32_t var1, var2;
+    uint32_t converted = 0.0;
+    var1 = (((int32_t)t_fine) >> 1) - (int32_t)64000;
+    var2 = (((var1 >> 2) * (var1 >> 2)) >> 11) * ((int32_t)params->dig_p6);
+    var2 += ((var1 * ((int32_t)params->dig_p5)) << 1);
+    var2 = (var2 >> 2) + (((int32_t)params->dig_p4) << 16);
+    var1 = (((params->dig_p3 * (((var1 >> 2) * (var1 >> 2)) >> 13)) >> 3) + ((((int32_t)params->dig_p2) * var1) >> 1)) >> 18;
+    var1 = ((((32768 + var1)) * ((int32_t)params->dig_p1)) >> 15);
+    if (var1 == 0) {
+        return 0;  // avoid exception caused by division by zero
+    }
+    converted = (((uint32_t)(((int32_t)1048576) - pressure) - (var2 >> 12))) * 3125;
+    if (converted < 0x80000000) {
+        converted = (converted << 1) / ((uint32_t)var1);
+    } else {
+        converted = (converted / (uint32_t)var1) * 2;
+    }
+    var1 = (((int32_t)params->dig_p9) * ((int32_t)(((converted >> 3) * (converted >> 3)) >> 13))) >> 12;
+    var2 = (((int32_t)(converted >> 2)) * ((int32_t)params->dig_p8)) >> 13;
+    converted = (uint32_t)((int32_t)converted + ((var1 + var2 + params->dig_p7) >> 4));
+    return converted;
+}
+
+// Tempo máximo de uma conversão (datasheet, tabela 13): 1,25 + 2,3 * T + (2,3 * P + 0,575) ms
+uint32_t bmp280_measurement_time_us(const bmp280_config_t *cfg) {
+    uint32_t t = cfg->osrs_t ? 1u << (cfg->osrs_t - 1) : 0;
+    uint32_t p = cfg->osrs_p ? 1u << (cfg->osrs_p - 1) : 0;
+    return 1250 + 2300 * t + (p ? 2300 * p + 575 : 0);
+}
+
+// Intervalo entre conversões no modo normal (t_measure + t_standby)
+uint32_t bmp280_period_us(const bmp280_config_t *cfg) {
+    static const uint32_t standby_us[8] = {500, 62500, 125000, 250000, 500000, 1000000, 2000000, 4000000};
+    return bmp280_measurement_time_us(cfg) + standby_us[cfg->standby & 7];
+}
+
+uint32_t bmp280_conversoes_novas(bmp280_repeticao_t *r, const bmp280_config_t *cfg, bool disparada,
+                                 int32_t temp_bruta, int32_t pressao_bruta, uint32_t agora_us) {
+    // Valores iguais não bastam para dizer que a conversão é a mesma: com o ar estável duas conversões
+    // seguidas podem dar os mesmos valores brutos
+    uint32_t novas;
+    if (cfg->modo == BMP280_MODO_FORCADO) {
+        // Uma conversão por disparo aceito neste ciclo; sem ele os registradores têm a conversão anterior
+        novas = disparada ? 1 : 0;
+    } else if (r->anterior) {
+        // Modo normal: conversões a cada bmp280_period_us; dentro de um período, só valores diferentes indicam
+        // uma conversão nova
+        novas = (agora_us - r->leitura_us) / bmp280_period_us(cfg);
+        if (novas == 0 && (temp_bruta != r->temp_bruta || pressao_bruta != r->pressao_bruta)) {
+            novas = 1;
+        }
+    } else {
+        novas = 1;
+    }
+    if (novas) { // Uma repetida mantém o instante da conversão original
+        r->anterior = true;
+        r->leitura_us = agora_us;
+        r->temp_bruta = temp_bruta;
+        r->pressao_bruta = pressao_bruta;
+    }
+    return novas;
+}
+
+// --- AHT20
+
+bool aht20_parse(const uint8_t buffer[AHT20_QUADRO_LEN], AHT20_Data *data) {
+    // Medição ainda em andamento
+    if (buffer[0] & AHT20_STATUS_BUSY) {
+        return false;
+    }
+
+    // Processa os dados de umidade (20 bits)
+    uint32_t raw_humidity = ((uint32_t)buffer[1] << 12) | ((uint32_t)buffer[2] << 4) | (buffer[3] >> 4);
+    data->humidity = (float)raw_humidity * 100.0 / 1048576.0;
+
+    // Processa os dados de temperatura (20 bits)
+    uint32_t raw_temp = ((uint32_t)(buffer[3] & 0x0F) << 16) | ((uint32_t)buffer[4] << 8) | buffer[5];
+    data->temperature = ((float)raw_temp * 200.0 / 1048576.0) - 50.0;
+
+    return true;
+}
@@ -0,0 +1,104 @@
+#ifndef CONVERSAO_H
+#define CONVERSAO_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Conversão dos bytes brutos do BMP280 e do AHT20 em grandezas físicas.
+// Só aritmética sobre os bytes já lidos: não depende do SDK (também compila no host, ver tools/replay.c).
+
+// Bits do registrador de status do BMP280
+#define BMP280_STATUS_MEASURING 0x08 // Conversão em andamento
+#define BMP280_STATUS_IM_UPDATE 0x01 // Cópia da NVM em andamento
+
+// Coeficientes de calibração do BMP280 (REG_DIG_T1_LSB a REG_DIG_P9_MSB)
+#define BMP280_CALIB_LEN 24
+
+// Leitura em rajada de REG_STATUS até REG_TEMP_XLSB (status, ctrl_meas, config, reservado e os dados)
+#define BMP280_BURST_LEN 10
+
+// Modo de operação do BMP280 (bits 1:0 de ctrl_meas)
+#define BMP280_MODO_SLEEP 0
+#define BMP280_MODO_FORCADO 1 // Uma conversão por disparo, depois volta ao sleep
+#define BMP280_MODO_NORMAL 3  // Conversões contínuas separadas por t_standby
+
+// Sobreamostragem (osrs_t / osrs_p)
+#define BMP280_OS_DESLIGADO 0
+#define BMP280_OS_X1 1
+#define BMP280_OS_X2 2
+#define BMP280_OS_X4 3
+#define BMP280_OS_X8 4
+#define BMP280_OS_X16 5
+
+// Coeficiente do filtro IIR
+#define BMP280_FILTRO_DESLIGADO 0
+#define BMP280_FILTRO_2 1
+#define BMP280_FILTRO_4 2
+#define BMP280_FILTRO_8 3
+#define BMP280_FILTRO_16 4
+
+typedef struct {
+    uint8_t osrs_t;  // BMP280_OS_*
+    uint8_t osrs_p;  // BMP280_OS_*
+    uint8_t filtro;  // BMP280_FILTRO_*
+    uint8_t standby; // t_sb: 0 = 0,5 ms, 1 = 62,5 ms, 2..7 = 125 ms .. 4000 ms
+    uint8_t modo;    // BMP280_MODO_*
+} bmp280_config_t;
+
+// Configuração original: temperatura x1, pressão x4, IIR 16, 500 ms, modo normal
+#define BMP280_CONFIG_PADRAO { BMP280_OS_X1, BMP280_OS_X4, BMP280_FILTRO_16, 4, BMP280_MODO_NORMAL }
+
+// Tempo máximo de uma conversão e intervalo entre conversões no modo normal (t_measure + t_standby)
+uint32_t bmp280_measurement_time_us(const bmp280_config_t *cfg);
+uint32_t bmp280_period_us(const bmp280_config_t *cfg);
+
+// Detecção de conversões repetidas do BMP280 (a mesma conversão lida de novo num ciclo mais curto que o
+// período do sensor). Zere anterior ao reconfigurar o sensor.
+typedef struct {
+    bool anterior;                     // temp_bruta/pressao_bruta valem para a configuração atual
+    int32_t temp_bruta, pressao_bruta; // Última conversão nova lida
+    uint32_t leitura_us;               // Fim da leitura dessa conversão
+} bmp280_repeticao_t;
+
+// Conversões que o sensor fez desde a leitura anterior (0 = mesma conversão). No modo forçado é o disparo
+// aceito no ciclo (disparada); no normal, o tempo decorrido em períodos. Atualiza r quando há conversão nova.
+uint32_t bmp280_conversoes_novas(bmp280_repeticao_t *r, const bmp280_config_t *cfg, bool disparada,
+                                 int32_t temp_bruta, int32_t pressao_bruta, uint32_t agora_us);
+
+// Quadro lido do AHT20 após a medição (status, umidade e temperatura de 20 bits)
+#define AHT20_QUADRO_LEN 6
+#define AHT20_STATUS_BUSY 0x80 // Bit de status ocupado
+
+struct bmp280_calib_param {
+    uint16_t dig_t1;
+    int16_t dig_t2;
+    int16_t dig_t3;
+
+    uint16_t dig_p1;
+    int16_t dig_p2;
+    int16_t dig_p3;
+    int16_t dig_p4;
+    int16_t dig_p5;
+    int16_t dig_p6;
+    int16_t dig_p7;
+    int16_t dig_p8;
+    int16_t dig_p9;
+};
+
+// Estrutura para armazenar os valores de temperatura e umidade
+typedef struct {
+    float temperature;
+    float humidity;
+} AHT20_Data;
+
+// Interpreta os 24 bytes de calibração (little-endian); dig_t1 = 0 indica que o sensor não respondeu
+void bmp280_parse_calib(const uint8_t buf[BMP280_CALIB_LEN], struct bmp280_calib_param *params);
+bool bmp280_decode_burst(const uint8_t buf[BMP280_BURST_LEN], int32_t* temp, int32_t* pressure);
+void bmp280_decode_raw(const uint8_t buf[6], int32_t* temp, int32_t* pressure);
+int32_t bmp280_convert_temp(int32_t temp, struct bmp280_calib_param* params);
+int32_t bmp280_convert_pressure(int32_t pressure, int32_t temp, struct bmp280_calib_param* params);
+
+// Converte os 6 bytes lidos após o comando de medição (falha se o sensor ainda estiver ocupado)
+bool aht20_parse(const uint8_t buffer[AHT20_QUADRO_LEN], AHT20_Data *data);
+
+#endif // CONVERSAO_H
@@ -0,0 +1,168 @@
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include "derivadas.h"
+
+typedef float (*derivada_fn_t)(const float *e);
+
+typedef struct {
+    const char *nome;
+    uint32_t entradas; // DERIVADAS_BIT(...) das entradas usadas
+    derivada_fn_t calcular;
+} derivada_def_t;
+
+static float entradas[DERIVADAS_ENTRADAS] = { NAN, NAN, NAN, 0 };
+static uint32_t versoes[DERIVADAS_ENTRADAS]; // Incrementadas quando a entrada muda
+
+static float altitude_estacao = 0.0f;
+static float pressao_referencia = 101325.0f; // Pa (atmosfera padrão)
+
+// Memória de cada métrica: vale enquanto a soma das versões das entradas não mudar
+// (as versões só crescem, então a soma muda se e somente se alguma entrada mudou)
+static struct {
+    bool valido;
+    uint32_t chave;
+    float valor;
+} memo[DERIVADAS_N];
+static derivadas_stats_t stats[DERIVADAS_N];
+
+// Ponto de orvalho pela fórmula de Magnus (coeficientes de Sonntag, -45 a 60 °C)
+static float ponto_orvalho(const float *e) {
+    float t = e[DERIVADAS_TEMPERATURA], u = e[DERIVADAS_UMIDADE];
+    if (u <= 0) {
+        return NAN;
+    }
+    float g = logf(u / 100.0f) + 17.62f * t / (243.12f + t);
+    return 243.12f * g / (17.62f - g);
+}
+
+// Índice de calor da NOAA: fórmula simples abaixo de 80 °F e regressão de Rothfusz com os ajustes acima
+static float indice_calor(const float *e) {
+    float f = e[DERIVADAS_TEMPERATURA] * 1.8f + 32.0f, u = e[DERIVADAS_UMIDADE];
+    float hi = 0.5f * (f + 61.0f + (f - 68.0f) * 1.2f + u * 0.094f);
+    if ((hi + f) / 2.0f >= 80.0f) {
+        hi = -42.379f + 2.04901523f * f + 10.14333127f * u - 0.22475541f * f * u - 6.83783e-3f * f * f
+             - 5.481717e-2f * u * u + 1.22874e-3f * f * f * u + 8.5282e-4f * f * u * u - 1.99e-6f * f * f * u * u;
+        if (u < 13.0f && f >= 80.0f && f <= 112.0f) {
+            hi -= (13.0f - u) / 4.0f * sqrtf((17.0f - fabsf(f - 95.0f)) / 17.0f);
+        } else if (u > 85.0f && f >= 80.0f && f <= 87.0f) {
+            hi += (u - 85.0f) / 10.0f * (87.0f - f) / 5.0f;
+        }
+    }
+    return (hi - 32.0f) / 1.8f;
+}
+
+// Umidade absoluta (g/m³) a partir da pressão de saturação de Magnus
+static float umidade_absoluta(const float *e) {
+    float t = e[DERIVADAS_TEMPERATURA], u = e[DERIVADAS_UMIDADE];
+    return 6.112f * expf(17.67f * t / (t + 243.5f)) * u * 2.1674f / (273.15f + t);
+}
+
+// Redução ao nível do mar com gradiente padrão de 6,5 K/km
+static float pressao_mar(const float *e) {
+    float h = altitude_estacao, t = e[DERIVADAS_TEMPERATURA];
+    return e[DERIVADAS_PRESSAO] * 10.0f * powf(1.0f - 0.0065f * h / (t + 0.0065f * h + 273.15f), -5.257f);
+}
+
+static float altitude(const float *e) {
+    return derivadas_altitude(e[DERIVADAS_PRESSAO] * 1000.0f);
+}
+
+static const derivada_def_t definicoes[DERIVADAS_N] = {
+    [DERIVADA_PONTO_ORVALHO] = { "ponto_orvalho", DERIVADAS_BIT(DERIVADAS_TEMPERATURA) | DERIVADAS_BIT(DERIVADAS_UMIDADE), ponto_orvalho },
+    [DERIVADA_INDICE_CALOR] = { "indice_calor", DERIVADAS_BIT(DERIVADAS_TEMPERATURA) | DERIVADAS_BIT(DERIVADAS_UMIDADE), indice_calor },
+    [DERIVADA_UMIDADE_ABSOLUTA] = { "umidade_absoluta", DERIVADAS_BIT(DERIVADAS_TEMPERATURA) | DERIVADAS_BIT(DERIVADAS_UMIDADE), umidade_absoluta },
+    [DERIVADA_PRESSAO_MAR] = { "pressao_mar", DERIVADAS_BIT(DERIVADAS_TEMPERATURA) | DERIVADAS_BIT(DERIVADAS_PRESSAO) | DERIVADAS_BIT(DERIVADAS_CONFIG), pressao_mar },
+    [DERIVADA_ALTITUDE] = { "altitude", DERIVADAS_BIT(DERIVADAS_PRESSAO) | DERIVADAS_BIT(DERIVADAS_CONFIG), altitude },
+};
+
+// Todas as entradas medidas de que a métrica depende já existem
+static bool completo(const derivada_def_t *def, const float *e) {
+    for (int i = 0; i < DERIVADAS_CONFIG; i++) {
+        if ((def->entradas & DERIVADAS_BIT(i)) && isnan(e[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void derivadas_configurar(float altitude_estacao_m, float pressao_referencia_pa) {
+    altitude_estacao = altitude_estacao_m;
+    pressao_referencia = pressao_referencia_pa;
+    versoes[DERIVADAS_CONFIG]++;
+}
+
+float derivadas_altitude_estacao(void) {
+    return altitude_estacao;
+}
+
+void derivadas_entrada(derivadas_entrada_t e, float valor) {
+    // Comparação bit a bit: NAN -> NAN não conta como mudança
+    if (e < DERIVADAS_CONFIG && memcmp(&entradas[e], &valor, sizeof(valor)) != 0) {
+        entradas[e] = valor;
+        versoes[e]++;
+    }
+}
+
+float derivadas_obter(derivada_t d) {
+    if (d >= DERIVADAS_N) {
+        return NAN;
+    }
+    const derivada_def_t *def = &definicoes[d];
+    stats[d].consultas++;
+
+    uint32_t chave = 0;
+    for (int e = 0; e < DERIVADAS_ENTRADAS; e++) {
+        if (def->entradas & DERIVADAS_BIT(e)) {
+            chave += versoes[e];
+        }
+    }
+    if (memo[d].valido && memo[d].chave == chave) {
+        return memo[d].valor;
+    }
+
+    float valor = NAN;
+    if (completo(def, entradas)) {
+        valor = def->calcular(entradas);
+        stats[d].calculos++;
+    }
+    memo[d].valido = true;
+    memo[d].chave = chave;
+    memo[d].valor = valor;
+    return valor;
+}
+
+float derivadas_calcular(derivada_t d, const float e[DERIVADAS_ENTRADAS]) {
+    if (d >= DERIVADAS_N || !completo(&definicoes[d], e)) {
+        return NAN;
+    }
+    return definicoes[d].calcular(e);
+}
+
+float derivadas_altitude(float pressao_pa) {
+    return 44330.0f * (1.0f - powf(pressao_pa / pressao_referencia, 0.1903f));
+}
+
+const char *derivadas_nome(derivada_t d) {
+    return d < DERIVADAS_N ? definicoes[d].nome : "";
+}
+
+const derivadas_stats_t *derivadas_stats(derivada_t d) {
+    return d < DERIVADAS_N ? &stats[d] : NULL;
+}
+
+size_t derivadas_relatorio(char *buf, size_t cap, const float valores[DERIVADAS_N]) {
+    size_t len = snprintf(buf, cap, "{");
+    for (int d = 0; d < DERIVADAS_N && len < cap; d++) {
+        float v = valores[d];
+        if (isnan(v)) {
+            len += snprintf(buf + len, cap - len, "%s\"%s\":null", d ? "," : "", definicoes[d].nome);
+        } else {
+            len += snprintf(buf + len, cap - len, "%s\"%s\":%.2f", d ? "," : "", definicoes[d].nome, v);
+        }
+    }
+    if (len < cap) {
+        len += snprintf(buf + len, cap - len, "}");
+    }
+    return len < cap ? len : cap - 1;
+}
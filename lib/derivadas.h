@@ -0,0 +1,63 @@
+#ifndef DERIVADAS_H
+#define DERIVADAS_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+// Grandezas derivadas das leituras (ponto de orvalho, índice de calor, umidade absoluta, pressão ao
+// nível do mar e altitude). Cada métrica declara as entradas de que depende e só é calculada quando
+// alguém a pede; o resultado fica guardado até uma dessas entradas mudar.
+// A memória é da coleta (derivadas_entrada/derivadas_obter). Quem lê a amostra publicada calcula com
+// derivadas_calcular sobre os valores dela, com o próprio cache (amostra_derivada em lib/amostra).
+
+// Entradas (valores finais, já filtrados e com offset)
+typedef enum {
+    DERIVADAS_TEMPERATURA, // °C
+    DERIVADAS_UMIDADE,     // %
+    DERIVADAS_PRESSAO,     // kPa
+    DERIVADAS_CONFIG,      // Altitude da estação e pressão de referência (versão muda ao configurar)
+    DERIVADAS_ENTRADAS
+} derivadas_entrada_t;
+
+#define DERIVADAS_BIT(e) (1u << (e))
+
+typedef enum {
+    DERIVADA_PONTO_ORVALHO,    // °C (Magnus)
+    DERIVADA_INDICE_CALOR,     // °C (regressão de Rothfusz/NOAA)
+    DERIVADA_UMIDADE_ABSOLUTA, // g/m³
+    DERIVADA_PRESSAO_MAR,      // hPa (QNH pela altitude da estação)
+    DERIVADA_ALTITUDE,         // m (atmosfera padrão a partir da pressão de referência)
+    DERIVADAS_N
+} derivada_t;
+
+typedef struct {
+    uint32_t calculos; // Vezes que a métrica foi de fato calculada
+    uint32_t consultas;
+} derivadas_stats_t;
+
+// Altitude conhecida da estação (m) e pressão ao nível do mar usada para estimar a altitude (Pa)
+void derivadas_configurar(float altitude_estacao_m, float pressao_referencia_pa);
+float derivadas_altitude_estacao(void);
+
+// Atualiza uma entrada; as métricas que dependem dela só são recalculadas se o valor mudou
+void derivadas_entrada(derivadas_entrada_t e, float valor);
+
+// Valor da métrica (NAN se alguma entrada ainda não existe ou está fora do domínio). Atualiza a memória e as
+// estatísticas: só o contexto da coleta chama; os outros usam derivadas_calcular
+float derivadas_obter(derivada_t d);
+
+// Valor da métrica para as entradas dadas (índices derivadas_entrada_t; DERIVADAS_CONFIG é ignorada), sem
+// memória nem estatísticas: pode ser chamada de qualquer contexto
+float derivadas_calcular(derivada_t d, const float entradas[DERIVADAS_ENTRADAS]);
+
+// Altitude para uma pressão qualquer (Pa), sem memória (leituras brutas)
+float derivadas_altitude(float pressao_pa);
+
+const char *derivadas_nome(derivada_t d);
+const derivadas_stats_t *derivadas_stats(derivada_t d);
+
+// Gera um objeto JSON {"nome":valor,...} com os valores dados, um por métrica (null para NAN)
+size_t derivadas_relatorio(char *buf, size_t cap, const float valores[DERIVADAS_N]);
+
+#endif // DERIVADAS_H
@@ -0,0 +1,111 @@
+#include <math.h>
+#include "derivadas.h"
+#include "tendencia.h"
+#include "estacao.h"
+
+static const filtro_estagio_t estagios_temperatura[] = {{FILTRO_MEDIANA, 5, 0}, {FILTRO_KALMAN, 1e-4f, 4e-4f}}; // r: ruído ~0,02 °C
+static const filtro_estagio_t estagios_umidade[] = {{FILTRO_MEDIANA, 5, 0}, {FILTRO_KALMAN, 1e-3f, 1e-2f}}; // r: ruído ~0,1 %
+static const filtro_estagio_t estagios_pressao[] = {{FILTRO_MEDIANA, 5, 0}, {FILTRO_EMA, 0.3f, 0}}; // Pa (o BMP280 já tem IIR)
+
+static const alerta_regra_t regras_alerta[ESTACAO_REGRAS] = {
+    [REGRA_TEMP_ALTA]  = { "temperatura_alta", ALERTA_TEMPERATURA, ALERTA_ACIMA, 35.0f, 0.5f, 0,
+                           ALERTA_ACAO_MATRIZ | ALERTA_ACAO_BUZZER | ALERTA_ACAO_REDE, PADRAO_ALERTA, { 1, 200, 0 } },
+    [REGRA_TEMP_BAIXA] = { "temperatura_baixa", ALERTA_TEMPERATURA, ALERTA_ABAIXO, 10.0f, 0.5f, 0,
+                           ALERTA_ACAO_MATRIZ | ALERTA_ACAO_BUZZER | ALERTA_ACAO_REDE, PADRAO_ALERTA, { 1, 200, 0 } },
+    [REGRA_UMI_ALTA]   = { "umidade_alta", ALERTA_UMIDADE, ALERTA_ACIMA, 70.0f, 2.0f, 0,
+                           ALERTA_ACAO_MATRIZ | ALERTA_ACAO_BUZZER | ALERTA_ACAO_REDE, PADRAO_ALERTA, { 1, 200, 0 } },
+    [REGRA_UMI_BAIXA]  = { "umidade_baixa", ALERTA_UMIDADE, ALERTA_ABAIXO, 30.0f, 2.0f, 0,
+                           ALERTA_ACAO_MATRIZ | ALERTA_ACAO_BUZZER | ALERTA_ACAO_REDE, PADRAO_ALERTA, { 1, 200, 0 } },
+    // Calor persistente: > 35 °C por 60 s
+    [REGRA_CALOR]      = { "calor_prolongado", ALERTA_TEMPERATURA, ALERTA_ACIMA, 35.0f, 0.5f, 60000,
+                           ALERTA_ACAO_BUZZER | ALERTA_ACAO_REDE, 0, { 3, 300, 200 } },
+    // Índice de calor na faixa de perigo da NOAA (> 41 °C) por 5 min
+    [REGRA_INDICE_CALOR] = { "indice_calor", ALERTA_INDICE_CALOR, ALERTA_ACIMA, 41.0f, 1.0f, 300000,
+                             ALERTA_ACAO_BUZZER | ALERTA_ACAO_REDE, 0, { 2, 500, 300 } },
+    // Queda rápida de pressão (frente/tempestade): 0,01 kPa/min = 6 hPa/h sustentada por 5 min
+    [REGRA_PRESSAO_QUEDA] = { "queda_pressao", ALERTA_PRESSAO, ALERTA_QUEDA, 0.01f, 0.004f, 300000,
+                              ALERTA_ACAO_MATRIZ | ALERTA_ACAO_REDE, PADRAO_PRESSAO, { 0, 0, 0 } },
+};
+
+static filtro_canal_t filtros[ESTACAO_CANAIS];
+
+// Última leitura de cada sensor (a amostra guarda a bruta ao lado da filtrada)
+static int32_t pressao = 0; // Pa (0 = ainda sem leitura)
+static float temperatura = 0, umidade = 0;
+
+static amostra_t atual;
+static amostra_derivadas_t derivadas_coleta; // Tendência e alertas (contexto da coleta)
+
+void estacao_iniciar(alerta_transicao_cb_t cb) {
+    filtro_configurar(&filtros[ESTACAO_TEMPERATURA], estagios_temperatura, 2);
+    filtro_configurar(&filtros[ESTACAO_UMIDADE], estagios_umidade, 2);
+    filtro_configurar(&filtros[ESTACAO_PRESSAO], estagios_pressao, 2);
+    alertas_iniciar(regras_alerta, ESTACAO_REGRAS, cb);
+    pressao = 0;
+    temperatura = umidade = 0;
+    atual = (amostra_t){0};
+    derivadas_coleta = (amostra_derivadas_t){0};
+}
+
+void estacao_pressao(int32_t pressao_pa) {
+    pressao = pressao_pa;
+    filtro_aplicar(&filtros[ESTACAO_PRESSAO], pressao);
+}
+
+void estacao_temperatura_umidade(float t, float u) {
+    temperatura = t;
+    umidade = u;
+    filtro_aplicar(&filtros[ESTACAO_TEMPERATURA], temperatura);
+    filtro_aplicar(&filtros[ESTACAO_UMIDADE], umidade);
+}
+
+const amostra_t *estacao_atualizar(const estacao_offsets_t *offsets, uint8_t velhos, uint32_t intervalo_ms) {
+    amostra_t *a = &atual;
+    a->temperatura = filtros[ESTACAO_TEMPERATURA].filtrado + offsets->temperatura;
+    a->pressao_kpa = (filtros[ESTACAO_PRESSAO].filtrado / 1000) + offsets->pressao_kpa;
+    a->umidade = filtros[ESTACAO_UMIDADE].filtrado + offsets->umidade;
+    // Derivadas só são recalculadas quando pedidas e se as entradas mudaram. Aqui só a altitude, que vai em
+    // toda amostra; a pressão ao nível do mar é pedida pela tendência e as demais por quem lê a amostra
+    derivadas_entrada(DERIVADAS_TEMPERATURA, a->temperatura);
+    derivadas_entrada(DERIVADAS_UMIDADE, a->umidade);
+    if (pressao > 0) {
+        derivadas_entrada(DERIVADAS_PRESSAO, a->pressao_kpa);
+    }
+    float altitude = derivadas_obter(DERIVADA_ALTITUDE);
+    if (!isnan(altitude)) {
+        a->altitude = altitude + offsets->altitude;
+    }
+    a->temperatura_bruta = temperatura;
+    a->umidade_bruta = umidade;
+    a->pressao_bruta = pressao;
+    a->intervalo_ms = intervalo_ms;
+    a->velhos = velhos;
+    a->sequencia = amostra_publicar(a); // A cópia local também: é a chave dos caches de derivadas
+    return a;
+}
+
+float estacao_tendencia(const amostra_t *a, uint64_t agora_us, uint8_t *previsao) {
+    // Tendência barométrica (O(1) por amostra) e previsão
+    if (a->pressao_bruta > 0) {
+        tendencia_observar(a->pressao_kpa * 1000.0f, agora_us);
+    }
+    *previsao = tendencia_zambretti(amostra_derivada(a, DERIVADA_PRESSAO_MAR, &derivadas_coleta));
+    return tendencia_variacao_3h();
+}
+
+void estacao_alertas(const amostra_t *a, uint64_t agora_us) {
+    // Canal sem leitura válida vai como NAN: as regras mantêm o estado em vez de avaliar um valor que não foi
+    // medido no ciclo (antes da primeira leitura os filtros ainda estão em 0)
+    bool aht20_velho = a->velhos & (AMOSTRA_VELHA_TEMPERATURA | AMOSTRA_VELHA_UMIDADE);
+    const float valores[ALERTA_CANAIS] = {
+        [ALERTA_TEMPERATURA] = a->velhos & AMOSTRA_VELHA_TEMPERATURA ? NAN : a->temperatura,
+        [ALERTA_UMIDADE] = a->velhos & AMOSTRA_VELHA_UMIDADE ? NAN : a->umidade,
+        [ALERTA_PRESSAO] = a->velhos & AMOSTRA_VELHA_PRESSAO ? NAN : a->pressao_kpa,
+        [ALERTA_INDICE_CALOR] = aht20_velho ? NAN : amostra_derivada(a, DERIVADA_INDICE_CALOR, &derivadas_coleta),
+    };
+    alertas_avaliar(valores, agora_us);
+}
+
+const filtro_canal_t *estacao_filtro(estacao_canal_t c) {
+    return &filtros[c];
+}
@@ -0,0 +1,64 @@
+#ifndef ESTACAO_H
+#define ESTACAO_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "filtros.h"
+#include "alertas.h"
+#include "amostra.h"
+
+// Caminho de uma amostra, das leituras dos sensores à amostra publicada: filtros, offsets, grandezas
+// derivadas, tendência e regras de alerta. Não depende do SDK: o firmware e o tools/replay.c executam
+// este mesmo código, então a reprodução de uma gravação não precisa de cópias da configuração.
+
+// Padrões da matriz de LEDs (alerta_regra_t.padrao_matriz)
+enum { PADRAO_OK, PADRAO_ALERTA, PADRAO_PRESSAO };
+
+// Regras de alerta (a ordem da tabela é a prioridade na matriz de LEDs)
+enum {
+    REGRA_TEMP_ALTA,
+    REGRA_TEMP_BAIXA,
+    REGRA_UMI_ALTA,
+    REGRA_UMI_BAIXA,
+    REGRA_CALOR,
+    REGRA_INDICE_CALOR,
+    REGRA_PRESSAO_QUEDA,
+    ESTACAO_REGRAS
+};
+
+typedef enum {
+    ESTACAO_TEMPERATURA,
+    ESTACAO_UMIDADE,
+    ESTACAO_PRESSAO, // Pa
+    ESTACAO_CANAIS
+} estacao_canal_t;
+
+// Somados aos valores filtrados (a altitude é somada à estimada pela pressão)
+typedef struct {
+    float temperatura;
+    float pressao_kpa;
+    float altitude;
+    float umidade;
+} estacao_offsets_t;
+
+// Configura os filtros e as regras de alerta e zera as leituras; cb recebe as transições dos alertas
+void estacao_iniciar(alerta_transicao_cb_t cb);
+
+// Conversão nova do BMP280 (Pa) e leitura válida do AHT20 (°C, %)
+void estacao_pressao(int32_t pressao_pa);
+void estacao_temperatura_umidade(float temperatura, float umidade);
+
+// Calcula a amostra com as leituras filtradas e os offsets e a publica com amostra_publicar (velhos:
+// AMOSTRA_VELHA_* das grandezas sem leitura válida no ciclo; intervalo_ms: desde a amostra anterior)
+const amostra_t *estacao_atualizar(const estacao_offsets_t *offsets, uint8_t velhos, uint32_t intervalo_ms);
+
+// Observa a pressão da amostra na tendência barométrica; retorna a variação em 3 h e a previsão de Zambretti
+float estacao_tendencia(const amostra_t *a, uint64_t agora_us, uint8_t *previsao);
+
+// Avalia as regras de alerta sobre a amostra (as grandezas marcadas em velhos não alteram o estado dos alertas)
+void estacao_alertas(const amostra_t *a, uint64_t agora_us);
+
+const filtro_canal_t *estacao_filtro(estacao_canal_t c);
+
+#endif // ESTACAO_H
@@ -0,0 +1,108 @@
+#include <string.h>
+#include "filtros.h"
+
+void filtro_configurar(filtro_canal_t *c, const filtro_estagio_t *estagios, int n) {
+    memset(c, 0, sizeof(*c));
+    if (n > FILTRO_ESTAGIOS) {
+        n = FILTRO_ESTAGIOS;
+    }
+    for (int i = 0; i < n; i++) {
+        filtro_estagio_t cfg = estagios[i];
+        if (cfg.tipo == FILTRO_MEDIANA) {
+            // Janela ímpar entre 1 e FILTRO_MEDIANA_MAX
+            int janela = (int)cfg.p1;
+            janela = janela < 1 ? 1 : janela > FILTRO_MEDIANA_MAX ? FILTRO_MEDIANA_MAX : janela;
+            cfg.p1 = (float)(janela | 1); // FILTRO_MEDIANA_MAX é ímpar
+        }
+        c->estagios[i].cfg = cfg;
+    }
+    c->n_estagios = (uint8_t)n;
+}
+
+void filtro_reiniciar(filtro_canal_t *c) {
+    for (int i = 0; i < c->n_estagios; i++) {
+        filtro_estagio_t cfg = c->estagios[i].cfg;
+        memset(&c->estagios[i], 0, sizeof(c->estagios[i]));
+        c->estagios[i].cfg = cfg;
+    }
+}
+
+// Mediana móvel: troca o valor que sai da janela pelo que entra mantendo a cópia ordenada
+// (no máximo FILTRO_MEDIANA_MAX deslocamentos, sem ordenar a janela a cada amostra)
+static float mediana(filtro_estado_t *e, float x) {
+    uint8_t janela = (uint8_t)e->cfg.p1;
+    float *ord = e->mediana.ordenada;
+    int n = e->mediana.n;
+    int i;
+
+    if (n == janela) {
+        // Retira da cópia ordenada o valor mais antigo
+        float saindo = e->mediana.janela[e->mediana.pos];
+        for (i = 0; i < n && ord[i] != saindo; i++) {
+        }
+        for (; i < n - 1; i++) {
+            ord[i] = ord[i + 1];
+        }
+        n--;
+    }
+
+    // Inserção ordenada do novo valor
+    for (i = n; i > 0 && ord[i - 1] > x; i--) {
+        ord[i] = ord[i - 1];
+    }
+    ord[i] = x;
+    n++;
+
+    e->mediana.janela[e->mediana.pos] = x;
+    e->mediana.pos = (uint8_t)((e->mediana.pos + 1) % janela);
+    e->mediana.n = (uint8_t)n;
+
+    // Enquanto a janela enche, mediana do que já chegou
+    return (n & 1) ? ord[n / 2] : 0.5f * (ord[n / 2 - 1] + ord[n / 2]);
+}
+
+static float ema(filtro_estado_t *e, float x) {
+    if (!e->iniciado) {
+        e->ema.y = x;
+    } else {
+        e->ema.y += e->cfg.p1 * (x - e->ema.y);
+    }
+    return e->ema.y;
+}
+
+// Kalman 1D com modelo de passeio aleatório: x_k = x_{k-1} + w (var q), z_k = x_k + v (var r)
+static float kalman(filtro_estado_t *e, float z) {
+    if (!e->iniciado) {
+        e->kalman.x = z;
+        e->kalman.p = e->cfg.p2;
+        return z;
+    }
+    float p = e->kalman.p + e->cfg.p1;
+    float k = p / (p + e->cfg.p2);
+    e->kalman.x += k * (z - e->kalman.x);
+    e->kalman.p = (1.0f - k) * p;
+    return e->kalman.x;
+}
+
+float filtro_aplicar(filtro_canal_t *c, float x) {
+    c->bruto = x;
+    for (int i = 0; i < c->n_estagios; i++) {
+        filtro_estado_t *e = &c->estagios[i];
+        switch (e->cfg.tipo) {
+        case FILTRO_MEDIANA:
+            x = mediana(e, x);
+            break;
+        case FILTRO_EMA:
+            x = ema(e, x);
+            break;
+        case FILTRO_KALMAN:
+            x = kalman(e, x);
+            break;
+        default:
+            break;
+        }
+        e->iniciado = true;
+    }
+    c->filtrado = x;
+    return x;
+}
@@ -0,0 +1,59 @@
+#ifndef FILTROS_H
+#define FILTROS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Filtros de fluxo por canal: cada canal encadeia até FILTRO_ESTAGIOS estágios (mediana, EMA, Kalman).
+// Estado de tamanho fixo e trabalho constante por amostra; não depende do SDK (também compila no host).
+
+#define FILTRO_ESTAGIOS 2
+#define FILTRO_MEDIANA_MAX 7 // Maior janela da mediana móvel
+
+typedef enum {
+    FILTRO_NENHUM,
+    FILTRO_MEDIANA, // p1 = janela (ímpar, até FILTRO_MEDIANA_MAX)
+    FILTRO_EMA,     // p1 = alfa (0 < alfa <= 1; menor = mais suave)
+    FILTRO_KALMAN   // p1 = q (variância do processo por amostra), p2 = r (variância da medição)
+} filtro_tipo_t;
+
+typedef struct {
+    filtro_tipo_t tipo;
+    float p1, p2;
+} filtro_estagio_t;
+
+typedef struct {
+    filtro_estagio_t cfg;
+    union {
+        struct {
+            float janela[FILTRO_MEDIANA_MAX];   // Ordem de chegada (circular)
+            float ordenada[FILTRO_MEDIANA_MAX]; // Mesmos valores em ordem crescente
+            uint8_t n, pos;
+        } mediana;
+        struct {
+            float y;
+        } ema;
+        struct {
+            float x, p;
+        } kalman;
+    };
+    bool iniciado;
+} filtro_estado_t;
+
+typedef struct {
+    filtro_estado_t estagios[FILTRO_ESTAGIOS];
+    uint8_t n_estagios;
+    float bruto;    // Última amostra recebida
+    float filtrado; // Saída do último estágio
+} filtro_canal_t;
+
+// Define os estágios do canal (n <= FILTRO_ESTAGIOS) e zera o estado
+void filtro_configurar(filtro_canal_t *c, const filtro_estagio_t *estagios, int n);
+
+// Zera o estado mantendo a configuração (a próxima amostra reinicia os estágios)
+void filtro_reiniciar(filtro_canal_t *c);
+
+// Processa uma amostra e retorna o valor filtrado
+float filtro_aplicar(filtro_canal_t *c, float x);
+
+#endif // FILTROS_H
@@ -0,0 +1,127 @@
+#include <stdio.h>
+#include <string.h>
+#include "sensores.h"
+#include "gravacao.h"
+
+#if (GRAVACAO_BUFFER_BYTES & (GRAVACAO_BUFFER_BYTES - 1)) != 0
+#error "GRAVACAO_BUFFER_BYTES deve ser potência de 2"
+#endif
+
+// Registro no buffer: [tamanho] [bytes do registro]. Produtor e consumidor rodam em tarefas do
+// agendador (cooperativo, um só núcleo): não há concorrência e nenhuma seção crítica é necessária.
+static uint8_t buffer_gravacao[GRAVACAO_BUFFER_BYTES];
+static uint32_t escrita = 0;
+static uint32_t leitura = 0;
+static uint32_t perdidos = 0; // Descartados ainda não informados com GRAVACAO_PERDA
+static gravacao_stats_t stats;
+
+static const char hex[] = "0123456789abcdef";
+
+static void gravar(const void *registro, uint32_t n) {
+    if (GRAVACAO_BUFFER_BYTES - (escrita - leitura) < n + 1) {
+        perdidos++;
+        stats.descartados++;
+        return;
+    }
+    buffer_gravacao[escrita++ & (GRAVACAO_BUFFER_BYTES - 1)] = (uint8_t)n;
+    for (uint32_t i = 0; i < n; i++) {
+        buffer_gravacao[escrita++ & (GRAVACAO_BUFFER_BYTES - 1)] = ((const uint8_t *)registro)[i];
+    }
+    stats.registros++;
+    stats.bytes += n;
+}
+
+void gravacao_ativar(bool ativa) {
+    if (ativa == stats.ativa) {
+        return;
+    }
+    stats.ativa = ativa;
+    if (!ativa) {
+        return;
+    }
+    gravacao_inicio_t r = { GRAVACAO_INICIO, GRAVACAO_VERSAO, (uint8_t)sensores_quantidade(), 0, 0 };
+    gravar(&r, sizeof(r));
+    for (int i = 0; i < sensores_quantidade(); i++) {
+        gravacao_sensor(i);
+    }
+}
+
+bool gravacao_ativa(void) {
+    return stats.ativa;
+}
+
+void gravacao_sensor(int id) {
+    const sensor_t *s = sensores_obter(id);
+    if (!stats.ativa || !s || !s->presente) {
+        return;
+    }
+    gravacao_sensor_t r = { GRAVACAO_SENSOR, (uint8_t)id, (uint8_t)s->tipo, s->endereco, s->canal_mux };
+    if (s->tipo == SENSOR_BMP280) {
+        r.config[0] = s->config.osrs_t;
+        r.config[1] = s->config.osrs_p;
+        r.config[2] = s->config.filtro;
+        r.config[3] = s->config.standby;
+        r.config[4] = s->config.modo;
+        r.calibracao = s->calibracao;
+    }
+    gravar(&r, sizeof(r));
+}
+
+void gravacao_ciclo(uint64_t agora_us, uint32_t intervalo_ms) {
+    if (!stats.ativa) {
+        return;
+    }
+    gravacao_ciclo_t r = { GRAVACAO_CICLO, agora_us, intervalo_ms };
+    gravar(&r, sizeof(r));
+    stats.ciclos++;
+}
+
+void gravacao_leitura(int id, uint32_t fim_us, const uint8_t *dados, uint8_t n) {
+    if (!stats.ativa) {
+        return;
+    }
+    if (n > BMP280_BURST_LEN) {
+        n = BMP280_BURST_LEN;
+    }
+    gravacao_leitura_t r = { GRAVACAO_LEITURA, (uint8_t)id, n, fim_us };
+    memcpy(r.dados, dados, n);
+    gravar(&r, sizeof(r) - sizeof(r.dados) + n);
+}
+
+// Escreve um registro como linha GRAVACAO_PREFIXO + bytes em hexadecimal
+static void enviar_registro(const uint8_t *bytes, uint32_t n) {
+    char linha[sizeof(GRAVACAO_PREFIXO) + GRAVACAO_REGISTRO_MAX * 2 + 1];
+    char *p = linha;
+    for (const char *s = GRAVACAO_PREFIXO; *s; s++) {
+        *p++ = *s;
+    }
+    for (uint32_t i = 0; i < n; i++) {
+        *p++ = hex[bytes[i] >> 4];
+        *p++ = hex[bytes[i] & 0xF];
+    }
+    *p++ = '\n';
+    *p = '\0';
+    fputs(linha, stdout);
+}
+
+void gravacao_descarregar(void) {
+    uint8_t registro[GRAVACAO_REGISTRO_MAX];
+    while (leitura != escrita) {
+        uint32_t n = buffer_gravacao[leitura++ & (GRAVACAO_BUFFER_BYTES - 1)];
+        for (uint32_t i = 0; i < n; i++) {
+            registro[i] = buffer_gravacao[leitura++ & (GRAVACAO_BUFFER_BYTES - 1)];
+        }
+        enviar_registro(registro, n);
+    }
+
+    // A reprodução precisa saber onde há buracos: o ciclo seguinte a uma perda pode estar incompleto
+    if (perdidos) {
+        gravacao_perda_t r = { GRAVACAO_PERDA, perdidos };
+        perdidos = 0;
+        enviar_registro((const uint8_t *)&r, sizeof(r));
+    }
+}
+
+const gravacao_stats_t *gravacao_stats(void) {
+    return &stats;
+}
@@ -0,0 +1,100 @@
+#ifndef GRAVACAO_H
+#define GRAVACAO_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "conversao.h"
+
+// Gravação das leituras brutas dos sensores para reprodução no host (tools/replay.c).
+// Enquanto ativa, cada ciclo de coleta gera um registro CICLO com o instante e o intervalo da amostra
+// seguido de um registro LEITURA por sensor lido com sucesso (bytes exatamente como vieram do barramento).
+// Ao ativar, e a cada reconfiguração, um registro SENSOR descreve o sensor (calibração do BMP280 incluída).
+// Os registros vão para um buffer circular e saem pela USB no tempo ocioso como GRAVACAO_PREFIXO +
+// bytes em hexadecimal, uma linha por registro; o resto da saída USB não é afetado.
+
+#define GRAVACAO_PREFIXO "@G"
+
+// Tamanho do buffer circular em bytes (potência de 2)
+#ifndef GRAVACAO_BUFFER_BYTES
+#define GRAVACAO_BUFFER_BYTES 2048
+#endif
+
+#define GRAVACAO_VERSAO 2 // 2: intervalo_ms no registro CICLO
+
+// Tipos de registro (primeiro byte)
+typedef enum {
+    GRAVACAO_INICIO = 1, // Início da gravação
+    GRAVACAO_SENSOR,     // Descrição de um sensor
+    GRAVACAO_CICLO,      // Início de um ciclo de coleta
+    GRAVACAO_LEITURA,    // Bytes brutos de um sensor no ciclo corrente
+    GRAVACAO_PERDA,      // Registros descartados por falta de espaço no buffer
+} gravacao_tipo_t;
+
+// Registros (little-endian, sem alinhamento)
+typedef struct __attribute__((packed)) {
+    uint8_t tipo;      // GRAVACAO_INICIO
+    uint8_t versao;    // GRAVACAO_VERSAO
+    uint8_t n_sensores;
+    uint8_t reservado;
+    uint64_t tempo_us;
+} gravacao_inicio_t;
+
+typedef struct __attribute__((packed)) {
+    uint8_t tipo;      // GRAVACAO_SENSOR
+    uint8_t id;        // Índice no registro de sensores
+    uint8_t sensor;    // sensor_tipo_t (0 = BMP280, 1 = AHT20)
+    uint8_t endereco;
+    int8_t canal_mux;  // -1 = sem multiplexador
+    uint8_t config[5]; // BMP280: osrs_t, osrs_p, filtro, standby, modo
+    struct bmp280_calib_param calibracao; // BMP280 (zerada no AHT20)
+} gravacao_sensor_t;
+
+typedef struct __attribute__((packed)) {
+    uint8_t tipo;      // GRAVACAO_CICLO
+    uint64_t tempo_us; // Instante da amostra (o mesmo usado pela tendência e pelos alertas)
+    uint32_t intervalo_ms; // Intervalo real desde a amostra anterior (0 = primeira; ausente na versão 1)
+} gravacao_ciclo_t;
+
+typedef struct __attribute__((packed)) {
+    uint8_t tipo;      // GRAVACAO_LEITURA
+    uint8_t id;
+    uint8_t n;         // Bytes que seguem (BMP280_BURST_LEN ou AHT20_QUADRO_LEN)
+    uint32_t fim_us;   // Fim da transação de leitura
+    uint8_t dados[BMP280_BURST_LEN];
+} gravacao_leitura_t;
+
+typedef struct __attribute__((packed)) {
+    uint8_t tipo;      // GRAVACAO_PERDA
+    uint32_t descartados;
+} gravacao_perda_t;
+
+#define GRAVACAO_REGISTRO_MAX sizeof(gravacao_sensor_t)
+
+typedef struct {
+    bool ativa;
+    uint32_t ciclos;
+    uint32_t registros;
+    uint32_t bytes;       // Bytes de registro gravados (antes da codificação em hexadecimal)
+    uint32_t descartados;
+} gravacao_stats_t;
+
+// Liga/desliga a gravação; ao ligar grava INICIO e a descrição de todos os sensores presentes
+void gravacao_ativar(bool ativa);
+bool gravacao_ativa(void);
+
+// Registra a (re)configuração de um sensor
+void gravacao_sensor(int id);
+
+// Marca o início de um ciclo de coleta
+void gravacao_ciclo(uint64_t agora_us, uint32_t intervalo_ms);
+
+// Registra os bytes lidos de um sensor no ciclo corrente
+void gravacao_leitura(int id, uint32_t fim_us, const uint8_t *dados, uint8_t n);
+
+// Envia os registros pendentes pela saída padrão (chamar no tempo ocioso)
+void gravacao_descarregar(void);
+
+const gravacao_stats_t *gravacao_stats(void);
+
+#endif // GRAVACAO_H
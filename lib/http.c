@@ -0,0 +1,64 @@
+#include <stdio.h>
+#include <string.h>
+#include "http.h"
+
+const http_rota_t *http_encontrar(const http_rota_t *rotas, int n, const char *req) {
+    const http_rota_t *padrao = NULL;
+
+    // Caminho: do primeiro '/' da linha até '?', espaço ou fim de linha
+    const char *caminho = strncmp(req, "GET ", 4) == 0 ? req + 4 : NULL;
+    size_t tamanho = 0;
+    if (caminho) {
+        tamanho = strcspn(caminho, "? \r\n");
+    }
+
+    for (int i = 0; i < n; i++) {
+        const char *c = rotas[i].caminho;
+        if (!c) {
+            padrao = &rotas[i];
+        } else if (caminho && strncmp(c, caminho, tamanho) == 0 && c[tamanho] == '\0') {
+            return &rotas[i];
+        }
+    }
+    return padrao;
+}
+
+const char *http_responder(const http_rota_t *rotas, int n, const char *req, char *buf, size_t cap, size_t *len) {
+    const http_rota_t *rota = http_encontrar(rotas, n, req);
+    if (!rota || cap <= HTTP_CABECALHO_MAX) {
+        return NULL;
+    }
+
+    const char *tipo = HTTP_TEXTO;
+    char *corpo = buf + HTTP_CABECALHO_MAX;
+    size_t n_corpo = rota->tratar(req, corpo, cap - HTTP_CABECALHO_MAX, &tipo);
+    if (n_corpo >= cap - HTTP_CABECALHO_MAX) {
+        n_corpo = cap - HTTP_CABECALHO_MAX - 1; // Corpo truncado pelo snprintf do tratador
+    }
+
+    char cabecalho[HTTP_CABECALHO_MAX + 1];
+    int n_cab = snprintf(cabecalho, sizeof(cabecalho),
+                         "HTTP/1.1 200 OK\r\n"
+                         "Content-Type: %s\r\n"
+                         "Content-Length: %d\r\n"
+                         "Connection: close\r\n"
+                         "\r\n",
+                         tipo, (int)n_corpo);
+    if (n_cab < 0 || n_cab > HTTP_CABECALHO_MAX) {
+        return NULL;
+    }
+    char *inicio = corpo - n_cab;
+    memcpy(inicio, cabecalho, (size_t)n_cab);
+    *len = (size_t)n_cab + n_corpo;
+    return inicio;
+}
+
+size_t http_texto(char *corpo, size_t cap, const char *txt) {
+    size_t n = strlen(txt);
+    if (n >= cap) {
+        n = cap - 1;
+    }
+    memcpy(corpo, txt, n);
+    corpo[n] = '\0';
+    return n;
+}
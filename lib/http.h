@@ -0,0 +1,38 @@
+#ifndef HTTP_H
+#define HTTP_H
+
+#include <stddef.h>
+#include <stdbool.h>
+
+// Roteamento das requisições HTTP e montagem das respostas, sem depender do lwIP (também compila no host).
+// A rota é escolhida pelo caminho da linha de requisição (sem a query string), comparado por inteiro:
+// a ordem da tabela não importa e "/amostragem" não casa com "/set_amostragem?...".
+// O tratador escreve só o corpo, a partir de HTTP_CABECALHO_MAX; o cabeçalho é formatado depois, já com
+// o Content-Length, e gravado imediatamente antes do corpo, então a resposta não é copiada.
+
+#define HTTP_CABECALHO_MAX 160 // Espaço reservado para o cabeçalho antes do corpo
+#define HTTP_LINHA_MAX 256     // Parte da requisição entregue aos tratadores (linha de requisição + folga)
+
+#define HTTP_TEXTO "text/plain"
+#define HTTP_JSON "application/json"
+#define HTTP_HTML "text/html"
+
+// Escreve o corpo em corpo[0..cap) e retorna o tamanho; *tipo começa em HTTP_TEXTO
+typedef size_t (*http_tratador_t)(const char *req, char *corpo, size_t cap, const char **tipo);
+
+typedef struct {
+    const char *caminho;     // "/dados"; NULL = rota padrão (usada quando nenhuma outra casa)
+    http_tratador_t tratar;
+} http_rota_t;
+
+// Rota da requisição ("GET /caminho[?query] HTTP/1.1"); NULL se não houver rota nem padrão
+const http_rota_t *http_encontrar(const http_rota_t *rotas, int n, const char *req);
+
+// Atende a requisição em buf[0..cap): retorna o início da resposta dentro de buf e o tamanho em *len
+// (NULL se nenhuma rota atende)
+const char *http_responder(const http_rota_t *rotas, int n, const char *req, char *buf, size_t cap, size_t *len);
+
+// Corpo de texto fixo (resposta das rotas de configuração)
+size_t http_texto(char *corpo, size_t cap, const char *txt);
+
+#endif // HTTP_H
@@ -0,0 +1,408 @@
+#include <stdio.h>
+#include "pico/stdlib.h"
+#include "hardware/i2c.h"
+#include "hardware/dma.h"
+#include "hardware/irq.h"
+#include "hardware/sync.h"
+#include "i2c_fila.h"
+#include "memoria.h"
+
+// Estado de um controlador: fila ordenada por prioridade e a transação em curso.
+// A fila é alterada pelo código principal (enviar) e pela interrupção (próxima transação),
+// sempre com as interrupções desligadas.
+typedef struct {
+    i2c_inst_t *i2c;
+    bool ativo;
+    int dma_tx, dma_rx;
+    i2c_transacao_t *fila[I2C_FILA_TAMANHO];
+    uint32_t n_fila;
+    i2c_transacao_t *atual;
+    // Encerradas com erro fora da interrupção (recuperação, prazo na fila): o callback fica para a interrupção
+    i2c_transacao_t *encerradas[I2C_FILA_TAMANHO + 1];
+    uint32_t n_encerradas;
+    // Palavras de IC_DATA_CMD (dado + bits CMD/STOP/RESTART) lidas pela DMA de transmissão
+    uint32_t palavras[I2C_FILA_MAX_PALAVRAS];
+    uint64_t inicio_us;
+    i2c_fila_stats_t stats;
+    bool recuperavel; // Pinos conhecidos (i2c_fila_pinos)
+    uint sda, scl, baudrate;
+} barramento_t;
+
+static barramento_t barramentos[2];
+
+// Esperas limitadas dentro da interrupção: alguns períodos de SCL a 100 kHz. Se o prazo estoura
+// (barramento travado), a transação seguinte falha por prazo e a recuperação de i2c_fila_aguardar age.
+#define PRAZO_STOP_ABORTO_US 200 // STOP_DET gerado depois do TX_ABRT
+#define PRAZO_DESLIGAR_US 200    // IC_ENABLE_STATUS após desligar o controlador
+
+static inline barramento_t *barramento(i2c_inst_t *i2c) {
+    return &barramentos[i2c_hw_index(i2c)];
+}
+
+// Monta os comandos e dispara as DMAs; o fim chega pela interrupção STOP_DET ou TX_ABRT
+static void __not_in_flash_func(iniciar)(barramento_t *b, i2c_transacao_t *t) {
+    i2c_hw_t *hw = i2c_get_hw(b->i2c);
+    uint32_t n = 0;
+    for (uint32_t i = 0; i < t->n_cabecalho; i++) {
+        b->palavras[n++] = t->cabecalho[i];
+    }
+    for (uint32_t i = 0; i < t->n_tx; i++) {
+        b->palavras[n++] = t->tx[i];
+    }
+    // Leitura depois de escrita: RESTART no primeiro comando de leitura
+    uint32_t restart = n ? I2C_IC_DATA_CMD_RESTART_BITS : 0;
+    for (uint32_t i = 0; i < t->n_rx; i++) {
+        b->palavras[n++] = I2C_IC_DATA_CMD_CMD_BITS | (i == 0 ? restart : 0);
+    }
+    b->palavras[n - 1] |= I2C_IC_DATA_CMD_STOP_BITS;
+
+    b->atual = t;
+    t->estado = I2C_TRANS_EM_CURSO;
+    t->inicio_us = time_us_32();
+
+    // O endereço do alvo só pode ser trocado com o controlador desligado (de fato: IC_ENABLE_STATUS)
+    hw->enable = 0;
+    uint32_t t0 = time_us_32();
+    while ((hw->enable_status & I2C_IC_ENABLE_STATUS_IC_EN_BITS) && time_us_32() - t0 < PRAZO_DESLIGAR_US) {
+        tight_loop_contents();
+    }
+    hw->tar = t->endereco;
+    hw->enable = 1;
+    (void)hw->clr_intr;
+
+    if (t->n_rx) {
+        dma_channel_config c = dma_channel_get_default_config(b->dma_rx);
+        channel_config_set_transfer_data_size(&c, DMA_SIZE_8);
+        channel_config_set_read_increment(&c, false);
+        channel_config_set_write_increment(&c, true);
+        channel_config_set_dreq(&c, i2c_get_dreq(b->i2c, false));
+        dma_channel_configure(b->dma_rx, &c, t->rx, &hw->data_cmd, t->n_rx, true);
+    }
+
+    dma_channel_config c = dma_channel_get_default_config(b->dma_tx);
+    channel_config_set_transfer_data_size(&c, DMA_SIZE_32);
+    channel_config_set_read_increment(&c, true);
+    channel_config_set_write_increment(&c, false);
+    channel_config_set_dreq(&c, i2c_get_dreq(b->i2c, true));
+    dma_channel_configure(b->dma_tx, &c, &hw->data_cmd, b->palavras, n, true);
+}
+
+// Retira a transação de maior prioridade (a fila já está ordenada)
+static i2c_transacao_t *retirar(barramento_t *b) {
+    if (!b->n_fila) {
+        return NULL;
+    }
+    i2c_transacao_t *t = b->fila[0];
+    b->n_fila--;
+    for (uint32_t i = 0; i < b->n_fila; i++) {
+        b->fila[i] = b->fila[i + 1];
+    }
+    return t;
+}
+
+static void __not_in_flash_func(proxima)(barramento_t *b) {
+    i2c_transacao_t *t = retirar(b);
+    b->atual = NULL;
+    if (t) {
+        uint32_t espera = time_us_32() - t->enfileirada_us;
+        b->stats.espera_soma_us += espera;
+        if (espera > b->stats.espera_max_us) {
+            b->stats.espera_max_us = espera;
+        }
+        iniciar(b, t);
+    }
+}
+
+static void __not_in_flash_func(concluir)(barramento_t *b, bool erro) {
+    i2c_transacao_t *t = b->atual;
+    if (!t) {
+        return;
+    }
+    t->fim_us = time_us_32();
+    b->stats.ocupado_us += t->fim_us - t->inicio_us;
+    b->stats.transacoes++;
+    b->stats.bytes += t->n_cabecalho + t->n_tx + t->n_rx;
+    if (erro) {
+        b->stats.erros++;
+    }
+    t->estado = erro ? I2C_TRANS_ERRO : I2C_TRANS_OK;
+    if (t->callback) {
+        t->callback(t);
+    }
+    __sev(); // Acorda quem está em i2c_fila_aguardar
+    proxima(b);
+}
+
+// Callbacks das transações encerradas fora da interrupção (a interrupção foi marcada pendente para isso)
+static void __not_in_flash_func(avisar_encerradas)(barramento_t *b) {
+    for (uint32_t i = 0; i < b->n_encerradas; i++) {
+        b->encerradas[i]->callback(b->encerradas[i]);
+    }
+    b->n_encerradas = 0;
+}
+
+static void __not_in_flash_func(tratar_irq)(barramento_t *b) {
+    MEMORIA_SONDA_IRQ();
+    avisar_encerradas(b);
+    i2c_hw_t *hw = i2c_get_hw(b->i2c);
+    uint32_t st = hw->intr_stat;
+    if (st & I2C_IC_INTR_STAT_R_TX_ABRT_BITS) {
+        // NACK ou abort: descarta o resto da transação antes de liberar a FIFO
+        dma_channel_abort(b->dma_tx);
+        dma_channel_abort(b->dma_rx);
+        (void)hw->clr_tx_abrt;
+        // O STOP da transação abortada chega depois do TX_ABRT; se ficasse pendente, concluiria a próxima
+        // transação antes do fim (como o driver bloqueante do SDK, espera por ele antes de seguir)
+        uint32_t t0 = time_us_32();
+        while (!(hw->raw_intr_stat & I2C_IC_RAW_INTR_STAT_STOP_DET_BITS) &&
+               time_us_32() - t0 < PRAZO_STOP_ABORTO_US) {
+            tight_loop_contents();
+        }
+        (void)hw->clr_stop_det;
+        concluir(b, true);
+    } else if (st & I2C_IC_INTR_STAT_R_STOP_DET_BITS) {
+        (void)hw->clr_stop_det;
+        // O último byte lido pode ainda estar a caminho da memória
+        while (dma_channel_is_busy(b->dma_rx) && hw->rxflr) {
+            tight_loop_contents();
+        }
+        concluir(b, b->atual && b->atual->n_rx && dma_channel_is_busy(b->dma_rx));
+    }
+}
+
+static void __not_in_flash_func(i2c0_irq)(void) {
+    tratar_irq(&barramentos[0]);
+}
+
+static void __not_in_flash_func(i2c1_irq)(void) {
+    tratar_irq(&barramentos[1]);
+}
+
+// DMA e interrupções do controlador (de novo após o reset de i2c_init na recuperação)
+static void configurar_controlador(barramento_t *b) {
+    i2c_hw_t *hw = i2c_get_hw(b->i2c);
+    hw->dma_cr = I2C_IC_DMA_CR_TDMAE_BITS | I2C_IC_DMA_CR_RDMAE_BITS;
+    hw->intr_mask = I2C_IC_INTR_MASK_M_STOP_DET_BITS | I2C_IC_INTR_MASK_M_TX_ABRT_BITS;
+    (void)hw->clr_intr;
+}
+
+void i2c_fila_init(i2c_inst_t *i2c) {
+    barramento_t *b = barramento(i2c);
+    if (b->ativo) {
+        return;
+    }
+    b->i2c = i2c;
+    b->dma_tx = dma_claim_unused_channel(true);
+    b->dma_rx = dma_claim_unused_channel(true);
+    b->inicio_us = time_us_64();
+    configurar_controlador(b);
+
+    uint irq = I2C0_IRQ + i2c_hw_index(i2c);
+    irq_set_exclusive_handler(irq, i2c_hw_index(i2c) ? i2c1_irq : i2c0_irq);
+    irq_set_enabled(irq, true);
+    b->ativo = true;
+}
+
+void i2c_fila_pinos(i2c_inst_t *i2c, uint sda, uint scl, uint baudrate) {
+    barramento_t *b = barramento(i2c);
+    b->sda = sda;
+    b->scl = scl;
+    b->baudrate = baudrate;
+    b->recuperavel = true;
+}
+
+// Encerra uma transação com erro fora da interrupção (com ela desligada). O callback fica para a interrupção,
+// que quem chama marca pendente: quem usa callback não precisa tratar a execução fora dela
+static void falhar(barramento_t *b, i2c_transacao_t *t) {
+    t->fim_us = time_us_32();
+    t->estado = I2C_TRANS_ERRO;
+    if (t->callback && b->n_encerradas < I2C_FILA_TAMANHO + 1) {
+        b->encerradas[b->n_encerradas++] = t;
+    }
+}
+
+// Meio período de SCL a 100 kHz (a recuperação não precisa de velocidade)
+#define RECUPERACAO_MEIO_PERIODO_US 5
+
+// Linha em dreno aberto: nível baixo com o pino como saída em 0, nível alto soltando o pino (pull-up)
+static void linha(uint pino, bool alto) {
+    gpio_set_dir(pino, alto ? GPIO_IN : GPIO_OUT);
+    busy_wait_us_32(RECUPERACAO_MEIO_PERIODO_US);
+}
+
+bool i2c_fila_recuperar(i2c_inst_t *i2c) {
+    barramento_t *b = barramento(i2c);
+    if (!b->ativo || !b->recuperavel) {
+        return false;
+    }
+    uint irq = I2C0_IRQ + i2c_hw_index(i2c);
+    irq_set_enabled(irq, false);
+    dma_channel_abort(b->dma_tx);
+    dma_channel_abort(b->dma_rx);
+
+    // Ninguém mais vai concluir estas transações: erro para quem estiver aguardando
+    if (b->atual) {
+        falhar(b, b->atual);
+        b->atual = NULL;
+    }
+    for (uint32_t i = 0; i < b->n_fila; i++) {
+        falhar(b, b->fila[i]);
+    }
+    b->n_fila = 0;
+    b->stats.erros++;
+    b->stats.recuperacoes++;
+
+    // Pulsos em SCL até o escravo terminar o byte que estava enviando e soltar SDA
+    uint pinos[2] = { b->sda, b->scl };
+    for (int i = 0; i < 2; i++) {
+        gpio_set_function(pinos[i], GPIO_FUNC_SIO);
+        gpio_put(pinos[i], 0);
+        gpio_set_dir(pinos[i], GPIO_IN);
+        gpio_pull_up(pinos[i]);
+    }
+    busy_wait_us_32(RECUPERACAO_MEIO_PERIODO_US);
+    for (int pulso = 0; pulso < 9 && !gpio_get(b->sda); pulso++) {
+        linha(b->scl, false);
+        linha(b->scl, true);
+    }
+    // STOP: SDA sobe com SCL alto
+    linha(b->sda, false);
+    linha(b->scl, true);
+    linha(b->sda, true);
+    bool livre = gpio_get(b->sda) && gpio_get(b->scl);
+
+    // i2c_init reseta o bloco: DMA e interrupções são configuradas de novo
+    i2c_init(i2c, b->baudrate);
+    gpio_set_function(b->sda, GPIO_FUNC_I2C);
+    gpio_set_function(b->scl, GPIO_FUNC_I2C);
+    configurar_controlador(b);
+    irq_set_enabled(irq, true);
+    if (b->n_encerradas) {
+        irq_set_pending(irq); // Callbacks das transações encerradas acima
+    }
+    __sev();
+    return livre;
+}
+
+bool i2c_fila_ativa(i2c_inst_t *i2c) {
+    return barramento(i2c)->ativo;
+}
+
+bool i2c_fila_enviar(i2c_inst_t *i2c, i2c_transacao_t *t) {
+    barramento_t *b = barramento(i2c);
+    uint32_t n = t->n_cabecalho + t->n_tx + t->n_rx;
+    if (!b->ativo || n == 0 || n > I2C_FILA_MAX_PALAVRAS || !i2c_fila_livre(t)) {
+        return false;
+    }
+
+    uint32_t estado = save_and_disable_interrupts();
+    if (!b->atual) {
+        t->enfileirada_us = time_us_32();
+        iniciar(b, t);
+        restore_interrupts(estado);
+        return true;
+    }
+    if (b->n_fila >= I2C_FILA_TAMANHO) {
+        restore_interrupts(estado);
+        return false;
+    }
+    // Inserção ordenada: depois de todas as de prioridade maior ou igual
+    uint32_t i = b->n_fila;
+    while (i > 0 && b->fila[i - 1]->prioridade < t->prioridade) {
+        b->fila[i] = b->fila[i - 1];
+        i--;
+    }
+    b->fila[i] = t;
+    b->n_fila++;
+    if (b->n_fila > b->stats.fila_max) {
+        b->stats.fila_max = b->n_fila;
+    }
+    t->estado = I2C_TRANS_NA_FILA;
+    t->enfileirada_us = time_us_32();
+    restore_interrupts(estado);
+    return true;
+}
+
+// Tira uma transação que passou do prazo: da fila, ou abortando-a no barramento
+static void cancelar(barramento_t *b, i2c_transacao_t *t) {
+    uint32_t estado = save_and_disable_interrupts();
+    uint32_t j = 0;
+    for (uint32_t i = 0; i < b->n_fila; i++) {
+        if (b->fila[i] != t) {
+            b->fila[j++] = b->fila[i];
+        }
+    }
+    if (j != b->n_fila) {
+        b->n_fila = j;
+        falhar(b, t);
+        b->stats.erros++;
+        if (t->callback) {
+            irq_set_pending(I2C0_IRQ + i2c_hw_index(b->i2c));
+        }
+    } else if (t->estado == I2C_TRANS_EM_CURSO && b->atual == t) {
+        // O abort gera TX_ABRT e a interrupção conclui a transação com erro
+        i2c_get_hw(b->i2c)->enable |= I2C_IC_ENABLE_ABORT_BITS;
+    }
+    restore_interrupts(estado);
+}
+
+bool i2c_fila_aguardar(i2c_transacao_t *t, uint32_t timeout_us) {
+    absolute_time_t prazo = make_timeout_time_us(timeout_us);
+    while (!i2c_fila_concluida(t)) {
+        if (best_effort_wfe_or_timeout(prazo)) {
+            for (int i = 0; i < 2; i++) {
+                if (barramentos[i].ativo) {
+                    cancelar(&barramentos[i], t);
+                }
+            }
+            // Espera curta pelo TX_ABRT do abort
+            absolute_time_t limite = make_timeout_time_us(1000);
+            while (!i2c_fila_concluida(t) && !time_reached(limite)) {
+                tight_loop_contents();
+            }
+            // O abort não terminou: o controlador está preso esperando o barramento
+            for (int i = 0; i < 2 && !i2c_fila_concluida(t); i++) {
+                if (barramentos[i].ativo && barramentos[i].atual == t) {
+                    i2c_fila_recuperar(barramentos[i].i2c);
+                }
+            }
+            break;
+        }
+    }
+    return t->estado == I2C_TRANS_OK;
+}
+
+const i2c_fila_stats_t *i2c_fila_stats(i2c_inst_t *i2c) {
+    return &barramento(i2c)->stats;
+}
+
+size_t i2c_fila_relatorio(char *buf, size_t cap) {
+    size_t len = snprintf(buf, cap, "{\"barramentos\":[");
+    bool primeiro = true;
+    for (int i = 0; i < 2 && len < cap; i++) {
+        const barramento_t *b = &barramentos[i];
+        if (!b->ativo) {
+            continue;
+        }
+        i2c_fila_stats_t s;
+        uint32_t estado = save_and_disable_interrupts();
+        s = b->stats;
+        uint32_t n_fila = b->n_fila;
+        restore_interrupts(estado);
+
+        uint64_t decorrido = time_us_64() - b->inicio_us;
+        len += snprintf(buf + len, cap - len,
+                        "%s{\"i2c\":%d,\"transacoes\":%lu,\"erros\":%lu,\"bytes\":%lu,\"utilizacao\":%.4f,"
+                        "\"espera_media_us\":%lu,\"espera_max_us\":%lu,\"fila\":%lu,\"fila_max\":%lu,\"recuperacoes\":%lu}",
+                        primeiro ? "" : ",", i, (unsigned long)s.transacoes, (unsigned long)s.erros,
+                        (unsigned long)s.bytes, decorrido ? (double)s.ocupado_us / decorrido : 0.0,
+                        (unsigned long)(s.transacoes ? s.espera_soma_us / s.transacoes : 0),
+                        (unsigned long)s.espera_max_us, (unsigned long)n_fila, (unsigned long)s.fila_max,
+                        (unsigned long)s.recuperacoes);
+        primeiro = false;
+    }
+    if (len < cap) {
+        len += snprintf(buf + len, cap - len, "]}");
+    }
+    return len < cap ? len : cap - 1;
+}
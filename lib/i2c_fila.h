@@ -0,0 +1,102 @@
+#ifndef I2C_FILA_H
+#define I2C_FILA_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "hardware/i2c.h"
+
+// Fila de transações I2C por controlador, executadas por DMA e pela interrupção do I2C.
+// Os dois controladores trabalham em paralelo e a CPU fica livre durante as transferências.
+// Uma transação que passa do prazo é abortada; se nem o abort termina (SDA ou SCL presos por um
+// escravo), o barramento é recuperado com pulsos em SCL e um STOP gerados por GPIO.
+
+#define I2C_FILA_TAMANHO 16       // Transações enfileiradas por controlador
+#define I2C_FILA_MAX_PALAVRAS 192 // Bytes por transação (cabeçalho + escrita + leitura)
+
+// Prazo de uma operação bloqueante de n bytes (i2c_*_timeout_us na inicialização): 400 kHz dão ~23 µs
+// por byte; a folga cobre clock stretching e a troca de endereço
+#define I2C_PRAZO_US(n) (1000u + 100u * (n))
+
+// Prioridades (maior é atendida primeiro; mesma prioridade em ordem de chegada)
+#define I2C_PRIORIDADE_BAIXA 0
+#define I2C_PRIORIDADE_NORMAL 1
+#define I2C_PRIORIDADE_ALTA 2
+
+typedef enum {
+    I2C_TRANS_LIVRE,
+    I2C_TRANS_NA_FILA,
+    I2C_TRANS_EM_CURSO,
+    I2C_TRANS_OK,
+    I2C_TRANS_ERRO // NACK/abort ou tempo esgotado
+} i2c_trans_estado_t;
+
+typedef struct i2c_transacao i2c_transacao_t;
+
+// Chamada na interrupção do I2C ao fim da transação (deve ser curta). Também as transações encerradas fora
+// dela (prazo esgotado na fila, i2c_fila_recuperar) têm o callback chamado pela interrupção, logo depois.
+typedef void (*i2c_trans_cb_t)(i2c_transacao_t *t);
+
+// Transação: escreve cabecalho + tx e, se n_rx > 0, lê n_rx bytes após um RESTART.
+// A memória da transação e dos buffers pertence a quem enfileira e deve existir até o fim.
+struct i2c_transacao {
+    uint8_t endereco;
+    uint8_t prioridade;
+    uint8_t cabecalho[2]; // Registrador ou byte de controle antes dos dados
+    uint8_t n_cabecalho;
+    const uint8_t *tx;
+    uint16_t n_tx;
+    uint8_t *rx;
+    uint16_t n_rx;
+    i2c_trans_cb_t callback;
+    void *usuario;
+
+    volatile i2c_trans_estado_t estado;
+    uint32_t enfileirada_us, inicio_us, fim_us;
+};
+
+typedef struct {
+    uint32_t transacoes;
+    uint32_t erros;
+    uint32_t bytes;
+    uint64_t ocupado_us;     // Tempo com o barramento em uso
+    uint64_t espera_soma_us; // Tempo na fila antes de iniciar
+    uint32_t espera_max_us;
+    uint32_t fila_max;       // Maior ocupação da fila
+    uint32_t recuperacoes;   // Barramento destravado por i2c_fila_recuperar
+} i2c_fila_stats_t;
+
+// Assume o controlador (já inicializado com i2c_init) e reserva os canais de DMA
+void i2c_fila_init(i2c_inst_t *i2c);
+
+bool i2c_fila_ativa(i2c_inst_t *i2c);
+
+// Pinos e velocidade do controlador, usados para recuperar o barramento (sem isso não há recuperação)
+void i2c_fila_pinos(i2c_inst_t *i2c, uint sda, uint scl, uint baudrate);
+
+// Encerra com erro a transação em curso e as da fila, libera o barramento (até 9 pulsos em SCL até o
+// escravo soltar SDA, seguidos de um STOP) e reinicia o controlador. Retorna true se SDA ficou livre.
+bool i2c_fila_recuperar(i2c_inst_t *i2c);
+
+// Enfileira a transação; retorna false se a fila estiver cheia ou a transação for grande demais
+bool i2c_fila_enviar(i2c_inst_t *i2c, i2c_transacao_t *t);
+
+// Aguarda (com WFE) o fim da transação; retorna true se concluiu sem erro.
+// Se o prazo passar e o abort não concluir a transação, recupera o barramento.
+bool i2c_fila_aguardar(i2c_transacao_t *t, uint32_t timeout_us);
+
+static inline bool i2c_fila_concluida(const i2c_transacao_t *t) {
+    return t->estado == I2C_TRANS_OK || t->estado == I2C_TRANS_ERRO || t->estado == I2C_TRANS_LIVRE;
+}
+
+// Transação pronta para ser reutilizada (nunca enviada ou já concluída)
+static inline bool i2c_fila_livre(const i2c_transacao_t *t) {
+    return i2c_fila_concluida(t);
+}
+
+const i2c_fila_stats_t *i2c_fila_stats(i2c_inst_t *i2c);
+
+// Gera um JSON com a utilização e as esperas de cada barramento
+size_t i2c_fila_relatorio(char *buf, size_t cap);
+
+#endif // I2C_FILA_H
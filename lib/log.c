@@ -0,0 +1,84 @@
+#include <stdio.h>
+#include "pico/stdlib.h"
+#include "hardware/sync.h"
+#include "log.h"
+
+#if (LOG_BUFFER_PALAVRAS & (LOG_BUFFER_PALAVRAS - 1)) != 0
+#error "LOG_BUFFER_PALAVRAS deve ser potência de 2"
+#endif
+
+// Registro no buffer: [id | n << 8] [tempo_us] [arg0] ... [argN-1]
+static uint32_t buffer_log[LOG_BUFFER_PALAVRAS];
+static volatile uint32_t escrita = 0; // Palavras já escritas (só o produtor avança)
+static volatile uint32_t leitura = 0; // Palavras já enviadas (só log_descarregar avança)
+static volatile uint32_t descartadas = 0;
+
+static const char hex[] = "0123456789abcdef";
+
+void __not_in_flash_func(log_registrar)(log_id_t id, const uint32_t *args, uint32_t n) {
+    if (n > LOG_ARGS_MAX) {
+        n = LOG_ARGS_MAX;
+    }
+    uint32_t tempo = time_us_32();
+
+    // Interrupções desligadas só durante a cópia de poucas palavras (IRQs também registram)
+    uint32_t estado = save_and_disable_interrupts();
+    uint32_t w = escrita;
+    if (LOG_BUFFER_PALAVRAS - (w - leitura) < n + 2) {
+        descartadas++;
+        restore_interrupts(estado);
+        return;
+    }
+    buffer_log[w++ & (LOG_BUFFER_PALAVRAS - 1)] = id | (n << 8);
+    buffer_log[w++ & (LOG_BUFFER_PALAVRAS - 1)] = tempo;
+    for (uint32_t i = 0; i < n; i++) {
+        buffer_log[w++ & (LOG_BUFFER_PALAVRAS - 1)] = args[i];
+    }
+    escrita = w;
+    restore_interrupts(estado);
+}
+
+// Escreve um registro como linha "@L" + palavras em hexadecimal
+static void enviar_registro(const uint32_t *palavras, uint32_t n) {
+    char linha[sizeof(LOG_PREFIXO) + (LOG_ARGS_MAX + 2) * 8 + 1];
+    char *p = linha;
+    for (const char *s = LOG_PREFIXO; *s; s++) {
+        *p++ = *s;
+    }
+    for (uint32_t i = 0; i < n; i++) {
+        for (int d = 28; d >= 0; d -= 4) {
+            *p++ = hex[(palavras[i] >> d) & 0xF];
+        }
+    }
+    *p++ = '\n';
+    *p = '\0';
+    fputs(linha, stdout);
+}
+
+void log_descarregar(void) {
+    uint32_t palavras[LOG_ARGS_MAX + 2];
+
+    uint32_t fim = escrita;
+    uint32_t r = leitura;
+    while (r != fim) {
+        uint32_t cab = buffer_log[r & (LOG_BUFFER_PALAVRAS - 1)];
+        uint32_t n = (cab >> 8) & 0xFF;
+        for (uint32_t i = 0; i < n + 2; i++) {
+            palavras[i] = buffer_log[(r + i) & (LOG_BUFFER_PALAVRAS - 1)];
+        }
+        r += n + 2;
+        leitura = r; // Libera o espaço antes de bloquear na USB
+        enviar_registro(palavras, n + 2);
+    }
+
+    // Aviso de perda depois das mensagens que chegaram a ser gravadas
+    if (descartadas) {
+        uint32_t estado = save_and_disable_interrupts();
+        palavras[2] = descartadas;
+        descartadas = 0;
+        restore_interrupts(estado);
+        palavras[0] = LOG_DESCARTADAS | (1 << 8);
+        palavras[1] = time_us_32();
+        enviar_registro(palavras, 3);
+    }
+}
@@ -0,0 +1,68 @@
+#ifndef LOG_H
+#define LOG_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Níveis de log
+#define LOG_NIVEL_ERRO  1
+#define LOG_NIVEL_AVISO 2
+#define LOG_NIVEL_INFO  3
+#define LOG_NIVEL_DEBUG 4
+
+// Nível máximo compilado no firmware (mensagens acima dele não geram código)
+#ifndef LOG_NIVEL
+#define LOG_NIVEL LOG_NIVEL_INFO
+#endif
+
+// Tamanho do buffer circular em palavras de 32 bits (potência de 2)
+#ifndef LOG_BUFFER_PALAVRAS
+#define LOG_BUFFER_PALAVRAS 512
+#endif
+
+#define LOG_ARGS_MAX 8
+
+// Prefixo das linhas de log na saída USB (o resto da saída passa intacto pelo decodificador)
+#define LOG_PREFIXO "@L"
+
+// Identificadores das mensagens
+typedef enum {
+#define LOG_FMT(id, nivel, fmt) id,
+#include "log_formatos.h"
+#undef LOG_FMT
+    LOG_N
+} log_id_t;
+
+// Nível de cada mensagem (id##_NIVEL)
+enum {
+#define LOG_FMT(id, nivel, fmt) id##_NIVEL = LOG_NIVEL_##nivel,
+#include "log_formatos.h"
+#undef LOG_FMT
+};
+
+// Conversão dos argumentos para palavras de 32 bits
+static inline uint32_t log_f(float v) {
+    union { float f; uint32_t u; } c = { .f = v };
+    return c.u;
+}
+
+static inline uint32_t log_i(int32_t v) {
+    return (uint32_t)v;
+}
+
+// Grava a mensagem no buffer (seguro para IRQ)
+void log_registrar(log_id_t id, const uint32_t *args, uint32_t n);
+
+// Uso: LOG(LOG_BMP280, log_f(a), log_f(b), log_f(c));
+// O nível vem da tabela e é comparado em tempo de compilação
+#define LOG(id, ...) do { \
+        if (id##_NIVEL <= LOG_NIVEL) { \
+            const uint32_t _args[] = { 0, ##__VA_ARGS__ }; \
+            log_registrar((id), _args + 1, sizeof(_args) / sizeof(_args[0]) - 1); \
+        } \
+    } while (0)
+
+// Envia as mensagens pendentes pela saída padrão (chamar no tempo ocioso)
+void log_descarregar(void);
+
+#endif // LOG_H
@@ -0,0 +1,19 @@
+// Tabela de mensagens do log binário
+//
+// Cada linha define LOG_FMT(identificador, nível, formato). O firmware grava apenas o
+// identificador e os argumentos brutos (32 bits cada); o texto só existe no decodificador
+// do host (tools/decodificar_log.c), que inclui esta mesma tabela.
+// Argumentos: %f/%e/%g são float, %d/%i são int32, %u/%x/%c são uint32.
+// Novas mensagens devem ser adicionadas no final para manter os identificadores estáveis.
+
+LOG_FMT(LOG_DESCARTADAS, AVISO, "%u mensagens de log descartadas (buffer cheio)")
+LOG_FMT(LOG_BMP280, INFO, "Pressao = %.3f kPa\nTemperatura BMP: = %.2f C")
+LOG_FMT(LOG_AHT20, INFO, "Temperatura AHT: %.2f C\nUmidade: %.2f %%\n\n")
+LOG_FMT(LOG_AHT20_ERRO, ERRO, "Erro na leitura do AHT10!\n\n")
+LOG_FMT(LOG_HTTP_DADOS, DEBUG, "[DEBUG] JSON: {\"tem\":%.1f,\"pre\":%.2f,\"alt\":%.0f,\"umi\":%.1f}")
+LOG_FMT(LOG_ALERTA, AVISO, "Alerta %u: ativo=%u valor=%.3f")
+LOG_FMT(LOG_SENSOR_SAUDE, AVISO, "Sensor %u: saude %u, %u falhas seguidas, nova tentativa em %u ms")
+LOG_FMT(LOG_VIGIA_PARADA, ERRO, "Watchdog: atividade %u sem sinal ha %u ms, reiniciando")
+LOG_FMT(LOG_VIGIA_RECUPERADO, AVISO, "Watchdog: recuperado em %u ms (%u ms ate o reinicio)")
+LOG_FMT(LOG_BOOT_MARCO, INFO, "Boot: marco %u em %u ms")
+LOG_FMT(LOG_ALARME_ESGOTADO, AVISO, "Sem alarme livre: conversao aguardada na tarefa (%u ms)")
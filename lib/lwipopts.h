@@ -39,9 +39,9 @@
 #define LWIP_NETIF_LINK_CALLBACK    1
 #define LWIP_NETIF_HOSTNAME         1
 #define LWIP_NETCONN                0
-#define MEM_STATS                   0
-#define SYS_STATS                   0
-#define MEMP_STATS                  0
+#define MEM_STATS                   1 // MODIFICADO (exportado em /metrics)
+#define SYS_STATS                   0 // NO_SYS: sem semáforos nem mutexes para contar
+#define MEMP_STATS                  1 // MODIFICADO (exportado em /metrics)
 #define LINK_STATS                  0
 // #define ETH_PAD_SIZE                2
 #define LWIP_CHKSUM_ALGORITHM       3
@@ -55,9 +55,11 @@
 #define DHCP_DOES_ARP_CHECK         0
 #define LWIP_DHCP_DOES_ACD_CHECK    0
 
+// Estatísticas também no build Release: sem LWIP_STATS o opt.h desliga MEM_STATS e MEMP_STATS
+#define LWIP_STATS                  1
+
 #ifndef NDEBUG
 #define LWIP_DEBUG                  1
-#define LWIP_STATS                  1
 #define LWIP_STATS_DISPLAY          1
 #endif
 
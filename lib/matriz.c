@@ -0,0 +1,83 @@
+#include "pico/stdlib.h"
+#include "hardware/pio.h"
+#include "hardware/dma.h"
+#include "ws2812.pio.h"
+#include "matriz.h"
+#include "memoria.h"
+
+static PIO matriz_pio;
+static uint matriz_sm;
+static int dma_matriz = -1;
+
+static const matriz_padrao_t *atual = NULL;
+static volatile uint8_t quadro_atual = 0;
+static alarm_id_t alarme_animacao = 0;
+static volatile uint64_t envio_us = 0; // Início da última transmissão
+static volatile uint32_t quadros_enviados = 0;
+
+static const matriz_quadro_t quadro_apagado = {0};
+
+// Dispara a DMA de um quadro (75 bytes em 25 palavras direto para a FIFO do PIO)
+static void __not_in_flash_func(enviar)(const matriz_quadro_t *q) {
+    envio_us = time_us_64();
+    dma_channel_transfer_from_buffer_now(dma_matriz, *q, MATRIZ_LEDS);
+    quadros_enviados++;
+}
+
+// Próximo quadro da animação (contexto de interrupção do alarme)
+static int64_t __not_in_flash_func(avancar)(alarm_id_t id, void *user_data) {
+    MEMORIA_SONDA_IRQ();
+    const matriz_padrao_t *p = atual;
+    if (!p || p->n_quadros < 2) {
+        return 0;
+    }
+    // Intervalo >> MATRIZ_QUADRO_US: o quadro anterior já terminou; se não, pula este passo
+    if (!dma_channel_is_busy(dma_matriz)) {
+        quadro_atual = (uint8_t)((quadro_atual + 1) % p->n_quadros);
+        enviar(&p->quadros[quadro_atual]);
+    }
+    return (int64_t)p->intervalo_ms * 1000;
+}
+
+void matriz_init(PIO pio, uint pino) {
+    matriz_pio = pio;
+    matriz_sm = pio_claim_unused_sm(pio, true);
+    uint offset = pio_add_program(pio, &ws2818b_program);
+    ws2818b_program_init(pio, matriz_sm, offset, pino, 800000);
+
+    dma_matriz = dma_claim_unused_channel(true);
+    dma_channel_config c = dma_channel_get_default_config(dma_matriz);
+    channel_config_set_transfer_data_size(&c, DMA_SIZE_32);
+    channel_config_set_read_increment(&c, true);
+    channel_config_set_write_increment(&c, false);
+    channel_config_set_dreq(&c, pio_get_dreq(pio, matriz_sm, true));
+    dma_channel_configure(dma_matriz, &c, &pio->txf[matriz_sm], quadro_apagado, MATRIZ_LEDS, false);
+
+    enviar(&quadro_apagado); // Limpa a matriz
+}
+
+void matriz_mostrar(const matriz_padrao_t *padrao) {
+    if (padrao == atual || dma_matriz < 0) {
+        return;
+    }
+    if (alarme_animacao > 0) {
+        cancel_alarm(alarme_animacao);
+        alarme_animacao = 0;
+    }
+    atual = padrao;
+    quadro_atual = 0;
+
+    // Entre dois quadros a linha precisa ficar em nível baixo pelo tempo de reset (só em trocas muito próximas)
+    while (time_us_64() - envio_us < MATRIZ_QUADRO_US) {
+        tight_loop_contents();
+    }
+    enviar(padrao ? &padrao->quadros[0] : &quadro_apagado);
+
+    if (padrao && padrao->n_quadros > 1) {
+        alarme_animacao = add_alarm_in_ms(padrao->intervalo_ms, avancar, NULL, true);
+    }
+}
+
+uint32_t matriz_quadros_enviados(void) {
+    return quadros_enviados;
+}
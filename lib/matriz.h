@@ -0,0 +1,48 @@
+#ifndef MATRIZ_H
+#define MATRIZ_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "hardware/pio.h"
+
+// Matriz 5x5 de WS2812 alimentada por DMA: os quadros são tabelas constantes já na ordem do fio
+// (uma palavra GRB por LED) e só são transmitidos quando o padrão muda ou a animação avança.
+
+#define MATRIZ_LEDS 25
+#define MATRIZ_QUADRO_US (MATRIZ_LEDS * 24 * 5 / 4 + 300) // Transmissão + reset (> 280 us em nível baixo)
+
+// Palavra de um LED: o programa ws2818b desloca para a direita, 24 bits por palavra (G, R e B nessa ordem)
+#define MATRIZ_GRB(r, g, b) ((uint32_t)(g) | (uint32_t)(r) << 8 | (uint32_t)(b) << 16)
+
+// Quadro escrito como é visto (linha 0 no topo, coluna 0 à esquerda) e reordenado para a ordem do fio:
+// o primeiro LED da cadeia é o canto inferior direito e as linhas alternam o sentido (serpentina)
+#define MATRIZ_QUADRO(a00, a01, a02, a03, a04, \
+                      a10, a11, a12, a13, a14, \
+                      a20, a21, a22, a23, a24, \
+                      a30, a31, a32, a33, a34, \
+                      a40, a41, a42, a43, a44) \
+    { a44, a43, a42, a41, a40, \
+      a30, a31, a32, a33, a34, \
+      a24, a23, a22, a21, a20, \
+      a10, a11, a12, a13, a14, \
+      a04, a03, a02, a01, a00 }
+
+typedef uint32_t matriz_quadro_t[MATRIZ_LEDS];
+
+// Padrão: um quadro fixo (n_quadros = 1) ou uma animação em laço
+typedef struct {
+    const matriz_quadro_t *quadros;
+    uint8_t n_quadros;
+    uint16_t intervalo_ms; // Tempo de cada quadro da animação (bem maior que MATRIZ_QUADRO_US)
+} matriz_padrao_t;
+
+// Carrega o programa ws2818b numa state machine livre do PIO e reserva um canal de DMA
+void matriz_init(PIO pio, uint pino);
+
+// Mostra um padrão (sem efeito se já é o atual); animações avançam por alarme, sem a CPU principal
+void matriz_mostrar(const matriz_padrao_t *padrao);
+
+// Quadros transmitidos desde o início
+uint32_t matriz_quadros_enviados(void);
+
+#endif // MATRIZ_H
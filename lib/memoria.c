@@ -0,0 +1,125 @@
+#include <stdio.h>
+#include <malloc.h>
+#include "pico/stdlib.h"
+#include "lwip/stats.h"
+#include "lwip/memp.h"
+#include "memoria.h"
+
+// Símbolos do linker script do SDK (memmap_default.ld)
+extern uint32_t __StackBottom, __StackTop, __StackOneBottom, __StackOneTop;
+extern char __end__, __StackLimit;
+extern char __data_start__, __data_end__, __bss_start__, __bss_end__;
+
+volatile uint32_t memoria_sp_irq_min[2] = { UINT32_MAX, UINT32_MAX };
+
+static uint32_t heap_usado_max, heap_arena_max;
+
+#if MEMP_STATS
+static const char *const nomes_pools[] = {
+#define LWIP_MEMPOOL(name, num, size, desc) #name,
+#include "lwip/priv/memp_std.h"
+};
+#endif
+
+static void pintar(uint32_t *inicio, uint32_t *fim) {
+    for (uint32_t *p = inicio; p < fim; p++) {
+        *p = MEMORIA_PINTURA;
+    }
+}
+
+void memoria_iniciar(void) {
+    // Núcleo 0: da base da reserva até um pouco abaixo do SP atual (o quadro desta função fica intacto)
+    uint32_t sp;
+    __asm volatile("mov %0, sp" : "=r"(sp));
+    pintar(&__StackBottom, (uint32_t *)(uintptr_t)(sp - 64));
+    // Núcleo 1: a pilha inteira (ainda não iniciado)
+    pintar(&__StackOneBottom, &__StackOneTop);
+    memoria_amostrar();
+}
+
+void memoria_amostrar(void) {
+    struct mallinfo mi = mallinfo();
+    if ((uint32_t)mi.uordblks > heap_usado_max) {
+        heap_usado_max = mi.uordblks;
+    }
+    if ((uint32_t)mi.arena > heap_arena_max) {
+        heap_arena_max = mi.arena;
+    }
+}
+
+memoria_pilha_t memoria_pilha(int nucleo) {
+    uint32_t *base = nucleo ? &__StackOneBottom : &__StackBottom;
+    uint32_t *topo = nucleo ? &__StackOneTop : &__StackTop;
+    const uint32_t *p = base;
+    while (p < topo && *p == MEMORIA_PINTURA) {
+        p++;
+    }
+    memoria_pilha_t r = {
+        .total = (uint32_t)((char *)topo - (char *)base),
+        .pico = (uint32_t)((char *)topo - (char *)p),
+        .transbordou = *base != MEMORIA_PINTURA,
+    };
+    uint32_t sp_irq = memoria_sp_irq_min[nucleo];
+    if (sp_irq <= (uintptr_t)topo) {
+        r.pico_irq = (uint32_t)((uintptr_t)topo - sp_irq);
+    }
+    return r;
+}
+
+memoria_heap_t memoria_heap(void) {
+    memoria_amostrar();
+    return (memoria_heap_t){
+        .total = (uint32_t)(&__StackLimit - &__end__),
+        .usado = mallinfo().uordblks,
+        .usado_max = heap_usado_max,
+        .arena_max = heap_arena_max,
+    };
+}
+
+size_t memoria_relatorio(char *buf, size_t cap) {
+    size_t len = 0;
+#define ESCREVER(...)                                              \
+    do {                                                           \
+        if (len < cap) {                                           \
+            len += snprintf(buf + len, cap - len, __VA_ARGS__);    \
+        }                                                          \
+    } while (0)
+
+    ESCREVER("{\"pilhas\":[");
+    for (int n = 0; n < 2; n++) {
+        memoria_pilha_t p = memoria_pilha(n);
+        ESCREVER("%s{\"nucleo\":%d,\"total\":%lu,\"pico\":%lu,\"pico_irq\":%lu,\"transbordou\":%s}", n ? "," : "", n,
+                 (unsigned long)p.total, (unsigned long)p.pico, (unsigned long)p.pico_irq,
+                 p.transbordou ? "true" : "false");
+    }
+
+    memoria_heap_t h = memoria_heap();
+    ESCREVER("],\"heap\":{\"total\":%lu,\"usado\":%lu,\"usado_max\":%lu,\"arena_max\":%lu}", (unsigned long)h.total,
+             (unsigned long)h.usado, (unsigned long)h.usado_max, (unsigned long)h.arena_max);
+
+    ESCREVER(",\"estatica\":{\"data\":%lu,\"bss\":%lu}", (unsigned long)(&__data_end__ - &__data_start__),
+             (unsigned long)(&__bss_end__ - &__bss_start__));
+
+#if MEM_STATS
+    ESCREVER(",\"lwip_mem\":{\"total\":%lu,\"usado\":%lu,\"max\":%lu,\"falhas\":%lu}", (unsigned long)lwip_stats.mem.avail,
+             (unsigned long)lwip_stats.mem.used, (unsigned long)lwip_stats.mem.max, (unsigned long)lwip_stats.mem.err);
+#endif
+#if MEMP_STATS
+    ESCREVER(",\"lwip_pools\":{");
+    for (int i = 0; i < MEMP_MAX; i++) {
+        const struct stats_mem *p = lwip_stats.memp[i];
+        ESCREVER("%s\"%s\":{\"total\":%lu,\"usado\":%lu,\"max\":%lu,\"falhas\":%lu}", i ? "," : "", nomes_pools[i],
+                 (unsigned long)p->avail, (unsigned long)p->used, (unsigned long)p->max, (unsigned long)p->err);
+    }
+    ESCREVER("}");
+#endif
+    ESCREVER("}");
+#undef ESCREVER
+    return len < cap ? len : cap - 1;
+}
+
+void memoria_imprimir(void) {
+    static char buf[2048]; // Fora da pilha que está sendo medida
+    memoria_relatorio(buf, sizeof(buf));
+    printf("%s\n", buf);
+}
@@ -0,0 +1,59 @@
+#ifndef MEMORIA_H
+#define MEMORIA_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "pico/stdlib.h"
+
+// Orçamento de memória: pilhas dos dois núcleos (pintura), heap do malloc (pico de uso e da área
+// obtida com sbrk), heap e pools do lwIP e tamanho das seções estáticas.
+// As IRQs do RP2040 usam a pilha MSP do núcleo interrompido; MEMORIA_SONDA_IRQ() na entrada dos
+// tratadores registra o menor SP visto em IRQ, separando a profundidade alcançada com IRQ ativa.
+
+#define MEMORIA_PINTURA 0xA5A5A5A5u // Padrão das palavras de pilha nunca usadas
+
+typedef struct {
+    uint32_t total;      // Bytes reservados pelo linker
+    uint32_t pico;       // Maior profundidade medida pela pintura
+    uint32_t pico_irq;   // Profundidade no ponto mais fundo em que uma IRQ começou (0 = nenhuma sondada)
+    bool transbordou;    // A palavra do fundo foi alterada: a pilha passou da reserva
+} memoria_pilha_t;
+
+typedef struct {
+    uint32_t total;      // __end__ até __StackLimit
+    uint32_t usado;      // Em uso agora (mallinfo uordblks)
+    uint32_t usado_max;  // Maior uso visto por memoria_amostrar
+    uint32_t arena_max;  // Maior área obtida com sbrk (o heap do newlib praticamente não devolve memória)
+} memoria_heap_t;
+
+extern volatile uint32_t memoria_sp_irq_min[2];
+
+// SP atual (registrado pela sonda; custo de poucas instruções)
+#define MEMORIA_SONDA_IRQ()                                                  \
+    do {                                                                     \
+        uint32_t sp_;                                                        \
+        __asm volatile("mov %0, sp" : "=r"(sp_));                            \
+        uint32_t nucleo_ = get_core_num();                                   \
+        if (sp_ < memoria_sp_irq_min[nucleo_]) {                             \
+            memoria_sp_irq_min[nucleo_] = sp_;                               \
+        }                                                                    \
+    } while (0)
+
+// Pinta as pilhas livres: deve ser a primeira chamada do main (antes de iniciar o núcleo 1)
+void memoria_iniciar(void);
+
+// Atualiza os picos do heap (chamar periodicamente; o malloc não é instrumentado)
+void memoria_amostrar(void);
+
+// Pilha do núcleo 0 ou 1 (varre a região pintada)
+memoria_pilha_t memoria_pilha(int nucleo);
+
+memoria_heap_t memoria_heap(void);
+
+// JSON com pilhas, heap, lwIP e seções estáticas
+size_t memoria_relatorio(char *buf, size_t cap);
+
+// Mesmo relatório na saída padrão (USB)
+void memoria_imprimir(void);
+
+#endif // MEMORIA_H
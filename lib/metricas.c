@@ -0,0 +1,162 @@
+#include <stdio.h>
+#include <stdarg.h>
+#include "pico/stdlib.h"
+#include "lwip/stats.h"
+#include "lwip/memp.h"
+#include "metricas.h"
+#include "i2c_fila.h"
+#include "servidor_http.h"
+#include "memoria.h"
+
+uint32_t metricas_contadores[MC_N];
+metricas_hist_t metricas_hist[MH_N];
+
+static const char *const nomes_contadores[MC_N] = {
+    [MC_HTTP_REQUISICOES] = "estacao_http_requisicoes",
+    [MC_AHT20_FALHAS] = "estacao_aht20_falhas",
+};
+
+static const char *const nomes_hist[MH_N] = {
+    [MH_LOOP] = "estacao_loop_periodo_microseconds",
+    [MH_BMP280_LEITURA] = "estacao_bmp280_leitura_microseconds",
+    [MH_AHT20_LEITURA] = "estacao_aht20_leitura_microseconds",
+    [MH_SSD1306_ENVIO] = "estacao_ssd1306_envio_microseconds",
+    [MH_HTTP] = "estacao_http_tratamento_microseconds",
+};
+
+#if MEMP_STATS
+// Nomes dos pools do lwIP (mesma ordem do enum memp_t)
+static const char *const nomes_pools[] = {
+#define LWIP_MEMPOOL(name, num, size, desc) #name,
+#include "lwip/priv/memp_std.h"
+};
+#endif
+
+// Acumula texto em buf sem ultrapassar cap
+typedef struct {
+    char *buf;
+    size_t cap, len;
+} saida_t;
+
+static void escrever(saida_t *s, const char *fmt, ...) {
+    if (s->len + 1 >= s->cap) {
+        return;
+    }
+    va_list args;
+    va_start(args, fmt);
+    int n = vsnprintf(s->buf + s->len, s->cap - s->len, fmt, args);
+    va_end(args);
+    if (n > 0) {
+        s->len += (size_t)n < s->cap - s->len ? (size_t)n : s->cap - s->len - 1;
+    }
+}
+
+static void gauge(saida_t *s, const char *nome, const char *rotulos, uint32_t valor) {
+    escrever(s, "%s%s %lu\n", nome, rotulos, (unsigned long)valor);
+}
+
+size_t metricas_renderizar(char *buf, size_t cap) {
+    saida_t s = { buf, cap, 0 };
+    if (cap > 0) {
+        buf[0] = '\0';
+    }
+
+    for (int i = 0; i < MC_N; i++) {
+        escrever(&s, "# TYPE %s counter\n%s_total %lu\n", nomes_contadores[i], nomes_contadores[i],
+                 (unsigned long)metricas_contadores[i]);
+    }
+
+    for (int h = 0; h < MH_N; h++) {
+        // Cópia local para que o recorte não mude durante a exportação
+        metricas_hist_t m = metricas_hist[h];
+        escrever(&s, "# TYPE %s histogram\n", nomes_hist[h]);
+        uint32_t acumulado = 0;
+        uint32_t le = 1;
+        for (int b = 0; b < METRICAS_BALDES - 1; b++, le *= 4) {
+            acumulado += m.baldes[b];
+            escrever(&s, "%s_bucket{le=\"%lu\"} %lu\n", nomes_hist[h], (unsigned long)le, (unsigned long)acumulado);
+        }
+        acumulado += m.baldes[METRICAS_BALDES - 1];
+        escrever(&s, "%s_bucket{le=\"+Inf\"} %lu\n", nomes_hist[h], (unsigned long)acumulado);
+        escrever(&s, "%s_sum %llu\n%s_count %lu\n", nomes_hist[h], (unsigned long long)m.soma, nomes_hist[h],
+                 (unsigned long)m.n);
+    }
+
+    // Conexões do servidor HTTP
+    const servidor_http_stats_t *http = servidor_http_stats();
+    static const char *const contadores_http[] = {
+        "estacao_http_sem_memoria", "estacao_http_recusadas", "estacao_http_abortadas", "estacao_http_expiradas",
+    };
+    const uint32_t valores_http[] = { http->sem_memoria, http->recusadas, http->abortadas, http->expiradas };
+    for (int c = 0; c < 4; c++) {
+        escrever(&s, "# TYPE %s counter\n%s_total %lu\n", contadores_http[c], contadores_http[c],
+                 (unsigned long)valores_http[c]);
+    }
+    escrever(&s, "# TYPE estacao_http_conexoes gauge\n");
+    gauge(&s, "estacao_http_conexoes", "{tipo=\"ativas\"}", http->ativas);
+    gauge(&s, "estacao_http_conexoes", "{tipo=\"max\"}", http->ativas_max);
+
+    escrever(&s, "# TYPE estacao_uptime_seconds gauge\n");
+    gauge(&s, "estacao_uptime_seconds", "", to_ms_since_boot(get_absolute_time()) / 1000);
+
+    memoria_heap_t heap = memoria_heap();
+    escrever(&s, "# TYPE estacao_heap_bytes gauge\n");
+    gauge(&s, "estacao_heap_bytes", "{tipo=\"usado\"}", heap.usado);
+    gauge(&s, "estacao_heap_bytes", "{tipo=\"max\"}", heap.usado_max);
+    gauge(&s, "estacao_heap_bytes", "{tipo=\"arena\"}", heap.arena_max);
+    gauge(&s, "estacao_heap_bytes", "{tipo=\"total\"}", heap.total);
+
+    escrever(&s, "# TYPE estacao_pilha_bytes gauge\n");
+    for (int n = 0; n < 2; n++) {
+        memoria_pilha_t p = memoria_pilha(n);
+        escrever(&s, "estacao_pilha_bytes{nucleo=\"%d\",tipo=\"pico\"} %lu\n", n, (unsigned long)p.pico);
+        escrever(&s, "estacao_pilha_bytes{nucleo=\"%d\",tipo=\"pico_irq\"} %lu\n", n, (unsigned long)p.pico_irq);
+        escrever(&s, "estacao_pilha_bytes{nucleo=\"%d\",tipo=\"total\"} %lu\n", n, (unsigned long)p.total);
+    }
+
+#if MEM_STATS
+    escrever(&s, "# TYPE estacao_lwip_mem_bytes gauge\n");
+    gauge(&s, "estacao_lwip_mem_bytes", "{tipo=\"usado\"}", lwip_stats.mem.used);
+    gauge(&s, "estacao_lwip_mem_bytes", "{tipo=\"max\"}", lwip_stats.mem.max);
+    gauge(&s, "estacao_lwip_mem_bytes", "{tipo=\"total\"}", lwip_stats.mem.avail);
+#endif
+
+#if MEMP_STATS
+    escrever(&s, "# TYPE estacao_lwip_pool gauge\n");
+    for (int i = 0; i < MEMP_MAX; i++) {
+        const struct stats_mem *p = lwip_stats.memp[i];
+        escrever(&s, "estacao_lwip_pool{pool=\"%s\",tipo=\"usado\"} %lu\n", nomes_pools[i], (unsigned long)p->used);
+        escrever(&s, "estacao_lwip_pool{pool=\"%s\",tipo=\"max\"} %lu\n", nomes_pools[i], (unsigned long)p->max);
+        escrever(&s, "estacao_lwip_pool{pool=\"%s\",tipo=\"total\"} %lu\n", nomes_pools[i], (unsigned long)p->avail);
+    }
+#endif
+
+    // Barramentos I2C atendidos pela fila de transações (utilização = ocupado / tempo)
+    static const char *const contadores_i2c[] = {
+        "estacao_i2c_transacoes", "estacao_i2c_erros", "estacao_i2c_ocupado_microseconds", "estacao_i2c_espera_microseconds",
+        "estacao_i2c_recuperacoes",
+    };
+    for (int c = 0; c < (int)(sizeof(contadores_i2c) / sizeof(contadores_i2c[0])); c++) {
+        escrever(&s, "# TYPE %s counter\n", contadores_i2c[c]);
+        for (int i = 0; i < 2; i++) {
+            i2c_inst_t *i2c = i ? i2c1 : i2c0;
+            if (!i2c_fila_ativa(i2c)) {
+                continue;
+            }
+            const i2c_fila_stats_t *b = i2c_fila_stats(i2c);
+            const uint64_t v[] = {b->transacoes, b->erros, b->ocupado_us, b->espera_soma_us, b->recuperacoes};
+            escrever(&s, "%s_total{i2c=\"%d\"} %llu\n", contadores_i2c[c], i, (unsigned long long)v[c]);
+        }
+    }
+    escrever(&s, "# TYPE estacao_i2c_espera_max_microseconds gauge\n");
+    for (int i = 0; i < 2; i++) {
+        i2c_inst_t *i2c = i ? i2c1 : i2c0;
+        if (i2c_fila_ativa(i2c)) {
+            escrever(&s, "estacao_i2c_espera_max_microseconds{i2c=\"%d\"} %lu\n", i,
+                     (unsigned long)i2c_fila_stats(i2c)->espera_max_us);
+        }
+    }
+
+    escrever(&s, "# EOF\n");
+    return s.len;
+}
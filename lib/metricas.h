@@ -0,0 +1,71 @@
+#ifndef METRICAS_H
+#define METRICAS_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "pico/stdlib.h"
+
+// Contadores (exportados com sufixo _total)
+typedef enum {
+    MC_HTTP_REQUISICOES,
+    MC_AHT20_FALHAS,
+    MC_N
+} metrica_contador_t;
+
+// Histogramas de tempo em µs
+typedef enum {
+    MH_LOOP,            // Período real entre amostragens
+    MH_BMP280_LEITURA,  // Transação de leitura do BMP280 no barramento
+    MH_AHT20_LEITURA,   // Transação de leitura do AHT20 (sem o tempo de conversão)
+    MH_SSD1306_ENVIO,   // Envio de um quadro completo ao display
+    MH_HTTP,            // Tratamento de uma requisição em http_recv
+    MH_N
+} metrica_hist_t;
+
+// Baldes em potências de 4: le = 1, 4, 16, ..., 4^10 (~1 s) e +Inf
+#define METRICAS_BALDES 12
+
+typedef struct {
+    uint32_t baldes[METRICAS_BALDES]; // Contagem por balde (não cumulativa)
+    uint64_t soma;
+    uint32_t n;
+} metricas_hist_t;
+
+extern uint32_t metricas_contadores[MC_N];
+extern metricas_hist_t metricas_hist[MH_N];
+
+// Incrementa um contador
+static inline void metricas_contar(metrica_contador_t c) {
+    metricas_contadores[c]++;
+}
+
+// Registra uma duração em µs no histograma (índice do balde por CLZ, sem laço)
+static inline void metricas_observar(metrica_hist_t h, uint32_t us) {
+    uint32_t i = 0;
+    if (us > 1) {
+        uint32_t bits = 32 - __builtin_clz(us - 1); // us <= 2^bits
+        i = (bits + 1) >> 1;                        // us <= 4^i
+        if (i > METRICAS_BALDES - 1) {
+            i = METRICAS_BALDES - 1;
+        }
+    }
+    metricas_hist_t *m = &metricas_hist[h];
+    m->baldes[i]++;
+    m->soma += us;
+    m->n++;
+}
+
+// Marca o início de uma medição
+static inline uint32_t metricas_inicio(void) {
+    return time_us_32();
+}
+
+// Fecha a medição iniciada em t0
+static inline void metricas_fim(metrica_hist_t h, uint32_t t0) {
+    metricas_observar(h, time_us_32() - t0);
+}
+
+// Gera o texto OpenMetrics em buf e retorna o tamanho (truncado em cap - 1)
+size_t metricas_renderizar(char *buf, size_t cap);
+
+#endif // METRICAS_H
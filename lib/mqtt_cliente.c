@@ -0,0 +1,415 @@
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include "pico/stdlib.h"
+#include "pico/cyw43_arch.h"
+#include "lwip/tcp.h"
+#include "mqtt_codec.h"
+#include "mqtt_cliente.h"
+
+#define TOPICO_DADOS "estacao/" MQTT_ESTACAO "/dados"
+#define TOPICO_EVENTOS "estacao/" MQTT_ESTACAO "/eventos"
+#define TOPICO_LIMITES "estacao/" MQTT_ESTACAO "/config/limites"
+#define TOPICO_OFFSETS "estacao/" MQTT_ESTACAO "/config/offsets"
+
+#define MQTT_RX_BUF 512
+#define MQTT_TX_BUF 1536 // Lote de MQTT_LOTE_MAX amostras com folga
+
+typedef enum {
+    MQTT_DESCONECTADO,
+    MQTT_CONECTANDO_TCP,
+    MQTT_AGUARDANDO_CONNACK,
+    MQTT_ATIVO
+} mqtt_estado_t;
+
+typedef struct {
+    uint32_t seq;
+    uint32_t tempo_ms;
+    uint32_t intervalo_ms;
+    float temperatura, umidade, pressao, altitude;
+    float tendencia; // hPa/3 h (NAN = sem histórico)
+    uint8_t zambretti;
+} mqtt_amostra_t;
+
+typedef struct {
+    const char *nome;
+    bool ativo;
+    float valor;
+    uint32_t tempo_ms;
+} mqtt_evento_t;
+
+static mqtt_estado_t estado = MQTT_DESCONECTADO;
+static struct tcp_pcb *pcb_mqtt = NULL;
+static ip_addr_t broker_addr;
+static uint16_t broker_porta;
+static mqtt_cliente_config_cb_t config_cb = NULL;
+static bool iniciado = false; // mqtt_cliente_init já foi chamada (rádio e lwIP prontos)
+
+// Fila circular de amostras (as amostras em voo só saem da fila após o PUBACK)
+static mqtt_amostra_t fila[MQTT_FILA];
+static uint8_t fila_inicio = 0, fila_n = 0;
+static uint32_t seq_amostra = 0;
+
+// Fila de eventos de alerta (QoS 0: saem assim que houver espaço no buffer TCP)
+static mqtt_evento_t eventos[MQTT_EVENTOS];
+static uint8_t eventos_inicio = 0, eventos_n = 0;
+
+// PUBLISH QoS1 aguardando PUBACK
+static uint16_t packet_id = 0;
+static uint16_t em_voo_id = 0;     // 0 = nenhum
+static uint8_t em_voo_n = 0;       // Amostras cobertas pelo PUBLISH em voo
+static uint64_t em_voo_envio_us = 0;
+
+static uint8_t rx_buf[MQTT_RX_BUF];
+static size_t rx_len = 0;
+static uint8_t tx_buf[MQTT_TX_BUF];
+
+static absolute_time_t ultima_tentativa;
+static absolute_time_t ultimo_envio;
+
+static mqtt_cliente_stats_t stats;
+
+static uint16_t proximo_packet_id(void) {
+    if (++packet_id == 0) {
+        packet_id = 1;
+    }
+    return packet_id;
+}
+
+// Envia um pacote já codificado em tx_buf (contexto lwIP)
+static bool enviar(size_t len) {
+    if (!pcb_mqtt || len == 0 || tcp_sndbuf(pcb_mqtt) < len) {
+        return false;
+    }
+    if (tcp_write(pcb_mqtt, tx_buf, len, TCP_WRITE_FLAG_COPY) != ERR_OK) {
+        return false;
+    }
+    tcp_output(pcb_mqtt);
+    ultimo_envio = get_absolute_time();
+    return true;
+}
+
+// Fecha a conexão (abortar = true quando chamado de dentro do tcp_recv com erro de protocolo)
+static void desconectar(bool abortar) {
+    if (pcb_mqtt) {
+        tcp_arg(pcb_mqtt, NULL);
+        tcp_recv(pcb_mqtt, NULL);
+        tcp_err(pcb_mqtt, NULL);
+        if (abortar || tcp_close(pcb_mqtt) != ERR_OK) {
+            tcp_abort(pcb_mqtt);
+        }
+        pcb_mqtt = NULL;
+    }
+    estado = MQTT_DESCONECTADO;
+    em_voo_id = 0; // As amostras continuam na fila e são reenviadas após reconectar
+    em_voo_n = 0;
+    rx_len = 0;
+}
+
+// Remove da fila as amostras confirmadas
+static void confirmar(uint8_t n) {
+    fila_inicio = (fila_inicio + n) % MQTT_FILA;
+    fila_n -= n;
+    stats.amostras += n;
+}
+
+// Monta o payload JSON com as n primeiras amostras da fila (objeto se n == 1, vetor se n > 1)
+static size_t montar_payload(char *buf, size_t cap, uint8_t n) {
+    size_t len = 0;
+    if (n > 1) {
+        buf[len++] = '[';
+    }
+    for (uint8_t i = 0; i < n && len < cap; i++) {
+        const mqtt_amostra_t *a = &fila[(fila_inicio + i) % MQTT_FILA];
+        char tendencia[12] = "null";
+        if (!isnan(a->tendencia)) {
+            snprintf(tendencia, sizeof(tendencia), "%.2f", a->tendencia);
+        }
+        len += snprintf(buf + len, cap - len, "%s{\"seq\":%lu,\"t\":%lu,\"dt\":%lu,\"tem\":%.1f,\"pre\":%.2f,\"alt\":%.0f,\"umi\":%.1f,"
+                        "\"tend\":%s,\"prev\":%u}",
+                        i ? "," : "", (unsigned long)a->seq, (unsigned long)a->tempo_ms, (unsigned long)a->intervalo_ms,
+                        a->temperatura, a->pressao, a->altitude, a->umidade, tendencia, a->zambretti);
+    }
+    if (n > 1 && len < cap) {
+        buf[len++] = ']';
+    }
+    return len < cap ? len : 0;
+}
+
+// Publica as amostras pendentes. Com o link rápido a fila tem uma amostra por vez;
+// quando o PUBACK ou o buffer TCP atrasam, as amostras se acumulam e saem juntas no próximo PUBLISH
+static void publicar_pendentes(bool dup) {
+    uint8_t n = dup ? em_voo_n : (fila_n < MQTT_LOTE_MAX ? fila_n : MQTT_LOTE_MAX);
+    if (n == 0) {
+        return;
+    }
+
+    char payload[MQTT_TX_BUF - 64];
+    size_t payload_len = montar_payload(payload, sizeof(payload), n);
+    uint16_t id = dup ? em_voo_id : (MQTT_QOS ? proximo_packet_id() : 0);
+    size_t len = mqtt_codec_publish(tx_buf, sizeof(tx_buf), TOPICO_DADOS, payload, payload_len, MQTT_QOS, id, dup);
+    if (payload_len == 0 || !enviar(len)) {
+        return; // Tenta novamente no próximo poll
+    }
+
+    if (dup) {
+        stats.retransmissoes++;
+    } else {
+        stats.publicacoes++;
+    }
+    if (MQTT_QOS) {
+        em_voo_id = id;
+        em_voo_n = n;
+        em_voo_envio_us = time_us_64();
+    } else {
+        confirmar(n);
+    }
+}
+
+// Publica os eventos pendentes antes das amostras (transições de alerta são raras e urgentes)
+static void publicar_eventos(void) {
+    while (eventos_n > 0) {
+        const mqtt_evento_t *e = &eventos[eventos_inicio];
+        char payload[128];
+        int payload_len = snprintf(payload, sizeof(payload), "{\"t\":%lu,\"regra\":\"%s\",\"ativo\":%s,\"valor\":%.3f}",
+                                   (unsigned long)e->tempo_ms, e->nome, e->ativo ? "true" : "false", e->valor);
+        size_t len = mqtt_codec_publish(tx_buf, sizeof(tx_buf), TOPICO_EVENTOS, payload, payload_len, 0, 0, false);
+        if (!enviar(len)) {
+            return; // Tenta novamente no próximo poll
+        }
+        eventos_inicio = (eventos_inicio + 1) % MQTT_EVENTOS;
+        eventos_n--;
+    }
+}
+
+static void tratar_pacote(const mqtt_pacote_t *pct) {
+    switch (pct->tipo) {
+    case MQTT_CONNACK:
+        if (pct->codigo != 0) {
+            printf("MQTT: conexao recusada (%d)\n", pct->codigo);
+            desconectar(false);
+            return;
+        }
+        estado = MQTT_ATIVO;
+        {
+            const char *topicos[] = { TOPICO_LIMITES, TOPICO_OFFSETS };
+            enviar(mqtt_codec_subscribe(tx_buf, sizeof(tx_buf), proximo_packet_id(), topicos, 2, 1));
+        }
+        break;
+    case MQTT_PUBACK:
+        if (em_voo_id != 0 && pct->packet_id == em_voo_id) {
+            uint32_t lat = (uint32_t)(time_us_64() - em_voo_envio_us);
+            stats.latencia_ultima_us = lat;
+            if (lat > stats.latencia_max_us) {
+                stats.latencia_max_us = lat;
+            }
+            stats.latencia_soma_us += lat;
+            stats.latencia_n++;
+            confirmar(em_voo_n);
+            em_voo_id = 0;
+            em_voo_n = 0;
+        }
+        break;
+    case MQTT_PUBLISH: {
+        uint8_t qos = (pct->flags >> 1) & 0x03;
+        if (qos == 1) {
+            enviar(mqtt_codec_puback(tx_buf, sizeof(tx_buf), pct->packet_id));
+        }
+        if (config_cb) {
+            char topico[64];
+            char payload[128];
+            size_t tl = pct->topico_len < sizeof(topico) - 1 ? pct->topico_len : sizeof(topico) - 1;
+            size_t pl = pct->payload_len < sizeof(payload) - 1 ? pct->payload_len : sizeof(payload) - 1;
+            memcpy(topico, pct->topico, tl);
+            topico[tl] = '\0';
+            memcpy(payload, pct->payload, pl);
+            payload[pl] = '\0';
+            config_cb(topico, payload);
+        }
+        break;
+    }
+    default:
+        break;
+    }
+}
+
+static err_t mqtt_recv(void *arg, struct tcp_pcb *tpcb, struct pbuf *p, err_t err) {
+    if (!p) {
+        desconectar(false);
+        return ERR_OK;
+    }
+
+    u16_t copiado = 0;
+    while (copiado < p->tot_len) {
+        u16_t espaco = sizeof(rx_buf) - rx_len;
+        if (espaco == 0) {
+            // Pacote maior que o buffer: não há como recuperar o alinhamento do fluxo
+            pbuf_free(p);
+            desconectar(true);
+            return ERR_ABRT;
+        }
+        u16_t n = pbuf_copy_partial(p, rx_buf + rx_len, espaco, copiado);
+        rx_len += n;
+        copiado += n;
+
+        // Processa todos os pacotes completos do buffer
+        for (;;) {
+            mqtt_pacote_t pct;
+            int usados = mqtt_codec_decodificar(rx_buf, rx_len, &pct);
+            if (usados == 0) {
+                break;
+            }
+            if (usados < 0) {
+                pbuf_free(p);
+                desconectar(true);
+                return ERR_ABRT;
+            }
+            tratar_pacote(&pct);
+            if (estado == MQTT_DESCONECTADO) {
+                pbuf_free(p); // Conexão já fechada em tratar_pacote
+                return ERR_OK;
+            }
+            memmove(rx_buf, rx_buf + usados, rx_len - usados);
+            rx_len -= usados;
+        }
+    }
+
+    tcp_recved(tpcb, p->tot_len);
+    pbuf_free(p);
+    return ERR_OK;
+}
+
+static void mqtt_err(void *arg, err_t err) {
+    pcb_mqtt = NULL; // O lwIP já liberou o PCB
+    desconectar(false);
+}
+
+static err_t mqtt_conectado(void *arg, struct tcp_pcb *tpcb, err_t err) {
+    if (err != ERR_OK) {
+        desconectar(false);
+        return ERR_OK;
+    }
+    estado = MQTT_AGUARDANDO_CONNACK;
+    enviar(mqtt_codec_connect(tx_buf, sizeof(tx_buf), "estacao-" MQTT_ESTACAO, MQTT_KEEPALIVE_S));
+    return ERR_OK;
+}
+
+static void conectar(void) {
+    ultima_tentativa = get_absolute_time();
+    pcb_mqtt = tcp_new();
+    if (!pcb_mqtt) {
+        return;
+    }
+    tcp_recv(pcb_mqtt, mqtt_recv);
+    tcp_err(pcb_mqtt, mqtt_err);
+    estado = MQTT_CONECTANDO_TCP;
+    if (tcp_connect(pcb_mqtt, &broker_addr, broker_porta, mqtt_conectado) != ERR_OK) {
+        desconectar(false);
+        return;
+    }
+    stats.reconexoes++;
+}
+
+bool mqtt_cliente_init(const char *broker, uint16_t porta, mqtt_cliente_config_cb_t cb) {
+    if (!ipaddr_aton(broker, &broker_addr)) {
+        return false;
+    }
+    broker_porta = porta;
+    config_cb = cb;
+    ultima_tentativa = nil_time;
+    iniciado = true;
+    return true;
+}
+
+// Trava do lwIP para as filas. Antes de mqtt_cliente_init o rádio pode nem estar inicializado (não existe
+// o contexto do cyw43), mas também não há tcp_recv que altere as filas.
+static void travar(void) {
+    if (iniciado) {
+        cyw43_arch_lwip_begin();
+    }
+}
+
+static void destravar(void) {
+    if (iniciado) {
+        cyw43_arch_lwip_end();
+    }
+}
+
+void mqtt_cliente_publicar(float temperatura, float umidade, float pressao_kpa, float altitude, uint32_t intervalo_ms,
+                           float tendencia_hpa_3h, uint8_t zambretti) {
+    // A fila também é alterada por confirmar(), no tcp_recv (interrupção do lwIP)
+    travar();
+    if (fila_n == MQTT_FILA) {
+        if (em_voo_n > 0) {
+            // A amostra mais antiga está em voo: descarta a nova para não quebrar o PUBLISH pendente
+            stats.descartadas++;
+            destravar();
+            return;
+        }
+        fila_inicio = (fila_inicio + 1) % MQTT_FILA; // Descarta a mais antiga
+        fila_n--;
+        stats.descartadas++;
+    }
+    mqtt_amostra_t *a = &fila[(fila_inicio + fila_n) % MQTT_FILA];
+    a->seq = seq_amostra++;
+    a->tempo_ms = to_ms_since_boot(get_absolute_time());
+    a->intervalo_ms = intervalo_ms;
+    a->temperatura = temperatura;
+    a->umidade = umidade;
+    a->pressao = pressao_kpa;
+    a->altitude = altitude;
+    a->tendencia = tendencia_hpa_3h;
+    a->zambretti = zambretti;
+    fila_n++;
+    destravar();
+}
+
+void mqtt_cliente_evento(const char *nome, bool ativo, float valor) {
+    travar();
+    if (eventos_n == MQTT_EVENTOS) {
+        eventos_inicio = (eventos_inicio + 1) % MQTT_EVENTOS; // Descarta o mais antigo
+        eventos_n--;
+    }
+    mqtt_evento_t *e = &eventos[(eventos_inicio + eventos_n) % MQTT_EVENTOS];
+    e->nome = nome;
+    e->ativo = ativo;
+    e->valor = valor;
+    e->tempo_ms = to_ms_since_boot(get_absolute_time());
+    eventos_n++;
+    destravar();
+}
+
+void mqtt_cliente_poll(void) {
+    cyw43_arch_lwip_begin();
+
+    if (estado == MQTT_DESCONECTADO) {
+        if (is_nil_time(ultima_tentativa) ||
+            absolute_time_diff_us(ultima_tentativa, get_absolute_time()) > MQTT_RECONEXAO_MS * 1000) {
+            conectar();
+        }
+    } else if (estado == MQTT_ATIVO) {
+        publicar_eventos();
+        if (em_voo_id != 0) {
+            if (time_us_64() - em_voo_envio_us > MQTT_RETX_MS * 1000) {
+                publicar_pendentes(true);
+            }
+        } else {
+            publicar_pendentes(false);
+        }
+
+        // Keepalive
+        if (absolute_time_diff_us(ultimo_envio, get_absolute_time()) > (int64_t)MQTT_KEEPALIVE_S * 500000) {
+            enviar(mqtt_codec_pingreq(tx_buf, sizeof(tx_buf)));
+        }
+    }
+
+    cyw43_arch_lwip_end();
+}
+
+bool mqtt_cliente_conectado(void) {
+    return estado == MQTT_ATIVO;
+}
+
+const mqtt_cliente_stats_t *mqtt_cliente_stats(void) {
+    return &stats;
+}
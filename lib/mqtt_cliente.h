@@ -0,0 +1,65 @@
+#ifndef MQTT_CLIENTE_H
+#define MQTT_CLIENTE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Endereço IP do broker MQTT
+#ifndef MQTT_BROKER
+#define MQTT_BROKER "192.168.0.10"
+#endif
+
+#ifndef MQTT_PORTA
+#define MQTT_PORTA 1883
+#endif
+
+// Identificador da estação usado nos tópicos (estacao/<id>/...)
+#ifndef MQTT_ESTACAO
+#define MQTT_ESTACAO "1"
+#endif
+
+// QoS das publicações de dados (0 ou 1)
+#ifndef MQTT_QOS
+#define MQTT_QOS 1
+#endif
+
+#define MQTT_FILA 16         // Amostras aguardando publicação
+#define MQTT_EVENTOS 4       // Eventos de alerta aguardando publicação
+#define MQTT_LOTE_MAX 8      // Máximo de amostras por PUBLISH quando o link está lento
+#define MQTT_KEEPALIVE_S 60  // Keepalive negociado com o broker
+#define MQTT_RETX_MS 5000    // Retransmissão de PUBLISH QoS1 sem PUBACK
+#define MQTT_RECONEXAO_MS 5000
+
+// Chamada quando chega uma mensagem em estacao/<id>/config/# (payload terminado em '\0')
+typedef void (*mqtt_cliente_config_cb_t)(const char *topico, const char *payload);
+
+typedef struct {
+    uint32_t publicacoes;     // PUBLISH de dados enviados (sem retransmissões)
+    uint32_t amostras;        // Amostras confirmadas (QoS1) ou enviadas (QoS0)
+    uint32_t retransmissoes;
+    uint32_t descartadas;     // Amostras perdidas por fila cheia
+    uint32_t reconexoes;
+    uint32_t latencia_ultima_us; // Tempo PUBLISH -> PUBACK
+    uint32_t latencia_max_us;
+    uint64_t latencia_soma_us;
+    uint32_t latencia_n;
+} mqtt_cliente_stats_t;
+
+// Configura o broker e o callback de configuração (a conexão é feita em mqtt_cliente_poll)
+bool mqtt_cliente_init(const char *broker, uint16_t porta, mqtt_cliente_config_cb_t cb);
+
+// Enfileira uma amostra para publicação (intervalo_ms = tempo real desde a amostra anterior;
+// tendencia_hpa_3h = NAN sem histórico, zambretti = 0 sem previsão)
+void mqtt_cliente_publicar(float temperatura, float umidade, float pressao_kpa, float altitude, uint32_t intervalo_ms,
+                           float tendencia_hpa_3h, uint8_t zambretti);
+
+// Enfileira um evento de alerta (publicado em estacao/<id>/eventos com QoS 0; nome deve ser estático)
+void mqtt_cliente_evento(const char *nome, bool ativo, float valor);
+
+// Mantém a conexão, envia keepalive e publica as amostras enfileiradas
+void mqtt_cliente_poll(void);
+
+bool mqtt_cliente_conectado(void);
+const mqtt_cliente_stats_t *mqtt_cliente_stats(void);
+
+#endif // MQTT_CLIENTE_H
@@ -0,0 +1,194 @@
+#include <string.h>
+#include "mqtt_codec.h"
+
+// Escreve o "remaining length" (1 a 4 bytes) e retorna quantos bytes foram usados
+static size_t escrever_tamanho(uint8_t *buf, size_t tamanho) {
+    size_t n = 0;
+    do {
+        uint8_t byte = tamanho % 128;
+        tamanho /= 128;
+        if (tamanho > 0) {
+            byte |= 0x80;
+        }
+        buf[n++] = byte;
+    } while (tamanho > 0 && n < 4);
+    return n;
+}
+
+static size_t bytes_do_tamanho(size_t tamanho) {
+    return tamanho < 128 ? 1 : tamanho < 16384 ? 2 : tamanho < 2097152 ? 3 : 4;
+}
+
+static uint8_t *escrever_u16(uint8_t *p, uint16_t v) {
+    p[0] = v >> 8;
+    p[1] = v & 0xFF;
+    return p + 2;
+}
+
+static uint8_t *escrever_string(uint8_t *p, const char *s, size_t len) {
+    p = escrever_u16(p, (uint16_t)len);
+    memcpy(p, s, len);
+    return p + len;
+}
+
+// Monta o cabeçalho fixo e retorna o ponteiro para o corpo (ou NULL se não couber)
+static uint8_t *cabecalho(uint8_t *buf, size_t cap, uint8_t primeiro_byte, size_t restante, size_t *total) {
+    *total = 1 + bytes_do_tamanho(restante) + restante;
+    if (*total > cap) {
+        return NULL;
+    }
+    buf[0] = primeiro_byte;
+    return buf + 1 + escrever_tamanho(buf + 1, restante);
+}
+
+size_t mqtt_codec_connect(uint8_t *buf, size_t cap, const char *client_id, uint16_t keepalive_s) {
+    size_t id_len = strlen(client_id);
+    size_t total;
+    uint8_t *p = cabecalho(buf, cap, MQTT_CONNECT << 4, 10 + 2 + id_len, &total);
+    if (!p) {
+        return 0;
+    }
+    p = escrever_string(p, "MQTT", 4);
+    *p++ = 4;    // Nível do protocolo (3.1.1)
+    *p++ = 0x02; // Clean session
+    p = escrever_u16(p, keepalive_s);
+    escrever_string(p, client_id, id_len);
+    return total;
+}
+
+size_t mqtt_codec_publish(uint8_t *buf, size_t cap, const char *topico, const void *payload, size_t len,
+                          uint8_t qos, uint16_t packet_id, bool dup) {
+    size_t topico_len = strlen(topico);
+    size_t restante = 2 + topico_len + (qos ? 2 : 0) + len;
+    size_t total;
+    uint8_t primeiro = (MQTT_PUBLISH << 4) | (dup ? 0x08 : 0) | ((qos & 0x03) << 1);
+    uint8_t *p = cabecalho(buf, cap, primeiro, restante, &total);
+    if (!p) {
+        return 0;
+    }
+    p = escrever_string(p, topico, topico_len);
+    if (qos) {
+        p = escrever_u16(p, packet_id);
+    }
+    memcpy(p, payload, len);
+    return total;
+}
+
+size_t mqtt_codec_subscribe(uint8_t *buf, size_t cap, uint16_t packet_id, const char *const *topicos, int n, uint8_t qos) {
+    size_t restante = 2;
+    for (int i = 0; i < n; i++) {
+        restante += 2 + strlen(topicos[i]) + 1;
+    }
+    size_t total;
+    uint8_t *p = cabecalho(buf, cap, (MQTT_SUBSCRIBE << 4) | 0x02, restante, &total);
+    if (!p) {
+        return 0;
+    }
+    p = escrever_u16(p, packet_id);
+    for (int i = 0; i < n; i++) {
+        p = escrever_string(p, topicos[i], strlen(topicos[i]));
+        *p++ = qos;
+    }
+    return total;
+}
+
+size_t mqtt_codec_pingreq(uint8_t *buf, size_t cap) {
+    size_t total;
+    return cabecalho(buf, cap, MQTT_PINGREQ << 4, 0, &total) ? total : 0;
+}
+
+size_t mqtt_codec_puback(uint8_t *buf, size_t cap, uint16_t packet_id) {
+    size_t total;
+    uint8_t *p = cabecalho(buf, cap, MQTT_PUBACK << 4, 2, &total);
+    if (!p) {
+        return 0;
+    }
+    escrever_u16(p, packet_id);
+    return total;
+}
+
+size_t mqtt_codec_disconnect(uint8_t *buf, size_t cap) {
+    size_t total;
+    return cabecalho(buf, cap, MQTT_DISCONNECT << 4, 0, &total) ? total : 0;
+}
+
+int mqtt_codec_decodificar(const uint8_t *buf, size_t len, mqtt_pacote_t *pacote) {
+    if (len < 2) {
+        return 0;
+    }
+
+    // Remaining length
+    size_t restante = 0;
+    size_t mult = 1;
+    size_t i = 1;
+    for (;;) {
+        if (i > 4) {
+            return -1;
+        }
+        if (i >= len) {
+            return 0;
+        }
+        uint8_t byte = buf[i++];
+        restante += (byte & 0x7F) * mult;
+        mult *= 128;
+        if (!(byte & 0x80)) {
+            break;
+        }
+    }
+    if (len < i + restante) {
+        return 0;
+    }
+
+    const uint8_t *corpo = buf + i;
+    memset(pacote, 0, sizeof(*pacote));
+    pacote->tipo = buf[0] >> 4;
+    pacote->flags = buf[0] & 0x0F;
+
+    switch (pacote->tipo) {
+    case MQTT_CONNACK:
+        if (restante < 2) {
+            return -1;
+        }
+        pacote->codigo = corpo[1];
+        break;
+    case MQTT_PUBACK:
+        if (restante < 2) {
+            return -1;
+        }
+        pacote->packet_id = (corpo[0] << 8) | corpo[1];
+        break;
+    case MQTT_SUBACK:
+        if (restante < 3) {
+            return -1;
+        }
+        pacote->packet_id = (corpo[0] << 8) | corpo[1];
+        pacote->codigo = corpo[2];
+        break;
+    case MQTT_PUBLISH: {
+        if (restante < 2) {
+            return -1;
+        }
+        uint16_t topico_len = (corpo[0] << 8) | corpo[1];
+        size_t pos = 2 + topico_len;
+        uint8_t qos = (pacote->flags >> 1) & 0x03;
+        if (qos) {
+            pos += 2;
+        }
+        if (pos > restante) {
+            return -1;
+        }
+        pacote->topico = (const char *)corpo + 2;
+        pacote->topico_len = topico_len;
+        if (qos) {
+            pacote->packet_id = (corpo[2 + topico_len] << 8) | corpo[3 + topico_len];
+        }
+        pacote->payload = corpo + pos;
+        pacote->payload_len = restante - pos;
+        break;
+    }
+    default:
+        break;
+    }
+
+    return (int)(i + restante);
+}
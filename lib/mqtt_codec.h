@@ -0,0 +1,47 @@
+#ifndef MQTT_CODEC_H
+#define MQTT_CODEC_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+// Codificação/decodificação de pacotes MQTT 3.1.1 sem dependência de rede
+// (usado pelo cliente lwIP do firmware e pelas ferramentas de teste no Linux)
+
+// Tipos de pacote (nibble superior do primeiro byte)
+#define MQTT_CONNECT     1
+#define MQTT_CONNACK     2
+#define MQTT_PUBLISH     3
+#define MQTT_PUBACK      4
+#define MQTT_SUBSCRIBE   8
+#define MQTT_SUBACK      9
+#define MQTT_PINGREQ     12
+#define MQTT_PINGRESP    13
+#define MQTT_DISCONNECT  14
+
+// Pacote recebido já decodificado (ponteiros apontam para o buffer de entrada)
+typedef struct {
+    uint8_t tipo;
+    uint8_t flags;           // Nibble inferior do primeiro byte
+    uint16_t packet_id;      // PUBACK/SUBACK e PUBLISH com QoS > 0
+    const char *topico;      // PUBLISH
+    uint16_t topico_len;
+    const uint8_t *payload;  // PUBLISH
+    size_t payload_len;
+    uint8_t codigo;          // Código de retorno do CONNACK / primeiro código do SUBACK
+} mqtt_pacote_t;
+
+// Funções de codificação: retornam o tamanho do pacote ou 0 se não couber em cap
+size_t mqtt_codec_connect(uint8_t *buf, size_t cap, const char *client_id, uint16_t keepalive_s);
+size_t mqtt_codec_publish(uint8_t *buf, size_t cap, const char *topico, const void *payload, size_t len,
+                          uint8_t qos, uint16_t packet_id, bool dup);
+size_t mqtt_codec_subscribe(uint8_t *buf, size_t cap, uint16_t packet_id, const char *const *topicos, int n, uint8_t qos);
+size_t mqtt_codec_pingreq(uint8_t *buf, size_t cap);
+size_t mqtt_codec_puback(uint8_t *buf, size_t cap, uint16_t packet_id);
+size_t mqtt_codec_disconnect(uint8_t *buf, size_t cap);
+
+// Decodifica um pacote do início de buf.
+// Retorna o número de bytes consumidos, 0 se o pacote ainda está incompleto ou -1 se inválido
+int mqtt_codec_decodificar(const uint8_t *buf, size_t len, mqtt_pacote_t *pacote);
+
+#endif // MQTT_CODEC_H
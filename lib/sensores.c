@@ -0,0 +1,425 @@
+#include <stdio.h>
+#include "pico/stdlib.h"
+#include "hardware/i2c.h"
+#include "aht20.h"
+#include "bmp280.h"
+#include "metricas.h"
+#include "gravacao.h"
+#include "log.h"
+#include "sensores.h"
+
+#define SENSORES_TIMEOUT_US 5000 // Prazo de cada transação de leitura
+
+// Operações de cada tipo de sensor
+typedef struct {
+    const char *nome;
+    bool (*iniciar)(sensor_t *s);         // Bloqueante, antes de i2c_fila_init
+    bool (*reiniciar)(sensor_t *s);       // Pela fila, com a amostragem em andamento
+    void (*preparar)(sensor_t *s);        // Monta as transações de disparo e leitura
+    bool (*converter)(sensor_t *s);       // Interpreta s->bruto
+    metrica_hist_t hist;
+} sensor_driver_t;
+
+static i2c_inst_t *barramento_sensores;
+static sensor_t sensores[SENSORES_MAX];
+static int n_sensores = 0;
+static int canal_atual = -2; // Canal selecionado no multiplexador (-2 = desconhecido)
+
+// Enfileira a troca de canal do multiplexador quando necessária.
+// Todas as transações dos sensores têm a mesma prioridade, então a fila as executa na ordem de envio
+// e a seleção do canal vale para a transação seguinte.
+static bool selecionar_canal(sensor_t *s) {
+    if (s->canal_mux < 0 || s->canal_mux == canal_atual) {
+        return true;
+    }
+    if (!i2c_fila_enviar(barramento_sensores, &s->trans_mux)) {
+        canal_atual = -2;
+        return false;
+    }
+    canal_atual = s->canal_mux;
+    return true;
+}
+
+// Transação bloqueante pela fila (reinicialização) em trans_config, com prazo de SENSORES_TIMEOUT_US.
+// registrador < 0: sem byte de registrador antes dos dados
+static bool transferir(sensor_t *s, int16_t registrador, const uint8_t *tx, uint16_t n_tx, uint8_t *rx, uint16_t n_rx) {
+    i2c_transacao_t *t = &s->trans_config;
+    if (!i2c_fila_livre(t)) {
+        return false;
+    }
+    t->cabecalho[0] = (uint8_t)registrador;
+    t->n_cabecalho = registrador >= 0 ? 1 : 0;
+    t->tx = tx;
+    t->n_tx = n_tx;
+    t->rx = rx;
+    t->n_rx = n_rx;
+    if (!selecionar_canal(s) || !i2c_fila_enviar(barramento_sensores, t)) {
+        return false;
+    }
+    return i2c_fila_aguardar(t, SENSORES_TIMEOUT_US);
+}
+
+// --- BMP280 (modo normal: sem disparo, lê a última conversão; modo forçado: disparo por amostra)
+
+static bool bmp280_iniciar(sensor_t *s) {
+    return bmp280_configure(barramento_sensores, s->endereco, &s->config) &&
+           bmp280_get_calib_params(barramento_sensores, s->endereco, &s->calibracao);
+}
+
+// Mesma sequência de bmp280_configure: sleep, config, modo
+static void bmp280_montar_configuracao(sensor_t *s) {
+    const bmp280_config_t *cfg = &s->config;
+    uint8_t *c = s->reconfiguracao;
+    c[0] = REG_CTRL_MEAS;
+    c[1] = bmp280_reg_ctrl_meas(cfg, BMP280_MODO_SLEEP);
+    c[2] = REG_CONFIG;
+    c[3] = bmp280_reg_config(cfg);
+    c[4] = REG_CTRL_MEAS;
+    c[5] = bmp280_reg_ctrl_meas(cfg, cfg->modo == BMP280_MODO_NORMAL ? BMP280_MODO_NORMAL : BMP280_MODO_SLEEP);
+}
+
+static void bmp280_preparar(sensor_t *s) {
+    // Rajada a partir do status: a conversão e o seu estado vêm na mesma transação
+    s->trans_leitura.cabecalho[0] = REG_STATUS;
+    s->trans_leitura.n_cabecalho = 1;
+    s->trans_leitura.rx = s->bruto;
+    s->trans_leitura.n_rx = BMP280_BURST_LEN;
+
+    if (s->config.modo == BMP280_MODO_FORCADO) {
+        s->comando[0] = REG_CTRL_MEAS;
+        s->comando[1] = bmp280_reg_ctrl_meas(&s->config, BMP280_MODO_FORCADO);
+        s->trans_disparo.tx = s->comando;
+        s->trans_disparo.n_tx = 2;
+        s->conversao_ms = (bmp280_measurement_time_us(&s->config) + 999) / 1000;
+    } else {
+        s->trans_disparo.n_tx = 0;
+        s->conversao_ms = 0;
+    }
+}
+
+static bool bmp280_converter(sensor_t *s) {
+    int32_t temp_bruta, pressao_bruta;
+    if (!bmp280_decode_burst(s->bruto, &temp_bruta, &pressao_bruta)) {
+        return false; // Conversão forçada ainda em andamento
+    }
+
+    // Quantas conversões o sensor fez desde a leitura anterior (lib/conversao.c, o mesmo código do replay)
+    s->novas = bmp280_conversoes_novas(&s->repeticao, &s->config,
+                                       s->disparado && s->trans_disparo.estado == I2C_TRANS_OK, temp_bruta,
+                                       pressao_bruta, s->trans_leitura.fim_us);
+    s->disparado = false;
+    if (!s->novas) {
+        s->repetidas++;
+        return true;
+    }
+    s->perdidas += s->novas - 1;
+
+    s->temperatura = bmp280_convert_temp(temp_bruta, &s->calibracao) / 100.0f;
+    s->pressao = bmp280_convert_pressure(pressao_bruta, temp_bruta, &s->calibracao);
+    return true;
+}
+
+// Relê a calibração (o sensor pode ter sido trocado ou perdido a alimentação) e reaplica a configuração
+static bool bmp280_reiniciar(sensor_t *s) {
+    if (!transferir(s, REG_DIG_T1_LSB, NULL, 0, s->calibracao_bruta, BMP280_CALIB_LEN)) {
+        return false;
+    }
+    struct bmp280_calib_param calibracao;
+    bmp280_parse_calib(s->calibracao_bruta, &calibracao);
+    if (calibracao.dig_t1 == 0) {
+        return false;
+    }
+    bmp280_montar_configuracao(s);
+    if (!transferir(s, -1, s->reconfiguracao, sizeof(s->reconfiguracao), NULL, 0)) {
+        return false;
+    }
+    s->calibracao = calibracao;
+    s->repeticao.anterior = false;
+    bmp280_preparar(s);
+    return true;
+}
+
+// --- AHT20 (disparo com 0xAC e leitura após a conversão)
+
+static const uint8_t aht20_medir[3] = {AHT20_CMD_TRIGGER, 0x33, 0x00};
+static const uint8_t aht20_inicializar[3] = {AHT20_CMD_INIT, 0x08, 0x00};
+
+// Sem esperas no boot: com a calibração já feita (o normal depois de ligar) basta o sensor responder;
+// senão envia a inicialização, que termina antes da primeira medição ser lida
+static bool aht20_iniciar(sensor_t *s) {
+    (void)s; // Endereço fixo: o canal do multiplexador já foi selecionado
+    uint8_t status;
+    if (!aht20_status(barramento_sensores, &status)) {
+        return false; // Ainda ligando ou ausente: vai para a reinicialização com espera
+    }
+    return (status & AHT20_STATUS_CALIBRATED) || aht20_calibrate(barramento_sensores);
+}
+
+static void aht20_preparar(sensor_t *s) {
+    s->conversao_ms = AHT20_TEMPO_MEDICAO_MS;
+    s->trans_disparo.tx = aht20_medir;
+    s->trans_disparo.n_tx = sizeof(aht20_medir);
+    s->trans_leitura.rx = s->bruto;
+    s->trans_leitura.n_rx = 6;
+}
+
+static bool aht20_converter(sensor_t *s) {
+    AHT20_Data d;
+    if (!aht20_parse(s->bruto, &d)) {
+        metricas_contar(MC_AHT20_FALHAS);
+        return false;
+    }
+    s->novas = 1; // Sempre uma conversão por disparo
+    s->temperatura = d.temperature;
+    s->umidade = d.humidity;
+    return true;
+}
+
+// Sem esperas: se o sensor responde mas não está calibrado, envia a inicialização e confere na
+// próxima tentativa
+static bool aht20_reiniciar(sensor_t *s) {
+    uint8_t status;
+    if (!transferir(s, -1, NULL, 0, &status, 1)) {
+        return false;
+    }
+    if (!(status & AHT20_STATUS_CALIBRATED)) {
+        transferir(s, -1, aht20_inicializar, sizeof(aht20_inicializar), NULL, 0);
+        return false;
+    }
+    aht20_preparar(s);
+    return true;
+}
+
+static const sensor_driver_t drivers[SENSOR_TIPOS] = {
+    [SENSOR_BMP280] = {"bmp280", bmp280_iniciar, bmp280_reiniciar, bmp280_preparar, bmp280_converter, MH_BMP280_LEITURA},
+    [SENSOR_AHT20] = {"aht20", aht20_iniciar, aht20_reiniciar, aht20_preparar, aht20_converter, MH_AHT20_LEITURA},
+};
+
+int sensores_registrar(const char *nome, sensor_tipo_t tipo, int8_t canal_mux, uint8_t endereco) {
+    if (n_sensores >= SENSORES_MAX || tipo >= SENSOR_TIPOS || canal_mux > 7) {
+        return -1;
+    }
+    sensor_t *s = &sensores[n_sensores];
+    s->nome = nome;
+    s->tipo = tipo;
+    s->canal_mux = canal_mux;
+    s->endereco = endereco;
+    s->mascara_mux = canal_mux >= 0 ? 1u << canal_mux : 0;
+
+    const bmp280_config_t padrao = BMP280_CONFIG_PADRAO;
+    s->config = padrao;
+
+    i2c_transacao_t *t[] = {&s->trans_mux, &s->trans_disparo, &s->trans_leitura, &s->trans_config};
+    for (int i = 0; i < 4; i++) {
+        t[i]->endereco = endereco;
+        t[i]->prioridade = I2C_PRIORIDADE_ALTA;
+    }
+    s->trans_mux.endereco = SENSORES_MUX_ENDERECO;
+    s->trans_mux.tx = &s->mascara_mux;
+    s->trans_mux.n_tx = 1;
+    drivers[tipo].preparar(s);
+    return n_sensores++;
+}
+
+static uint32_t agora_ms(void) {
+    return to_ms_since_boot(get_absolute_time());
+}
+
+// Tira o sensor do ciclo de leitura e agenda a próxima reinicialização
+static void afastar(int id, uint32_t agora) {
+    sensor_t *s = &sensores[id];
+    s->presente = false;
+    s->valido = false;
+    s->saude = SENSOR_AUSENTE;
+    s->proxima_tentativa_ms = agora + s->espera_ms;
+    LOG(LOG_SENSOR_SAUDE, id, s->saude, s->falhas_seguidas, s->espera_ms);
+    s->espera_ms = s->espera_ms * 2 < SENSORES_ESPERA_MAX_MS ? s->espera_ms * 2 : SENSORES_ESPERA_MAX_MS;
+}
+
+void sensores_iniciar(i2c_inst_t *i2c) {
+    barramento_sensores = i2c;
+    for (int i = 0; i < n_sensores; i++) {
+        sensor_t *s = &sensores[i];
+        bool mux_ok = s->canal_mux < 0 ||
+                      i2c_write_timeout_us(i2c, SENSORES_MUX_ENDERECO, &s->mascara_mux, 1, false, I2C_PRAZO_US(1)) == 1;
+        s->presente = mux_ok && drivers[s->tipo].iniciar(s);
+        s->espera_ms = SENSORES_ESPERA_MIN_MS;
+        printf("Sensor %s (%s, canal %d, 0x%02x): %s\n", s->nome, drivers[s->tipo].nome, s->canal_mux, s->endereco,
+               s->presente ? "ok" : "ausente");
+        if (!s->presente) {
+            afastar(i, agora_ms()); // Pode ter sido ligado depois: tenta de novo com a amostragem em andamento
+        }
+    }
+}
+
+// Reinicializa os sensores ausentes cuja espera terminou (só com a fila ativa: as transações são da fila)
+static void reiniciar_ausentes(void) {
+    if (!i2c_fila_ativa(barramento_sensores)) {
+        return;
+    }
+    uint32_t agora = agora_ms();
+    for (int i = 0; i < n_sensores; i++) {
+        sensor_t *s = &sensores[i];
+        if (s->presente || (int32_t)(agora - s->proxima_tentativa_ms) < 0) {
+            continue;
+        }
+        if (!drivers[s->tipo].reiniciar(s)) {
+            if (s->canal_mux >= 0) {
+                canal_atual = -2;
+            }
+            afastar(i, agora);
+            continue;
+        }
+        s->presente = true;
+        s->saude = SENSOR_OK;
+        s->falhas_seguidas = 0;
+        s->espera_ms = SENSORES_ESPERA_MIN_MS;
+        s->reinicios++;
+        gravacao_sensor(i);
+        LOG(LOG_SENSOR_SAUDE, i, s->saude, 0, 0);
+    }
+}
+
+uint32_t sensores_disparar(void) {
+    reiniciar_ausentes();
+
+    uint32_t espera = 0;
+    for (int i = 0; i < n_sensores; i++) {
+        sensor_t *s = &sensores[i];
+        if (!s->presente || !s->trans_disparo.n_tx) {
+            continue;
+        }
+        s->disparado = selecionar_canal(s) && i2c_fila_enviar(barramento_sensores, &s->trans_disparo);
+        if (s->disparado && s->conversao_ms > espera) {
+            espera = s->conversao_ms;
+        }
+    }
+    return espera;
+}
+
+void sensores_coletar(void) {
+    // Primeiro enfileira todas as leituras, depois espera: o barramento não fica ocioso entre sensores
+    bool enviada[SENSORES_MAX];
+    for (int i = 0; i < n_sensores; i++) {
+        sensor_t *s = &sensores[i];
+        enviada[i] = s->presente && selecionar_canal(s) && i2c_fila_enviar(barramento_sensores, &s->trans_leitura);
+    }
+
+    for (int i = 0; i < n_sensores; i++) {
+        sensor_t *s = &sensores[i];
+        if (!s->presente) {
+            continue;
+        }
+        const sensor_driver_t *d = &drivers[s->tipo];
+        bool ok = enviada[i] && i2c_fila_aguardar(&s->trans_leitura, SENSORES_TIMEOUT_US);
+        if (ok) {
+            metricas_observar(d->hist, s->trans_leitura.fim_us - s->trans_leitura.inicio_us);
+            gravacao_leitura(i, s->trans_leitura.fim_us, s->bruto, (uint8_t)s->trans_leitura.n_rx);
+            ok = d->converter(s);
+        }
+        if (!ok && s->canal_mux >= 0) {
+            canal_atual = -2; // Estado do multiplexador incerto: seleciona de novo no próximo ciclo
+        }
+        s->valido = ok;
+        s->leituras++;
+        if (ok) {
+            s->saude = SENSOR_OK;
+            s->falhas_seguidas = 0;
+            s->ultima_valida_ms = agora_ms();
+        } else {
+            s->falhas++;
+            s->saude = SENSOR_FALHANDO;
+            if (++s->falhas_seguidas >= SENSORES_FALHAS_MAX) {
+                afastar(i, agora_ms());
+            }
+        }
+    }
+}
+
+bool sensores_configurar_bmp280(int id, const bmp280_config_t *cfg) {
+    if (id < 0 || id >= n_sensores || sensores[id].tipo != SENSOR_BMP280 || !bmp280_config_valid(cfg) ||
+        !i2c_fila_ativa(barramento_sensores)) {
+        return false;
+    }
+    sensor_t *s = &sensores[id];
+    if (!i2c_fila_livre(&s->trans_config) || !i2c_fila_livre(&s->trans_disparo)) {
+        return false; // Reconfiguração ou disparo anterior ainda na fila
+    }
+
+    s->config = *cfg;
+    bmp280_montar_configuracao(s);
+    s->trans_config.n_cabecalho = 0;
+    s->trans_config.tx = s->reconfiguracao;
+    s->trans_config.n_tx = sizeof(s->reconfiguracao);
+    s->trans_config.n_rx = 0;
+    if (!selecionar_canal(s) || !i2c_fila_enviar(barramento_sensores, &s->trans_config)) {
+        return false;
+    }
+    s->repeticao.anterior = false; // Recomeça a detecção de repetidas com a nova configuração
+    bmp280_preparar(s);
+    gravacao_sensor(id);
+    return true;
+}
+
+int sensores_quantidade(void) {
+    return n_sensores;
+}
+
+const sensor_t *sensores_obter(int id) {
+    return (id < 0 || id >= n_sensores) ? NULL : &sensores[id];
+}
+
+int sensores_primeiro(sensor_tipo_t tipo) {
+    for (int i = 0; i < n_sensores; i++) {
+        if (sensores[i].tipo == tipo && sensores[i].presente) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+uint32_t sensores_idade_ms(int id) {
+    if (id < 0 || id >= n_sensores || !sensores[id].ultima_valida_ms) {
+        return UINT32_MAX;
+    }
+    return agora_ms() - sensores[id].ultima_valida_ms;
+}
+
+size_t sensores_relatorio(char *buf, size_t cap) {
+    size_t len = snprintf(buf, cap, "{\"sensores\":[");
+    for (int i = 0; i < n_sensores && len < cap; i++) {
+        const sensor_t *s = &sensores[i];
+        len += snprintf(buf + len, cap - len,
+                        "%s{\"nome\":\"%s\",\"tipo\":\"%s\",\"canal\":%d,\"endereco\":%u,\"presente\":%s,\"valido\":%s,"
+                        "\"tem\":%.2f,",
+                        i ? "," : "", s->nome, drivers[s->tipo].nome, s->canal_mux, s->endereco,
+                        s->presente ? "true" : "false", s->valido ? "true" : "false", s->temperatura);
+        if (len < cap) {
+            if (s->tipo == SENSOR_BMP280) {
+                const bmp280_config_t *c = &s->config;
+                len += snprintf(buf + len, cap - len,
+                                "\"pre\":%.3f,\"osrs_t\":%u,\"osrs_p\":%u,\"filtro\":%u,\"standby\":%u,\"modo\":%u,"
+                                "\"odr_hz\":%.2f,\"repetidas\":%lu,\"perdidas\":%lu,",
+                                s->pressao / 1000.0f, c->osrs_t, c->osrs_p, c->filtro, c->standby, c->modo,
+                                c->modo == BMP280_MODO_NORMAL ? 1e6 / bmp280_period_us(c) : 0.0,
+                                (unsigned long)s->repetidas, (unsigned long)s->perdidas);
+            } else {
+                len += snprintf(buf + len, cap - len, "\"umi\":%.2f,", s->umidade);
+            }
+        }
+        if (len < cap) {
+            static const char *const saudes[] = {"ok", "falhando", "ausente"};
+            uint32_t idade = sensores_idade_ms(i);
+            len += snprintf(buf + len, cap - len,
+                            "\"leituras\":%lu,\"falhas\":%lu,\"saude\":\"%s\",\"falhas_seguidas\":%lu,"
+                            "\"reinicios\":%lu,\"idade_ms\":%ld}",
+                            (unsigned long)s->leituras, (unsigned long)s->falhas, saudes[s->saude],
+                            (unsigned long)s->falhas_seguidas, (unsigned long)s->reinicios,
+                            idade == UINT32_MAX ? -1L : (long)idade);
+        }
+    }
+    if (len < cap) {
+        len += snprintf(buf + len, cap - len, "]}");
+    }
+    return len < cap ? len : cap - 1;
+}
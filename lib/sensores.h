@@ -0,0 +1,103 @@
+#ifndef SENSORES_H
+#define SENSORES_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "hardware/i2c.h"
+#include "bmp280.h"
+#include "i2c_fila.h"
+
+// Registro de sensores: cada instância guarda endereço, canal do multiplexador, calibração e última leitura.
+// As medições são disparadas em lote e recolhidas juntas, então N sensores custam um tempo de conversão.
+// Um sensor que falha SENSORES_FALHAS_MAX leituras seguidas sai do ciclo e é reinicializado pela fila,
+// com espera dobrando de SENSORES_ESPERA_MIN_MS até SENSORES_ESPERA_MAX_MS entre as tentativas.
+
+#define SENSORES_MAX 8
+#define SENSORES_MUX_ENDERECO 0x70 // TCA9548A com A0-A2 em GND
+#define SENSOR_SEM_MUX -1          // Sensor ligado direto no barramento
+
+#define SENSORES_FALHAS_MAX 3        // Falhas seguidas até o sensor ser dado como ausente
+#define SENSORES_ESPERA_MIN_MS 1000  // Primeira espera antes de reinicializar
+#define SENSORES_ESPERA_MAX_MS 60000
+
+typedef enum {
+    SENSOR_BMP280,
+    SENSOR_AHT20,
+    SENSOR_TIPOS
+} sensor_tipo_t;
+
+typedef enum {
+    SENSOR_OK,
+    SENSOR_FALHANDO, // Última leitura falhou, ainda no ciclo de leitura
+    SENSOR_AUSENTE,  // Fora do ciclo, aguardando a próxima tentativa de reinicialização
+} sensor_saude_t;
+
+typedef struct {
+    const char *nome;
+    sensor_tipo_t tipo;
+    int8_t canal_mux;
+    uint8_t endereco;
+    bool presente; // Respondeu na inicialização (ou na última reinicialização) e está no ciclo de leitura
+
+    // Estado por instância
+    struct bmp280_calib_param calibracao; // Só BMP280
+    bmp280_config_t config;               // Só BMP280
+    uint8_t mascara_mux;                  // Byte enviado ao TCA9548A
+    uint8_t comando[2];                   // Disparo do modo forçado (registrador, valor)
+    uint8_t reconfiguracao[6];            // Pares registrador/valor de sensores_configurar_bmp280
+    uint8_t bruto[BMP280_BURST_LEN];
+    uint8_t calibracao_bruta[BMP280_CALIB_LEN]; // Lida na reinicialização
+    uint32_t conversao_ms;                // Espera entre o disparo e a leitura
+    i2c_transacao_t trans_mux, trans_disparo, trans_leitura, trans_config;
+    bool disparado;                       // Disparo do ciclo atual enfileirado (modo forçado)
+    bmp280_repeticao_t repeticao;         // Detecção de conversões repetidas (só BMP280)
+
+    // Última leitura
+    bool valido;
+    float temperatura; // °C
+    float umidade;     // % (AHT20)
+    int32_t pressao;   // Pa (BMP280)
+    uint32_t novas;   // Conversões do sensor desde a leitura anterior (0 = mesma conversão lida de novo)
+    uint32_t leituras, falhas;
+    uint32_t repetidas; // Leituras que devolveram uma conversão já lida
+    uint32_t perdidas;  // Conversões sobrescritas antes de serem lidas (amostragem mais lenta que o sensor)
+
+    // Saúde
+    sensor_saude_t saude;
+    uint32_t falhas_seguidas;
+    uint32_t espera_ms;        // Espera até a próxima reinicialização (dobra a cada tentativa sem resposta)
+    uint32_t proxima_tentativa_ms;
+    uint32_t reinicios;        // Reinicializações bem-sucedidas
+    uint32_t ultima_valida_ms; // Instante da última leitura válida (0 = nunca)
+} sensor_t;
+
+// Cadastra um sensor e retorna seu id (canal_mux = SENSOR_SEM_MUX se não houver multiplexador)
+int sensores_registrar(const char *nome, sensor_tipo_t tipo, int8_t canal_mux, uint8_t endereco);
+
+// Inicializa todos os sensores com chamadas bloqueantes curtas, sem esperas (antes de i2c_fila_init)
+void sensores_iniciar(i2c_inst_t *i2c);
+
+// Reinicializa os sensores ausentes cuja espera terminou, enfileira o disparo dos presentes e retorna o
+// tempo de conversão a aguardar em ms
+uint32_t sensores_disparar(void);
+
+// Enfileira a leitura de todos os sensores, aguarda e converte os resultados
+void sensores_coletar(void);
+
+// Reconfigura um BMP280 em tempo de execução (transação assíncrona na fila do barramento)
+bool sensores_configurar_bmp280(int id, const bmp280_config_t *cfg);
+
+int sensores_quantidade(void);
+const sensor_t *sensores_obter(int id);
+
+// Primeiro sensor presente de um tipo (-1 se não houver)
+int sensores_primeiro(sensor_tipo_t tipo);
+
+// Idade da última leitura válida em ms (UINT32_MAX se nunca houve)
+uint32_t sensores_idade_ms(int id);
+
+// Gera um JSON com a última leitura de cada sensor
+size_t sensores_relatorio(char *buf, size_t cap);
+
+#endif // SENSORES_H
@@ -0,0 +1,178 @@
+#include <stdlib.h>
+#include "lwip/tcp.h"
+#include "http.h"
+#include "servidor_http.h"
+
+typedef struct {
+    char resposta[SERVIDOR_HTTP_RESPOSTA_MAX];
+    const char *inicio; // Início da resposta dentro de resposta (o cabeçalho fica logo antes do corpo)
+    size_t len;         // 0 = requisição ainda não recebida
+    size_t enfileirado; // Bytes já entregues ao tcp_write
+    size_t confirmado;  // Bytes confirmados pelo cliente
+    uint8_t ocioso;     // Intervalos de poll sem progresso
+} servidor_http_estado_t;
+
+static servidor_http_atender_t atender_requisicao;
+static servidor_http_stats_t stats;
+
+// Desliga os callbacks do pcb e libera o estado
+static void liberar(struct tcp_pcb *pcb, servidor_http_estado_t *hs) {
+    tcp_arg(pcb, NULL);
+    tcp_recv(pcb, NULL);
+    tcp_sent(pcb, NULL);
+    tcp_err(pcb, NULL);
+    tcp_poll(pcb, NULL, 0);
+    if (hs) {
+        free(hs);
+        stats.ativas--;
+    }
+}
+
+// Libera o estado e fecha a conexão (aborta se o lwIP não tiver memória para o FIN)
+static err_t fechar(struct tcp_pcb *pcb, servidor_http_estado_t *hs) {
+    liberar(pcb, hs);
+    if (tcp_close(pcb) != ERR_OK) {
+        tcp_abort(pcb);
+        return ERR_ABRT;
+    }
+    return ERR_OK;
+}
+
+// Entrega ao lwIP o quanto da resposta couber no buffer de envio; o restante segue em http_sent/http_poll
+static void enviar(struct tcp_pcb *pcb, servidor_http_estado_t *hs) {
+    while (hs->enfileirado < hs->len) {
+        size_t n = hs->len - hs->enfileirado;
+        u16_t livre = tcp_sndbuf(pcb);
+        if (livre == 0) {
+            break;
+        }
+        if (n > livre) {
+            n = livre;
+        }
+        u8_t flags = TCP_WRITE_FLAG_COPY | (hs->enfileirado + n < hs->len ? TCP_WRITE_FLAG_MORE : 0);
+        if (tcp_write(pcb, hs->inicio + hs->enfileirado, (u16_t)n, flags) != ERR_OK) {
+            stats.escritas_adiadas++; // MEM_SIZE ou TCP_SND_QUEUELEN esgotados: tenta de novo depois
+            break;
+        }
+        hs->enfileirado += n;
+    }
+    tcp_output(pcb);
+}
+
+static err_t http_sent(void *arg, struct tcp_pcb *pcb, u16_t len) {
+    servidor_http_estado_t *hs = arg;
+    hs->confirmado += len;
+    hs->ocioso = 0;
+    if (hs->confirmado >= hs->len) {
+        stats.respostas++;
+        return fechar(pcb, hs);
+    }
+    enviar(pcb, hs);
+    return ERR_OK;
+}
+
+static err_t http_recv(void *arg, struct tcp_pcb *pcb, struct pbuf *p, err_t err) {
+    servidor_http_estado_t *hs = arg;
+    if (!p) {
+        return fechar(pcb, hs); // Cliente fechou a conexão
+    }
+    tcp_recved(pcb, p->tot_len);
+    if (hs->len > 0) {
+        pbuf_free(p); // Resto da requisição (cabeçalhos, corpo): só a primeira parte é usada
+        return ERR_OK;
+    }
+
+    // Começo da requisição terminado em '\0' (o payload do pbuf não é uma string)
+    char req[HTTP_LINHA_MAX];
+    u16_t n_req = pbuf_copy_partial(p, req, sizeof(req) - 1, 0);
+    req[n_req] = '\0';
+    pbuf_free(p);
+
+    hs->ocioso = 0;
+    hs->inicio = atender_requisicao(req, hs->resposta, sizeof(hs->resposta), &hs->len);
+    if (!hs->inicio || hs->len == 0) {
+        return fechar(pcb, hs);
+    }
+    enviar(pcb, hs);
+    return ERR_OK;
+}
+
+static err_t http_poll(void *arg, struct tcp_pcb *pcb) {
+    servidor_http_estado_t *hs = arg;
+    if (++hs->ocioso > SERVIDOR_HTTP_OCIOSO_MAX) {
+        // Cliente parado (sem requisição ou sem confirmar o envio): libera a conexão
+        stats.expiradas++;
+        liberar(pcb, hs);
+        tcp_abort(pcb);
+        return ERR_ABRT;
+    }
+    if (hs->enfileirado < hs->len) {
+        enviar(pcb, hs); // Retoma um envio interrompido por falta de memória
+    }
+    return ERR_OK;
+}
+
+// O lwIP já liberou o pcb
+static void http_err(void *arg, err_t err) {
+    servidor_http_estado_t *hs = arg;
+    if (hs) {
+        free(hs);
+        stats.ativas--;
+        stats.abortadas++;
+    }
+}
+
+static err_t connection_callback(void *arg, struct tcp_pcb *pcb, err_t err) {
+    if (err != ERR_OK || !pcb) {
+        return ERR_VAL;
+    }
+    if (stats.ativas >= SERVIDOR_HTTP_CONEXOES_MAX) {
+        stats.recusadas++;
+        tcp_abort(pcb);
+        return ERR_ABRT;
+    }
+    servidor_http_estado_t *hs = malloc(sizeof(servidor_http_estado_t));
+    if (!hs) {
+        stats.sem_memoria++;
+        tcp_abort(pcb);
+        return ERR_ABRT;
+    }
+    hs->inicio = NULL;
+    hs->len = hs->enfileirado = hs->confirmado = 0;
+    hs->ocioso = 0;
+
+    stats.conexoes++;
+    if (++stats.ativas > stats.ativas_max) {
+        stats.ativas_max = stats.ativas;
+    }
+
+    tcp_arg(pcb, hs);
+    tcp_recv(pcb, http_recv);
+    tcp_sent(pcb, http_sent);
+    tcp_err(pcb, http_err);
+    tcp_poll(pcb, http_poll, SERVIDOR_HTTP_POLL);
+    return ERR_OK;
+}
+
+bool servidor_http_iniciar(uint16_t porta, servidor_http_atender_t atender) {
+    struct tcp_pcb *pcb = tcp_new();
+    if (!pcb) {
+        return false;
+    }
+    if (tcp_bind(pcb, IP_ADDR_ANY, porta) != ERR_OK) {
+        tcp_abort(pcb);
+        return false;
+    }
+    struct tcp_pcb *escuta = tcp_listen(pcb);
+    if (!escuta) {
+        tcp_abort(pcb);
+        return false;
+    }
+    atender_requisicao = atender;
+    tcp_accept(escuta, connection_callback);
+    return true;
+}
+
+const servidor_http_stats_t *servidor_http_stats(void) {
+    return &stats;
+}
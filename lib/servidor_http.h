@@ -0,0 +1,41 @@
+#ifndef SERVIDOR_HTTP_H
+#define SERVIDOR_HTTP_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+// Servidor HTTP sobre a API raw do lwIP: aceita as conexões, entrega a requisição à função de atendimento
+// e envia a resposta em partes do tamanho de tcp_sndbuf, retomando em http_sent e http_poll quando o lwIP
+// fica sem memória. Depende só do lwIP (compila também no host, com o port Unix, em tools/carga_http.c).
+
+#ifndef SERVIDOR_HTTP_CONEXOES_MAX
+#define SERVIDOR_HTTP_CONEXOES_MAX 4 // Cada conexão ocupa um servidor_http_estado_t (~20 KB) no heap
+#endif
+
+#define SERVIDOR_HTTP_RESPOSTA_MAX 20000 // Cabeçalho + corpo da maior resposta (/trace, /metrics)
+#define SERVIDOR_HTTP_POLL 4             // Intervalo do tcp_poll em unidades de 500 ms
+#define SERVIDOR_HTTP_OCIOSO_MAX 5       // Intervalos de poll sem progresso antes de abortar (10 s)
+
+// Monta a resposta à requisição req (terminada em '\0') em buf[0..cap): retorna o início dela dentro
+// de buf e o tamanho em *len, ou NULL para fechar a conexão sem resposta
+typedef const char *(*servidor_http_atender_t)(const char *req, char *buf, size_t cap, size_t *len);
+
+typedef struct {
+    uint32_t conexoes;    // Aceitas
+    uint32_t recusadas;   // Acima de SERVIDOR_HTTP_CONEXOES_MAX
+    uint32_t sem_memoria; // malloc do estado falhou
+    uint32_t respostas;   // Enviadas por completo
+    uint32_t abortadas;   // Encerradas pelo lwIP (RST, falta de memória, retransmissões esgotadas)
+    uint32_t expiradas;   // Sem progresso por SERVIDOR_HTTP_OCIOSO_MAX intervalos
+    uint32_t escritas_adiadas; // tcp_write com ERR_MEM (envio retomado depois)
+    uint16_t ativas;
+    uint16_t ativas_max;
+} servidor_http_stats_t;
+
+// Escuta na porta e atende cada requisição com atender
+bool servidor_http_iniciar(uint16_t porta, servidor_http_atender_t atender);
+
+const servidor_http_stats_t *servidor_http_stats(void);
+
+#endif // SERVIDOR_HTTP_H
@@ -1,7 +1,9 @@
 #include "ssd1306.h"
 #include "font.h"
+#include "i2c_fila.h"
 
 void ssd1306_init(ssd1306_t *ssd, uint8_t width, uint8_t height, bool external_vcc, uint8_t address, i2c_inst_t *i2c) {
+  (void)external_vcc; // A sequência de ssd1306_config é a da bomba de carga interna
   ssd->width = width;
   ssd->height = height;
   ssd->pages = height / 8U;
@@ -43,12 +45,13 @@ void ssd1306_config(ssd1306_t *ssd) {
 
 void ssd1306_command(ssd1306_t *ssd, uint8_t command) {
   ssd->port_buffer[1] = command;
-  i2c_write_blocking(
+  i2c_write_timeout_us(
     ssd->i2c_port,
     ssd->address,
     ssd->port_buffer,
     2,
-    false
+    false,
+    I2C_PRAZO_US(2)
   );
 }
 
@@ -59,12 +62,13 @@ void ssd1306_send_data(ssd1306_t *ssd) {
   ssd1306_command(ssd, SET_PAGE_ADDR);
   ssd1306_command(ssd, 0);
   ssd1306_command(ssd, ssd->pages - 1);
-  i2c_write_blocking(
+  i2c_write_timeout_us(
     ssd->i2c_port,
     ssd->address,
     ssd->ram_buffer,
     ssd->bufsize,
-    false
+    false,
+    I2C_PRAZO_US(ssd->bufsize)
   );
 }
 
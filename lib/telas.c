@@ -0,0 +1,176 @@
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include "tendencia.h"
+#include "derivadas.h"
+#include "telas.h"
+
+#define LINHA_MAX 17 // 15 caracteres de 8 px cabem entre as bordas
+
+// Rótulo e valor separados por uma linha horizontal abaixo (telas 2 a 4)
+static void campo(ssd1306_t *ssd, const char *rotulo, uint8_t x_valor, const char *valor, uint8_t y) {
+    ssd1306_draw_string(ssd, rotulo, 4, y);
+    ssd1306_draw_string(ssd, valor, x_valor, y);
+}
+
+static void tela_inicial(ssd1306_t *ssd, const telas_dados_t *d) {
+    // Cabeçalho
+    ssd1306_draw_string(ssd, "EMB ESTACAO", 20, 3);
+    ssd1306_draw_string(ssd, "METEOROLOGICA", 12, 12);
+
+    ssd1306_line(ssd, 1, 21, 126, 21, true);
+
+    // Status da conexão Wi-Fi
+    ssd1306_draw_string(ssd, "Conexao Wi-Fi:", 8, 23);
+    switch (d->wifi) {
+        case TELAS_WIFI_INICIANDO: ssd1306_draw_string(ssd, "Iniciando...", 16, 32); break;
+        case TELAS_WIFI_CONECTANDO: ssd1306_draw_string(ssd, "Conectando...", 12, 32); break;
+        case TELAS_WIFI_FALHA: ssd1306_draw_string(ssd, "Falha!", 40, 32); break;
+        case TELAS_WIFI_CONECTADO: ssd1306_draw_string(ssd, "Conectado!", 24, 32); break;
+        default: ssd1306_draw_string(ssd, "Erro!", 44, 32); break;
+    }
+
+    ssd1306_line(ssd, 1, 41, 126, 41, true);
+
+    // IP do WebServer
+    ssd1306_draw_string(ssd, "IP Web Server:", 8, 43);
+    ssd1306_draw_string(ssd, d->ip ? d->ip : "", 16, 52);
+}
+
+static void tela_geral(ssd1306_t *ssd, const telas_dados_t *d) {
+    char linha[LINHA_MAX];
+    ssd1306_draw_string(ssd, "Dados do local:", 4, 3);
+    ssd1306_line(ssd, 1, 12, 126, 12, true);
+
+    // '?' depois do valor: último valor lido, o sensor não respondeu no ciclo atual
+    snprintf(linha, sizeof(linha), "%.1fC%s", d->temperatura, d->velhos & AMOSTRA_VELHA_TEMPERATURA ? "?" : "");
+    campo(ssd, "Tem:", 40, linha, 15);
+    ssd1306_line(ssd, 1, 25, 126, 25, true);
+
+    snprintf(linha, sizeof(linha), "%.2fkPa%s", d->pressao_kpa, d->velhos & AMOSTRA_VELHA_PRESSAO ? "?" : "");
+    campo(ssd, "Pre:", 40, linha, 28);
+    ssd1306_line(ssd, 1, 38, 126, 38, true);
+
+    snprintf(linha, sizeof(linha), "%.0fm%s", d->altitude, d->velhos & AMOSTRA_VELHA_PRESSAO ? "?" : "");
+    campo(ssd, "Alt:", 40, linha, 41);
+    ssd1306_line(ssd, 1, 51, 126, 51, true);
+
+    snprintf(linha, sizeof(linha), "%.1f%%%s", d->umidade, d->velhos & AMOSTRA_VELHA_UMIDADE ? "?" : "");
+    campo(ssd, "Umi:", 40, linha, 53);
+}
+
+// Telas 3 e 4: valor atual, limites e estado do alerta
+static void tela_limites(ssd1306_t *ssd, const char *titulo, uint8_t x_titulo, const char *fmt, float atual, float min,
+                         float max, int8_t alerta, bool velho, const char *acima, const char *abaixo) {
+    char linha[LINHA_MAX];
+    ssd1306_draw_string(ssd, titulo, x_titulo, 3);
+    ssd1306_line(ssd, 1, 12, 126, 12, true);
+
+    snprintf(linha, sizeof(linha), fmt, atual);
+    campo(ssd, "Atual:", 56, linha, 15);
+    ssd1306_line(ssd, 1, 25, 126, 25, true);
+
+    snprintf(linha, sizeof(linha), fmt, min);
+    campo(ssd, "Min:", 40, linha, 28);
+    ssd1306_line(ssd, 1, 38, 126, 38, true);
+
+    snprintf(linha, sizeof(linha), fmt, max);
+    campo(ssd, "Max:", 40, linha, 41);
+    ssd1306_line(ssd, 1, 51, 126, 51, true);
+
+    if (velho) {
+        // Sem leitura o alerta fica como estava: o da última leitura válida, ou desligado se ainda não houve nenhuma
+        ssd1306_draw_string(ssd, "Sem leitura", 20, 53);
+    } else if (alerta > 0) {
+        ssd1306_draw_string(ssd, acima, 2, 53);
+    } else if (alerta < 0) {
+        ssd1306_draw_string(ssd, abaixo, 2, 53);
+    } else {
+        ssd1306_draw_string(ssd, "Status: Ok", 24, 53);
+    }
+}
+
+static void tela_temperatura(ssd1306_t *ssd, const telas_dados_t *d) {
+    tela_limites(ssd, "TEMPERATURA", 20, "%.1fC", d->temperatura, d->temperatura_min, d->temperatura_max,
+                 d->alerta_temperatura, d->velhos & AMOSTRA_VELHA_TEMPERATURA, "Alerta: T > Max", "Alerta: T < Min");
+}
+
+static void tela_umidade(ssd1306_t *ssd, const telas_dados_t *d) {
+    tela_limites(ssd, "UMIDADE", 36, "%.1f%%", d->umidade, d->umidade_min, d->umidade_max, d->alerta_umidade,
+                 d->velhos & AMOSTRA_VELHA_UMIDADE, "Alerta: U > Max", "Alerta: U < Min");
+}
+
+static void tela_tendencia(ssd1306_t *ssd, const telas_dados_t *d) {
+    char linha[LINHA_MAX];
+    ssd1306_draw_string(ssd, "TENDENCIA", 28, 3);
+    ssd1306_line(ssd, 1, 12, 126, 12, true);
+
+    // Variação de cada janela em hPa
+    static const char *rotulos[TENDENCIA_JANELAS] = { "1h:", "3h:" };
+    for (int j = 0; j < TENDENCIA_JANELAS; j++) {
+        const tendencia_janela_t *w = tendencia_janela(j);
+        if (w->valida) {
+            snprintf(linha, sizeof(linha), "%s%+.2fhPa", rotulos[j], w->inclinacao * w->pontos * TENDENCIA_PASSO_S / 3600.0f);
+        } else {
+            snprintf(linha, sizeof(linha), "%s --", rotulos[j]);
+        }
+        ssd1306_draw_string(ssd, linha, 4, 15 + 9 * j);
+    }
+    const tendencia_janela_t *longa = tendencia_janela(1);
+    ssd1306_draw_string(ssd, longa->valida ? tendencia_texto_classe(longa->classe) : "coletando...", 4, 33);
+
+    ssd1306_line(ssd, 1, 42, 126, 42, true);
+
+    // Previsão em até duas linhas, quebrada no último espaço que cabe
+    const char *previsao = tendencia_texto_previsao(tendencia_zambretti(amostra_derivada(d->amostra, DERIVADA_PRESSAO_MAR, d->derivadas)));
+    size_t n = strlen(previsao), quebra = n;
+    if (n > 15) {
+        for (quebra = 15; quebra > 0 && previsao[quebra] != ' '; quebra--) {
+        }
+    }
+    snprintf(linha, sizeof(linha), "%.*s", (int)quebra, previsao);
+    ssd1306_draw_string(ssd, linha, 4, 45);
+    if (quebra < n) {
+        ssd1306_draw_string(ssd, previsao + quebra + 1, 4, 54);
+    }
+}
+
+static void tela_conforto(ssd1306_t *ssd, const telas_dados_t *d) {
+    char linha[LINHA_MAX];
+    ssd1306_draw_string(ssd, "CONFORTO", 32, 3);
+    ssd1306_line(ssd, 1, 12, 126, 12, true);
+
+    // Calculadas com os valores da amostra mostrada (uma vez por amostra, só com esta tela visível)
+    static const struct { derivada_t d; const char *fmt; } linhas[] = {
+        { DERIVADA_PONTO_ORVALHO, "Orv: %.1fC" },
+        { DERIVADA_INDICE_CALOR, "Sens: %.1fC" },
+        { DERIVADA_UMIDADE_ABSOLUTA, "UA: %.1fg/m3" },
+        { DERIVADA_PRESSAO_MAR, "QNH: %.1f" },
+    };
+    for (int i = 0; i < 4; i++) {
+        float v = amostra_derivada(d->amostra, linhas[i].d, d->derivadas);
+        if (isnan(v)) {
+            snprintf(linha, sizeof(linha), "%.*s --", (int)(strchr(linhas[i].fmt, ':') - linhas[i].fmt + 1), linhas[i].fmt);
+        } else {
+            snprintf(linha, sizeof(linha), linhas[i].fmt, v);
+        }
+        ssd1306_draw_string(ssd, linha, 4, 15 + 12 * i);
+    }
+}
+
+static void (*const telas[TELAS_N + 1])(ssd1306_t *ssd, const telas_dados_t *d) = {
+    [TELA_INICIAL] = tela_inicial,
+    [TELA_GERAL] = tela_geral,
+    [TELA_TEMPERATURA] = tela_temperatura,
+    [TELA_UMIDADE] = tela_umidade,
+    [TELA_TENDENCIA] = tela_tendencia,
+    [TELA_CONFORTO] = tela_conforto,
+};
+
+void telas_desenhar(ssd1306_t *ssd, int tela, const telas_dados_t *d) {
+    ssd1306_fill(ssd, false);
+    ssd1306_rect(ssd, 0, 0, 127, 63, true, false); // Borda principal
+    if (tela >= 1 && tela <= TELAS_N) {
+        telas[tela](ssd, d);
+    }
+}
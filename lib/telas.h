@@ -0,0 +1,51 @@
+#ifndef TELAS_H
+#define TELAS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "ssd1306.h"
+#include "amostra.h"
+
+// Telas do display OLED desenhadas no buffer do ssd1306_t, sem enviar nada pelo I2C.
+// Os valores vêm de telas_dados_t; as grandezas derivadas são calculadas da amostra só pelas telas que as mostram
+// e a tendência é consultada em lib/tendencia.
+
+#define TELAS_N 6 // Telas numeradas de 1 a TELAS_N (trocadas pelos botões A e B)
+
+typedef enum {
+    TELA_INICIAL = 1, // Estado do Wi-Fi e IP
+    TELA_GERAL,       // Temperatura, pressão, altitude e umidade
+    TELA_TEMPERATURA, // Atual, limites e alerta
+    TELA_UMIDADE,     // Atual, limites e alerta
+    TELA_TENDENCIA,   // Tendência da pressão e previsão de Zambretti
+    TELA_CONFORTO,    // Grandezas derivadas
+} tela_t;
+
+// Estado do Wi-Fi mostrado na tela inicial
+typedef enum {
+    TELAS_WIFI_INICIANDO = 1,
+    TELAS_WIFI_CONECTANDO,
+    TELAS_WIFI_FALHA,
+    TELAS_WIFI_CONECTADO,
+} telas_wifi_t;
+
+typedef struct {
+    float temperatura;  // °C
+    float pressao_kpa;
+    float altitude;     // m
+    float umidade;      // %
+    float temperatura_min, temperatura_max;
+    float umidade_min, umidade_max;
+    int wifi;           // telas_wifi_t
+    const char *ip;
+    int8_t alerta_temperatura; // 1 = acima do máximo, -1 = abaixo do mínimo, 0 = normal
+    int8_t alerta_umidade;
+    uint8_t velhos;            // AMOSTRA_VELHA_*: valor marcado com '?' (sensor sem leitura válida)
+    const amostra_t *amostra;        // Amostra mostrada, de onde saem as grandezas derivadas
+    amostra_derivadas_t *derivadas;  // Cache do display para amostra_derivada
+} telas_dados_t;
+
+// Limpa o buffer e desenha a tela (1..TELAS_N; outro valor deixa só a borda)
+void telas_desenhar(ssd1306_t *ssd, int tela, const telas_dados_t *d);
+
+#endif // TELAS_H
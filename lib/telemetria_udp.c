@@ -0,0 +1,112 @@
+#include <string.h>
+#include <math.h>
+#include "pico/stdlib.h"
+#include "pico/cyw43_arch.h"
+#include "lwip/udp.h"
+#include "lwip/pbuf.h"
+#include "telemetria_udp.h"
+
+#if TELEMETRIA_UDP_LOTE < 1 || TELEMETRIA_UDP_LOTE > 64
+#error "TELEMETRIA_UDP_LOTE deve estar entre 1 e 64"
+#endif
+
+_Static_assert(TELEMETRIA_UDP_LOTE <= TELEMETRIA_UDP_LOTE_MAX, "Lote maior que um datagrama");
+
+static struct udp_pcb *pcb_telemetria = NULL;
+static ip_addr_t destino_telemetria;
+static uint16_t porta_telemetria;
+
+static telemetria_amostra_t lote[TELEMETRIA_UDP_LOTE]; // Amostras aguardando envio
+static uint8_t lote_n = 0;
+static uint32_t seq_amostra = 0;
+static uint32_t seq_pacote = 0;
+
+static telemetria_udp_stats_t stats;
+
+bool telemetria_udp_init(const char *destino, uint16_t porta) {
+    if (!ipaddr_aton(destino, &destino_telemetria)) {
+        return false;
+    }
+    porta_telemetria = porta;
+
+    cyw43_arch_lwip_begin();
+    pcb_telemetria = udp_new();
+    if (pcb_telemetria && ip_addr_ismulticast(&destino_telemetria)) {
+        udp_set_multicast_ttl(pcb_telemetria, 1); // Mantém o multicast na rede local
+    }
+    cyw43_arch_lwip_end();
+
+    return pcb_telemetria != NULL;
+}
+
+void telemetria_udp_descarregar(void) {
+    if (!pcb_telemetria || lote_n == 0) {
+        return;
+    }
+
+    u16_t tamanho = sizeof(telemetria_cabecalho_t) + lote_n * sizeof(telemetria_amostra_t);
+
+    cyw43_arch_lwip_begin();
+    // Um único pbuf do pool por datagrama: o datagrama é liberado logo após o envio,
+    // então a telemetria ocupa no máximo uma entrada de PBUF_POOL_SIZE por vez
+    struct pbuf *p = pbuf_alloc(PBUF_TRANSPORT, tamanho, PBUF_POOL);
+    if (!p || p->len != p->tot_len) {
+        // Pool esgotado (ou pacote em cadeia): descarta o lote em vez de competir com o HTTP
+        if (p) {
+            pbuf_free(p);
+        }
+        cyw43_arch_lwip_end();
+        stats.falhas_pbuf++;
+        seq_pacote++; // O receptor enxerga a perda como lacuna na sequência
+        lote_n = 0;
+        return;
+    }
+
+    telemetria_cabecalho_t *cab = (telemetria_cabecalho_t *)p->payload;
+    cab->magica = TELEMETRIA_UDP_MAGICA;
+    cab->versao = TELEMETRIA_UDP_VERSAO;
+    cab->estacao = TELEMETRIA_UDP_ESTACAO;
+    cab->n_amostras = lote_n;
+    cab->reservado = 0;
+    cab->seq_pacote = seq_pacote++;
+    memcpy((uint8_t *)p->payload + sizeof(telemetria_cabecalho_t), lote, lote_n * sizeof(telemetria_amostra_t));
+
+    err_t err = udp_sendto(pcb_telemetria, p, &destino_telemetria, porta_telemetria);
+    pbuf_free(p);
+    cyw43_arch_lwip_end();
+
+    if (err == ERR_OK) {
+        stats.pacotes_enviados++;
+        stats.amostras_enviadas += lote_n;
+    } else {
+        stats.falhas_envio++;
+    }
+    lote_n = 0;
+}
+
+void telemetria_udp_enviar(float temperatura, float umidade, float pressao_kpa, float altitude, uint32_t intervalo_ms,
+                           float tendencia_hpa_3h, uint8_t zambretti) {
+    if (!pcb_telemetria) {
+        return;
+    }
+
+    telemetria_amostra_t *a = &lote[lote_n++];
+    a->seq = seq_amostra++;
+    a->tempo_ms = to_ms_since_boot(get_absolute_time());
+    a->temperatura = (int16_t)(temperatura * 100.0f);
+    a->umidade = (uint16_t)(umidade * 100.0f);
+    a->pressao = (uint32_t)(pressao_kpa * 1000.0f);
+    a->altitude = (int32_t)(altitude * 100.0f);
+    a->intervalo_ms = intervalo_ms;
+    a->tendencia = isnan(tendencia_hpa_3h) ? TELEMETRIA_SEM_TENDENCIA : (int16_t)(tendencia_hpa_3h * 100.0f);
+    a->zambretti = zambretti;
+    a->reservado = 0;
+
+    if (lote_n >= TELEMETRIA_UDP_LOTE) {
+        telemetria_udp_descarregar();
+    }
+}
+
+const telemetria_udp_stats_t *telemetria_udp_stats(void) {
+    return &stats;
+}
@@ -0,0 +1,78 @@
+#ifndef TELEMETRIA_UDP_H
+#define TELEMETRIA_UDP_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Destino padrão dos pacotes (unicast, broadcast ou multicast)
+#ifndef TELEMETRIA_UDP_DESTINO
+#define TELEMETRIA_UDP_DESTINO "239.0.0.77"
+#endif
+
+#ifndef TELEMETRIA_UDP_PORTA
+#define TELEMETRIA_UDP_PORTA 5005
+#endif
+
+// Identificador da estação enviado em todos os pacotes
+#ifndef TELEMETRIA_UDP_ESTACAO
+#define TELEMETRIA_UDP_ESTACAO 1
+#endif
+
+// Quantidade de amostras acumuladas antes de enviar um pacote (1 = envia cada amostra)
+#ifndef TELEMETRIA_UDP_LOTE
+#define TELEMETRIA_UDP_LOTE 1
+#endif
+
+#define TELEMETRIA_UDP_MAGICA 0x57424D45u // "EMBW" em little-endian
+#define TELEMETRIA_UDP_VERSAO 3 // 2: amostra com intervalo_ms; 3: tendência da pressão e previsão
+
+// Cabeçalho do pacote (little-endian)
+typedef struct __attribute__((packed)) {
+    uint32_t magica;     // TELEMETRIA_UDP_MAGICA
+    uint8_t versao;      // TELEMETRIA_UDP_VERSAO
+    uint8_t estacao;     // Identificador da estação
+    uint8_t n_amostras;  // Quantidade de amostras que seguem o cabeçalho
+    uint8_t reservado;
+    uint32_t seq_pacote; // Sequência do pacote (detecção de perdas)
+} telemetria_cabecalho_t;
+
+// Amostra em ponto fixo (little-endian)
+typedef struct __attribute__((packed)) {
+    uint32_t seq;        // Sequência da amostra
+    uint32_t tempo_ms;   // Instante da amostra em ms desde o boot
+    int16_t temperatura; // Centésimos de °C
+    uint16_t umidade;    // Centésimos de %
+    uint32_t pressao;    // Pa
+    int32_t altitude;    // cm
+    uint32_t intervalo_ms; // Intervalo real desde a amostra anterior (período adaptativo)
+    int16_t tendencia;   // Centésimos de hPa/3 h (TELEMETRIA_SEM_TENDENCIA = histórico insuficiente)
+    uint8_t zambretti;   // Previsão de Zambretti 1..32 (0 = sem dados)
+    uint8_t reservado;
+} telemetria_amostra_t;
+
+#define TELEMETRIA_SEM_TENDENCIA INT16_MIN
+
+// Maior lote que cabe em um datagrama sem fragmentação IP (MTU 1500)
+#define TELEMETRIA_UDP_LOTE_MAX ((1472 - sizeof(telemetria_cabecalho_t)) / sizeof(telemetria_amostra_t))
+
+// Contadores do envio
+typedef struct {
+    uint32_t pacotes_enviados;
+    uint32_t amostras_enviadas;
+    uint32_t falhas_pbuf; // Pool de pbufs sem espaço (lote descartado)
+    uint32_t falhas_envio;
+} telemetria_udp_stats_t;
+
+// Inicializa o PCB UDP e resolve o destino
+bool telemetria_udp_init(const char *destino, uint16_t porta);
+
+// Adiciona uma amostra ao lote e envia quando o lote está completo (tendencia_hpa_3h = NAN sem histórico)
+void telemetria_udp_enviar(float temperatura, float umidade, float pressao_kpa, float altitude, uint32_t intervalo_ms,
+                           float tendencia_hpa_3h, uint8_t zambretti);
+
+// Envia imediatamente as amostras acumuladas
+void telemetria_udp_descarregar(void);
+
+const telemetria_udp_stats_t *telemetria_udp_stats(void);
+
+#endif // TELEMETRIA_UDP_H
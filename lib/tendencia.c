@@ -0,0 +1,203 @@
+#include <stdio.h>
+#include <math.h>
+#include "tendencia.h"
+
+#define VAZIO INT32_MIN // Passo sem amostras
+
+// Somas da regressão de uma janela (y em décimos de Pa: tudo inteiro e exato ao entrar e sair)
+typedef struct {
+    int64_t n, sx, sy, sxy, sxx;
+} somas_t;
+
+static int32_t anel[TENDENCIA_HISTORICO]; // Média de cada passo em décimos de Pa
+static uint16_t pos = 0;                  // Posição do ponto mais recente
+static somas_t somas[TENDENCIA_JANELAS];
+static tendencia_janela_t janelas[TENDENCIA_JANELAS];
+
+// Passo em acumulação
+static bool iniciado = false;
+static uint64_t passo_atual;
+static int64_t acumulado;
+static uint32_t acumulado_n;
+
+static const char *textos_previsao[] = {
+    "Sem dados",
+    // Pressão caindo (1-9)
+    "Bom tempo estavel", "Bom tempo", "Bom, menos estavel", "Razoavel, chuva depois", "Pancadas, piorando",
+    "Instavel, chuva depois", "Chuva as vezes, piorando", "Chuva, muito instavel", "Muito instavel, chuva",
+    // Pressão estável (10-19)
+    "Bom tempo estavel", "Bom tempo", "Bom, talvez pancadas", "Razoavel, pancadas", "Pancadas e sol",
+    "Variavel, alguma chuva", "Instavel, chuva as vezes", "Chuva frequente", "Muito instavel, chuva",
+    "Tempestade, muita chuva",
+    // Pressão subindo (20-32)
+    "Bom tempo estavel", "Bom tempo", "Melhorando", "Razoavel, melhorando", "Razoavel, pancadas cedo",
+    "Pancadas cedo, melhora", "Variavel, melhorando", "Instavel, abre depois", "Instavel, deve melhorar",
+    "Instavel, abre as vezes", "Muito instavel, aberturas", "Tempestade, pode melhorar", "Tempestade, muita chuva",
+};
+
+static const char *textos_classe[] = {
+    "queda m.rapida", "queda rapida", "queda", "queda lenta", "estavel",
+    "subida lenta", "subida", "subida rapida", "subida m.rapida",
+};
+
+void tendencia_configurar(uint16_t curta, uint16_t longa) {
+    uint16_t tamanhos[TENDENCIA_JANELAS] = { curta, longa };
+    for (int j = 0; j < TENDENCIA_JANELAS; j++) {
+        uint16_t p = tamanhos[j];
+        p = p < 3 ? 3 : p > TENDENCIA_HISTORICO ? TENDENCIA_HISTORICO : p;
+        janelas[j] = (tendencia_janela_t){ .pontos = p, .classe = TENDENCIA_ESTAVEL };
+        somas[j] = (somas_t){0};
+    }
+    for (int i = 0; i < TENDENCIA_HISTORICO; i++) {
+        anel[i] = VAZIO;
+    }
+    iniciado = false;
+}
+
+static tendencia_classe_t classificar(float variacao_3h) {
+    float v = fabsf(variacao_3h);
+    int nivel = v < 0.1f ? 0 : v < 1.6f ? 1 : v < 3.6f ? 2 : v <= 6.0f ? 3 : 4;
+    return (tendencia_classe_t)(variacao_3h < 0 ? -nivel : nivel);
+}
+
+static void calcular(int j) {
+    const somas_t *s = &somas[j];
+    tendencia_janela_t *w = &janelas[j];
+    w->n = (uint16_t)s->n;
+    w->valida = s->n >= 3 && s->n * 2 >= w->pontos;
+    if (!w->valida) {
+        return;
+    }
+    double den = (double)(s->n * s->sxx - s->sx * s->sx);
+    if (den <= 0) {
+        w->valida = false;
+        return;
+    }
+    double b = (double)(s->n * s->sxy - s->sx * s->sy) / den; // Décimos de Pa por passo
+    w->inclinacao = (float)(b / 1000.0 * (3600.0 / TENDENCIA_PASSO_S));
+    w->variacao_3h = 3.0f * w->inclinacao;
+    w->classe = classificar(w->variacao_3h);
+}
+
+// Fecha um passo: todos os pontos envelhecem (x -> x - 1), o que sai da janela é retirado e o novo entra com x = 0
+static void fechar_passo(int32_t y) {
+    pos = (uint16_t)((pos + 1) % TENDENCIA_HISTORICO);
+    for (int j = 0; j < TENDENCIA_JANELAS; j++) {
+        somas_t *s = &somas[j];
+        int64_t p = janelas[j].pontos;
+
+        // Σ(x-1)y = Σxy - Σy; Σ(x-1)² = Σx² - 2Σx + n; Σ(x-1) = Σx - n
+        s->sxy -= s->sy;
+        s->sxx += s->n - 2 * s->sx;
+        s->sx -= s->n;
+
+        // O ponto com idade p (x = -p) sai; lido antes de ser sobrescrito quando p = TENDENCIA_HISTORICO
+        int32_t velho = anel[(pos + TENDENCIA_HISTORICO - p) % TENDENCIA_HISTORICO];
+        if (velho != VAZIO) {
+            s->n--;
+            s->sy -= velho;
+            s->sx += p;
+            s->sxx -= p * p;
+            s->sxy += p * velho;
+        }
+
+        if (y != VAZIO) {
+            s->n++;
+            s->sy += y;
+        }
+    }
+    anel[pos] = y;
+    for (int j = 0; j < TENDENCIA_JANELAS; j++) {
+        calcular(j);
+    }
+}
+
+void tendencia_observar(float pressao_pa, uint64_t agora_us) {
+    uint64_t passo = agora_us / ((uint64_t)TENDENCIA_PASSO_S * 1000000);
+    if (!iniciado) {
+        iniciado = true;
+        passo_atual = passo;
+        acumulado = 0;
+        acumulado_n = 0;
+    }
+    if (passo > passo_atual) {
+        fechar_passo(acumulado_n ? (int32_t)(acumulado / acumulado_n) : VAZIO);
+        // Passos sem nenhuma amostra (período de amostragem longo ou falha do sensor)
+        uint64_t vazios = passo - passo_atual - 1;
+        if (vazios > TENDENCIA_HISTORICO) {
+            vazios = TENDENCIA_HISTORICO;
+        }
+        while (vazios--) {
+            fechar_passo(VAZIO);
+        }
+        passo_atual = passo;
+        acumulado = 0;
+        acumulado_n = 0;
+    }
+    acumulado += (int64_t)lroundf(pressao_pa * 10.0f);
+    acumulado_n++;
+}
+
+const tendencia_janela_t *tendencia_janela(int janela) {
+    return (janela >= 0 && janela < TENDENCIA_JANELAS) ? &janelas[janela] : NULL;
+}
+
+// Janela longa quando já cobre o bastante; senão, a curta
+static const tendencia_janela_t *janela_referencia(void) {
+    return janelas[1].valida ? &janelas[1] : janelas[0].valida ? &janelas[0] : NULL;
+}
+
+float tendencia_variacao_3h(void) {
+    const tendencia_janela_t *w = janela_referencia();
+    return w ? w->variacao_3h : NAN;
+}
+
+uint8_t tendencia_zambretti(float pressao_mar_hpa) {
+    const tendencia_janela_t *w = janela_referencia();
+    if (!w || isnan(pressao_mar_hpa)) {
+        return 0;
+    }
+    float z;
+    int min, max;
+    if (w->variacao_3h <= -1.6f) {
+        z = 127.0f - 0.12f * pressao_mar_hpa;
+        min = 1, max = 9;
+    } else if (w->variacao_3h >= 1.6f) {
+        z = 185.0f - 0.16f * pressao_mar_hpa;
+        min = 20, max = 32;
+    } else {
+        z = 144.0f - 0.13f * pressao_mar_hpa;
+        min = 10, max = 19;
+    }
+    int zi = (int)lroundf(z);
+    return (uint8_t)(zi < min ? min : zi > max ? max : zi);
+}
+
+const char *tendencia_texto_previsao(uint8_t z) {
+    return z < sizeof(textos_previsao) / sizeof(textos_previsao[0]) ? textos_previsao[z] : textos_previsao[0];
+}
+
+const char *tendencia_texto_classe(tendencia_classe_t c) {
+    return textos_classe[c - TENDENCIA_QUEDA_MUITO_RAPIDA];
+}
+
+size_t tendencia_relatorio(char *buf, size_t cap, float pressao_mar_hpa) {
+    uint8_t z = tendencia_zambretti(pressao_mar_hpa);
+    size_t len = snprintf(buf, cap, "{\"passo_s\":%d,\"janelas\":[", TENDENCIA_PASSO_S);
+    for (int j = 0; j < TENDENCIA_JANELAS && len < cap; j++) {
+        const tendencia_janela_t *w = &janelas[j];
+        if (w->valida) {
+            len += snprintf(buf + len, cap - len,
+                            "%s{\"minutos\":%u,\"pontos\":%u,\"hpa_h\":%.3f,\"hpa_3h\":%.2f,\"classe\":\"%s\"}",
+                            j ? "," : "", (unsigned)(w->pontos * TENDENCIA_PASSO_S / 60), w->n,
+                            w->inclinacao, w->variacao_3h, tendencia_texto_classe(w->classe));
+        } else {
+            len += snprintf(buf + len, cap - len, "%s{\"minutos\":%u,\"pontos\":%u,\"hpa_h\":null}",
+                            j ? "," : "", (unsigned)(w->pontos * TENDENCIA_PASSO_S / 60), w->n);
+        }
+    }
+    if (len < cap) {
+        len += snprintf(buf + len, cap - len, "],\"zambretti\":%u,\"previsao\":\"%s\"}", z, tendencia_texto_previsao(z));
+    }
+    return len < cap ? len : cap - 1;
+}
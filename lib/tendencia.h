@@ -0,0 +1,63 @@
+#ifndef TENDENCIA_H
+#define TENDENCIA_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+// Tendência barométrica por regressão linear móvel e previsão de Zambretti.
+// As amostras são agrupadas em médias de TENDENCIA_PASSO_S; cada janela mantém as somas da regressão
+// (n, Σx, Σy, Σxy, Σx²) em inteiros exatos e as atualiza em O(1) quando um ponto entra ou sai do anel,
+// sem reler o histórico. x é a idade do ponto em passos (0 = mais recente, negativo = mais antigo).
+
+#define TENDENCIA_PASSO_S 60       // Duração de cada ponto do histórico
+#define TENDENCIA_HISTORICO 180    // Pontos no anel (maior janela possível: 3 h)
+#define TENDENCIA_JANELAS 2
+#define TENDENCIA_JANELA_CURTA 60  // Padrão: 1 h
+#define TENDENCIA_JANELA_LONGA 180 // Padrão: 3 h
+
+// Classificação pela variação equivalente em 3 h (faixas usuais de tendência barométrica, hPa/3 h)
+typedef enum {
+    TENDENCIA_QUEDA_MUITO_RAPIDA = -4, // < -6,0
+    TENDENCIA_QUEDA_RAPIDA,            // -6,0 a -3,6
+    TENDENCIA_QUEDA,                   // -3,5 a -1,6
+    TENDENCIA_QUEDA_LENTA,             // -1,5 a -0,1
+    TENDENCIA_ESTAVEL,                 // |variação| < 0,1
+    TENDENCIA_SUBIDA_LENTA,
+    TENDENCIA_SUBIDA,
+    TENDENCIA_SUBIDA_RAPIDA,
+    TENDENCIA_SUBIDA_MUITO_RAPIDA
+} tendencia_classe_t;
+
+typedef struct {
+    uint16_t pontos;       // Tamanho da janela em passos
+    bool valida;           // Pontos suficientes (metade da janela)
+    uint16_t n;            // Pontos presentes na janela
+    float inclinacao;      // hPa por hora
+    float variacao_3h;     // Inclinação expressa em hPa/3 h
+    tendencia_classe_t classe;
+} tendencia_janela_t;
+
+// Define o tamanho das janelas em passos (até TENDENCIA_HISTORICO) e apaga o histórico
+void tendencia_configurar(uint16_t curta, uint16_t longa);
+
+// Registra uma amostra de pressão (Pa) no instante agora_us; custo O(1) (por passo decorrido)
+void tendencia_observar(float pressao_pa, uint64_t agora_us);
+
+// Resultado de uma janela (0 = curta, 1 = longa)
+const tendencia_janela_t *tendencia_janela(int janela);
+
+// Variação em hPa/3 h da janela longa (ou da curta enquanto a longa não cobre o bastante); NAN sem dados
+float tendencia_variacao_3h(void);
+
+// Previsão de Zambretti (1..32, 0 = sem dados) a partir da pressão ao nível do mar (hPa) e da janela longa
+uint8_t tendencia_zambretti(float pressao_mar_hpa);
+
+// Texto curto da previsão (português) e da classe da tendência
+const char *tendencia_texto_previsao(uint8_t z);
+const char *tendencia_texto_classe(tendencia_classe_t c);
+
+// Gera um JSON com as janelas e a previsão
+size_t tendencia_relatorio(char *buf, size_t cap, float pressao_mar_hpa);
+
+#endif // TENDENCIA_H
@@ -0,0 +1,119 @@
+#include <stdio.h>
+#include "pico/stdlib.h"
+#include "hardware/sync.h"
+#include "trace.h"
+
+#if TRACE_HABILITADO
+
+#if (TRACE_TAMANHO & (TRACE_TAMANHO - 1)) != 0
+#error "TRACE_TAMANHO deve ser potência de 2"
+#endif
+
+// Um anel por núcleo: cada núcleo só escreve no seu, então não há disputa entre núcleos.
+// No mesmo núcleo uma IRQ pode interromper o registro; por isso a reserva do índice e a
+// escrita do evento são feitas com as interrupções desligadas (poucas instruções)
+typedef struct {
+    trace_evento_t eventos[TRACE_TAMANHO];
+    volatile uint32_t cabeca; // Total de eventos já escritos
+} trace_anel_t;
+
+static trace_anel_t aneis[2];
+
+static const char *const nomes[TR_N] = {
+    [TR_CYW43_POLL] = "cyw43_arch_poll",
+    [TR_LER_BMP280] = "ler_bmp280",
+    [TR_LER_AHT10] = "ler_aht10",
+    [TR_ATUALIZAR_VALORES] = "atualizar_valores",
+    [TR_ATUALIZAR_MATRIZ] = "atualizar_matriz",
+    [TR_ATUALIZAR_DISPLAY] = "atualizar_display",
+    [TR_REDE] = "rede",
+    [TR_HTTP_RECV] = "http_recv",
+    [TR_GPIO_IRQ] = "gpio_irq_handler",
+    [TR_ALARME_BUZZER] = "alarm_callback_buzzer",
+};
+
+void __not_in_flash_func(trace_registrar)(trace_id_t id, uint8_t tipo) {
+    uint32_t tempo = time_us_32();
+    trace_anel_t *anel = &aneis[get_core_num()];
+
+    uint32_t estado = save_and_disable_interrupts();
+    trace_evento_t *e = &anel->eventos[anel->cabeca & (TRACE_TAMANHO - 1)];
+    e->tempo_us = tempo;
+    e->id = id;
+    e->tipo = tipo;
+    anel->cabeca++;
+    restore_interrupts(estado);
+}
+
+// Tamanho máximo de um evento formatado
+#define TRACE_EVENTO_JSON_MAX 96
+
+const char *trace_nome(uint8_t id) {
+    return id < TR_N ? nomes[id] : "?";
+}
+
+static int formatar_evento(char *buf, size_t cap, const trace_evento_t *e, int core, bool primeiro) {
+    const char *nome = trace_nome(e->id);
+    return snprintf(buf, cap, "%s{\"name\":\"%s\",\"ph\":\"%c\",\"ts\":%lu,\"pid\":0,\"tid\":%d}",
+                    primeiro ? "" : ",\n", nome, e->tipo, (unsigned long)e->tempo_us, core);
+}
+
+// Primeiro evento válido do anel considerando no máximo max eventos
+static uint32_t primeiro_evento(uint32_t cabeca, uint32_t max) {
+    uint32_t n = cabeca < TRACE_TAMANHO ? cabeca : TRACE_TAMANHO;
+    if (n > max) {
+        n = max;
+    }
+    return cabeca - n;
+}
+
+uint32_t trace_recentes(int core, trace_evento_t *dest, uint32_t max) {
+    uint32_t cabeca = aneis[core].cabeca;
+    uint32_t n = 0;
+    for (uint32_t i = primeiro_evento(cabeca, max); i != cabeca; i++) {
+        dest[n++] = aneis[core].eventos[i & (TRACE_TAMANHO - 1)];
+    }
+    return n;
+}
+
+size_t trace_exportar_json(char *buf, size_t cap) {
+    static const char inicio[] = "{\"traceEvents\":[\n";
+    static const char fim[] = "\n]}\n";
+    if (cap < sizeof(inicio) + sizeof(fim)) {
+        return 0;
+    }
+
+    // Quantos eventos cabem, divididos entre os núcleos
+    uint32_t max_por_core = (cap - sizeof(inicio) - sizeof(fim)) / TRACE_EVENTO_JSON_MAX / 2;
+
+    size_t len = snprintf(buf, cap, "%s", inicio);
+    bool primeiro = true;
+    for (int core = 0; core < 2; core++) {
+        uint32_t cabeca = aneis[core].cabeca;
+        for (uint32_t i = primeiro_evento(cabeca, max_por_core); i != cabeca; i++) {
+            trace_evento_t e = aneis[core].eventos[i & (TRACE_TAMANHO - 1)];
+            len += formatar_evento(buf + len, cap - len, &e, core, primeiro);
+            primeiro = false;
+        }
+    }
+    len += snprintf(buf + len, cap - len, "%s", fim);
+    return len < cap ? len : cap - 1;
+}
+
+void trace_imprimir_json(void) {
+    char linha[TRACE_EVENTO_JSON_MAX];
+    printf("{\"traceEvents\":[\n");
+    bool primeiro = true;
+    for (int core = 0; core < 2; core++) {
+        uint32_t cabeca = aneis[core].cabeca;
+        for (uint32_t i = primeiro_evento(cabeca, TRACE_TAMANHO); i != cabeca; i++) {
+            trace_evento_t e = aneis[core].eventos[i & (TRACE_TAMANHO - 1)];
+            formatar_evento(linha, sizeof(linha), &e, core, primeiro);
+            fputs(linha, stdout);
+            primeiro = false;
+        }
+    }
+    printf("\n]}\n");
+}
+
+#endif // TRACE_HABILITADO
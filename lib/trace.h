@@ -0,0 +1,70 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "pico/stdlib.h"
+
+// Defina TRACE_HABILITADO como 0 para remover todo o trace do binário
+#ifndef TRACE_HABILITADO
+#define TRACE_HABILITADO 1
+#endif
+
+// Eventos por núcleo (potência de 2)
+#ifndef TRACE_TAMANHO
+#define TRACE_TAMANHO 256
+#endif
+
+// Identificadores das fases rastreadas
+typedef enum {
+    TR_CYW43_POLL,
+    TR_LER_BMP280,
+    TR_LER_AHT10,
+    TR_ATUALIZAR_VALORES,
+    TR_ATUALIZAR_MATRIZ,
+    TR_ATUALIZAR_DISPLAY,
+    TR_REDE,           // Envio UDP/MQTT
+    TR_HTTP_RECV,
+    TR_GPIO_IRQ,
+    TR_ALARME_BUZZER,
+    TR_N
+} trace_id_t;
+
+#define TRACE_INICIO_EVT 'B'
+#define TRACE_FIM_EVT 'E'
+
+// Evento de 8 bytes
+typedef struct {
+    uint32_t tempo_us;
+    uint8_t id;
+    uint8_t tipo; // TRACE_INICIO_EVT ou TRACE_FIM_EVT
+    uint16_t reservado;
+} trace_evento_t;
+
+#if TRACE_HABILITADO
+
+void trace_registrar(trace_id_t id, uint8_t tipo);
+
+#define TRACE_INICIO(id) trace_registrar((id), TRACE_INICIO_EVT)
+#define TRACE_FIM(id) trace_registrar((id), TRACE_FIM_EVT)
+
+// Gera o JSON do Chrome trace (chrome://tracing, Perfetto) com os eventos mais recentes que cabem em buf
+size_t trace_exportar_json(char *buf, size_t cap);
+
+// Imprime todos os eventos em JSON na saída padrão (USB)
+void trace_imprimir_json(void);
+
+// Copia os até max eventos mais recentes do núcleo para dest (do mais antigo ao mais novo) e retorna quantos
+uint32_t trace_recentes(int core, trace_evento_t *dest, uint32_t max);
+
+// Nome da fase rastreada ("?" se o id não existe)
+const char *trace_nome(uint8_t id);
+
+#else
+
+#define TRACE_INICIO(id) ((void)0)
+#define TRACE_FIM(id) ((void)0)
+
+#endif
+
+#endif // TRACE_H
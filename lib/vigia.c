@@ -0,0 +1,237 @@
+#include <stdio.h>
+#include <string.h>
+#include "pico/stdlib.h"
+#include "hardware/watchdog.h"
+#include "agendador.h"
+#include "trace.h"
+#include "log.h"
+#include "memoria.h"
+#include "vigia.h"
+
+#define VIGIA_MAGICO 0x56494741u // "VIGA"
+#define VIGIA_NOME_MAX 16
+
+// Registradores scratch 0 a 3 (os 4 a 7 são usados pelo SDK em watchdog_reboot).
+// Sobrevivem ao reinício pelo watchdog e são zerados ao ligar a alimentação.
+#define SCRATCH_MAGICO 0    // VIGIA_MAGICO: os demais são válidos
+#define SCRATCH_REINICIOS 1 // Reinícios pelo watchdog desde que a placa foi ligada
+#define SCRATCH_DETECCAO 2  // Instante da detecção em ms desde o boot (0 = sem diagnóstico)
+#define SCRATCH_REINICIO 3  // Instante previsto do reinício (última alimentação + VIGIA_TIMEOUT_MS)
+
+typedef struct {
+    const char *nome;
+    uint32_t prazo_ms;
+    volatile uint32_t ultimo_ms; // Último sinal
+    volatile uint32_t sinais;
+    uint32_t intervalo_max_ms;   // Maior intervalo entre sinais visto pela conferência
+} atividade_t;
+
+// Diagnóstico gravado pela interrupção antes do reinício
+typedef struct {
+    uint32_t magico;
+    char atividade[VIGIA_NOME_MAX]; // Atividade sem sinal
+    uint32_t sem_sinal_ms;
+    char tarefa[VIGIA_NOME_MAX];    // Tarefa do agendador em execução ("" = entre tarefas)
+    uint32_t tarefa_ms;             // Há quanto tempo a tarefa executava
+    uint32_t deteccao_us;           // time_us_32 na detecção (referência dos eventos)
+    uint32_t n_eventos;
+    trace_evento_t eventos[VIGIA_EVENTOS];
+} diagnostico_t;
+
+// Fora das seções zeradas pelo crt0: o conteúdo do boot anterior continua lá após o reinício
+static diagnostico_t __uninitialized_ram(diagnostico_gravado);
+
+static atividade_t atividades[VIGIA_MAX];
+static int n_atividades = 0;
+static repeating_timer_t timer_vigia;
+static volatile bool parado = false; // Diagnóstico gravado: o watchdog não é mais alimentado
+static uint32_t alimentado_ms;       // Última alimentação
+
+// Reinício anterior
+static bool pelo_watchdog = false;
+static bool com_diagnostico = false;
+static diagnostico_t anterior;
+static uint32_t reinicios = 0;
+static uint32_t ate_reinicio_ms = 0;     // Da detecção ao reinício
+static volatile int32_t recuperacao_ms = -1; // Da detecção até todas as atividades darem sinal (-1 = não medida)
+
+static uint32_t agora_ms(void) {
+    return to_ms_since_boot(get_absolute_time());
+}
+
+int vigia_registrar(const char *nome, uint32_t prazo_ms) {
+    if (n_atividades >= VIGIA_MAX) {
+        return -1;
+    }
+    atividade_t *a = &atividades[n_atividades];
+    a->nome = nome;
+    a->prazo_ms = prazo_ms;
+    a->ultimo_ms = agora_ms();
+    return n_atividades++;
+}
+
+void vigia_prazo(int id, uint32_t prazo_ms) {
+    if (id >= 0 && id < n_atividades) {
+        atividades[id].prazo_ms = prazo_ms;
+    }
+}
+
+void vigia_sinal(int id) {
+    if (id >= 0 && id < n_atividades) {
+        atividades[id].ultimo_ms = agora_ms();
+        atividades[id].sinais++;
+    }
+}
+
+static void copiar_nome(char *dest, const char *nome) {
+    strncpy(dest, nome, VIGIA_NOME_MAX - 1);
+    dest[VIGIA_NOME_MAX - 1] = '\0';
+}
+
+// Executada na interrupção: só grava, a impressão fica para o próximo boot
+static void gravar_diagnostico(const atividade_t *a, uint32_t sem_sinal, uint32_t agora) {
+    diagnostico_t *d = &diagnostico_gravado;
+    copiar_nome(d->atividade, a->nome);
+    d->sem_sinal_ms = sem_sinal;
+    uint32_t inicio_us;
+    int tarefa = agendador_tarefa_atual(&inicio_us);
+    d->deteccao_us = time_us_32();
+    copiar_nome(d->tarefa, agendador_nome(tarefa));
+    d->tarefa_ms = tarefa >= 0 ? (d->deteccao_us - inicio_us) / 1000 : 0;
+#if TRACE_HABILITADO
+    d->n_eventos = trace_recentes(0, d->eventos, VIGIA_EVENTOS);
+#else
+    d->n_eventos = 0;
+#endif
+    d->magico = VIGIA_MAGICO;
+
+    watchdog_hw->scratch[SCRATCH_DETECCAO] = agora ? agora : 1;
+    watchdog_hw->scratch[SCRATCH_REINICIO] = alimentado_ms + VIGIA_TIMEOUT_MS;
+    LOG(LOG_VIGIA_PARADA, (uint32_t)(a - atividades), sem_sinal);
+}
+
+static bool conferir(repeating_timer_t *rt) {
+    MEMORIA_SONDA_IRQ();
+    if (parado) {
+        return true; // Aguarda o reinício
+    }
+    uint32_t agora = agora_ms();
+    bool todas_sinalizaram = true;
+    for (int i = 0; i < n_atividades; i++) {
+        atividade_t *a = &atividades[i];
+        uint32_t sem_sinal = agora - a->ultimo_ms;
+        if (sem_sinal > a->prazo_ms) {
+            gravar_diagnostico(a, sem_sinal, agora);
+            parado = true;
+            return true;
+        }
+        if (sem_sinal > a->intervalo_max_ms) {
+            a->intervalo_max_ms = sem_sinal;
+        }
+        todas_sinalizaram &= a->sinais > 0;
+    }
+    watchdog_update();
+    alimentado_ms = agora;
+
+    // Primeira vez com todas as atividades em dia depois de um reinício pelo watchdog
+    if (com_diagnostico && recuperacao_ms < 0 && todas_sinalizaram) {
+        recuperacao_ms = (int32_t)(ate_reinicio_ms + agora);
+        LOG(LOG_VIGIA_RECUPERADO, (uint32_t)recuperacao_ms, ate_reinicio_ms);
+    }
+    return true;
+}
+
+static const char *nome_evento(const trace_evento_t *e) {
+#if TRACE_HABILITADO
+    return trace_nome(e->id);
+#else
+    return "?";
+#endif
+}
+
+void vigia_imprimir(void) {
+    if (!pelo_watchdog) {
+        return;
+    }
+    printf("Reinicio pelo watchdog (%lu desde que a placa foi ligada)\n", (unsigned long)reinicios);
+    if (!com_diagnostico) {
+        printf("  Sem diagnostico: travamento com as interrupcoes desligadas\n");
+        return;
+    }
+    printf("  Atividade \"%s\" sem sinal ha %lu ms; tarefa em execucao: \"%s\" ha %lu ms\n", anterior.atividade,
+           (unsigned long)anterior.sem_sinal_ms, anterior.tarefa[0] ? anterior.tarefa : "nenhuma",
+           (unsigned long)anterior.tarefa_ms);
+    for (uint32_t i = 0; i < anterior.n_eventos && i < VIGIA_EVENTOS; i++) {
+        const trace_evento_t *e = &anterior.eventos[i];
+        printf("  %8.3f ms %c %s\n", -(double)(anterior.deteccao_us - e->tempo_us) / 1000.0, e->tipo, nome_evento(e));
+    }
+}
+
+void vigia_iniciar(void) {
+    bool scratch_valido = watchdog_hw->scratch[SCRATCH_MAGICO] == VIGIA_MAGICO;
+    reinicios = scratch_valido ? watchdog_hw->scratch[SCRATCH_REINICIOS] : 0;
+    pelo_watchdog = watchdog_enable_caused_reboot(); // Não conta os reinícios por watchdog_reboot
+    if (pelo_watchdog) {
+        reinicios++;
+        com_diagnostico = scratch_valido && watchdog_hw->scratch[SCRATCH_DETECCAO] &&
+                          diagnostico_gravado.magico == VIGIA_MAGICO;
+        if (com_diagnostico) {
+            anterior = diagnostico_gravado;
+            ate_reinicio_ms = watchdog_hw->scratch[SCRATCH_REINICIO] - watchdog_hw->scratch[SCRATCH_DETECCAO];
+        }
+    }
+    diagnostico_gravado.magico = 0;
+    watchdog_hw->scratch[SCRATCH_MAGICO] = VIGIA_MAGICO;
+    watchdog_hw->scratch[SCRATCH_REINICIOS] = reinicios;
+    watchdog_hw->scratch[SCRATCH_DETECCAO] = 0;
+    vigia_imprimir();
+}
+
+void vigia_armar(void) {
+    uint32_t agora = agora_ms();
+    for (int i = 0; i < n_atividades; i++) {
+        atividades[i].ultimo_ms = agora; // Os prazos contam a partir daqui, não do cadastro
+    }
+    alimentado_ms = agora;
+    watchdog_enable(VIGIA_TIMEOUT_MS, true); // Pausa com o depurador parado
+    add_repeating_timer_ms(VIGIA_PERIODO_MS, conferir, NULL, &timer_vigia);
+}
+
+size_t vigia_relatorio(char *buf, size_t cap) {
+    uint32_t agora = agora_ms();
+    size_t len = snprintf(buf, cap, "{\"timeout_ms\":%u,\"reinicios\":%lu,\"atividades\":[", VIGIA_TIMEOUT_MS,
+                          (unsigned long)reinicios);
+    for (int i = 0; i < n_atividades && len < cap; i++) {
+        const atividade_t *a = &atividades[i];
+        len += snprintf(buf + len, cap - len,
+                        "%s{\"nome\":\"%s\",\"prazo_ms\":%lu,\"sem_sinal_ms\":%lu,\"intervalo_max_ms\":%lu,\"sinais\":%lu}",
+                        i ? "," : "", a->nome, (unsigned long)a->prazo_ms, (unsigned long)(agora - a->ultimo_ms),
+                        (unsigned long)a->intervalo_max_ms, (unsigned long)a->sinais);
+    }
+    if (len < cap) {
+        len += snprintf(buf + len, cap - len, "],\"ultimo\":");
+    }
+    if (len < cap) {
+        if (com_diagnostico) {
+            len += snprintf(buf + len, cap - len,
+                            "{\"atividade\":\"%s\",\"sem_sinal_ms\":%lu,\"tarefa\":\"%s\",\"tarefa_ms\":%lu,"
+                            "\"ate_reinicio_ms\":%lu,\"recuperacao_ms\":%ld,\"eventos\":[",
+                            anterior.atividade, (unsigned long)anterior.sem_sinal_ms, anterior.tarefa,
+                            (unsigned long)anterior.tarefa_ms, (unsigned long)ate_reinicio_ms, (long)recuperacao_ms);
+            for (uint32_t i = 0; i < anterior.n_eventos && i < VIGIA_EVENTOS && len < cap; i++) {
+                const trace_evento_t *e = &anterior.eventos[i];
+                len += snprintf(buf + len, cap - len, "%s{\"nome\":\"%s\",\"ph\":\"%c\",\"antes_us\":%lu}",
+                                i ? "," : "", nome_evento(e), e->tipo, (unsigned long)(anterior.deteccao_us - e->tempo_us));
+            }
+            if (len < cap) {
+                len += snprintf(buf + len, cap - len, "]}");
+            }
+        } else {
+            len += snprintf(buf + len, cap - len, pelo_watchdog ? "{\"atividade\":null}" : "null");
+        }
+    }
+    if (len < cap) {
+        len += snprintf(buf + len, cap - len, "}");
+    }
+    return len < cap ? len : cap - 1;
+}
@@ -0,0 +1,44 @@
+#ifndef VIGIA_H
+#define VIGIA_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "pico/stdlib.h"
+
+// Supervisor do watchdog do RP2040. Cada atividade periódica (amostragem, display, rede) é cadastrada
+// com um prazo e dá sinal de vida com vigia_sinal; uma interrupção de timer confere os prazos a cada
+// VIGIA_PERIODO_MS e só alimenta o watchdog se todas estão em dia.
+// Quando uma atividade atrasa, a interrupção grava o diagnóstico (atividade parada, tarefa do agendador
+// em execução e os últimos eventos do trace) nos registradores scratch e numa área de RAM que o boot
+// não zera, e deixa o watchdog reiniciar o RP2040. No boot seguinte vigia_iniciar imprime o diagnóstico;
+// o tempo de recuperação vai da detecção até todas as atividades voltarem a dar sinal.
+// Um travamento com as interrupções desligadas também reinicia, mas sem diagnóstico.
+
+#define VIGIA_MAX 6
+#define VIGIA_TIMEOUT_MS 2000 // Prazo do watchdog em hardware
+#define VIGIA_PERIODO_MS 250  // Conferência dos prazos
+#define VIGIA_EVENTOS 12      // Eventos do trace (núcleo 0) guardados no diagnóstico
+
+// Cadastra uma atividade que deve dar sinal ao menos a cada prazo_ms e retorna seu id
+int vigia_registrar(const char *nome, uint32_t prazo_ms);
+
+// Altera o prazo (atividades de período variável, como a amostragem adaptativa)
+void vigia_prazo(int id, uint32_t prazo_ms);
+
+// Sinal de vida da atividade (pode ser chamada de IRQ)
+void vigia_sinal(int id);
+
+// Lê e apaga o diagnóstico do reinício anterior e o imprime (no início do main, depois do stdio_init_all)
+void vigia_iniciar(void);
+
+// Imprime o diagnóstico do reinício anterior (nada se não foi pelo watchdog)
+void vigia_imprimir(void);
+
+// Habilita o watchdog e a conferência dos prazos (depois da inicialização, que pode demorar)
+void vigia_armar(void);
+
+// JSON com as atividades, os reinícios pelo watchdog e o diagnóstico do último
+size_t vigia_relatorio(char *buf, size_t cap);
+
+#endif // VIGIA_H
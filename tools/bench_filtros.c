@@ -0,0 +1,163 @@
+// Benchmark dos filtros de lib/filtros.c sobre traços gravados ou sintéticos
+//
+// Compilação: gcc -O2 -Ilib -o bench_filtros tools/bench_filtros.c lib/filtros.c -lm
+// Uso:        ./bench_filtros [-c coluna] [-l limite] [arquivo.csv]
+//
+// O arquivo tem uma amostra por linha com colunas numéricas separadas por vírgula (linhas que não
+// começam com número são ignoradas); -c escolhe a coluna (a partir de 0). Sem arquivo é gerado um
+// traço sintético (deriva lenta + ruído gaussiano + 1% de picos) com o sinal verdadeiro conhecido.
+//
+// Para cada configuração: tempo por amostra, erro RMS contra a referência (sinal verdadeiro ou, no
+// traço gravado, média móvel centrada de 15 amostras) e quantas vezes a saída cruza o limite de alerta
+// (padrão: mediana do traço), que é o que faz a matriz de LEDs piscar.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include "filtros.h"
+
+#define MAX_AMOSTRAS 200000
+#define REPETICOES 20
+
+typedef struct {
+    const char *nome;
+    filtro_estagio_t estagios[FILTRO_ESTAGIOS];
+    int n;
+} config_t;
+
+static const config_t configs[] = {
+    {"bruto", {{FILTRO_NENHUM, 0, 0}}, 0},
+    {"mediana5", {{FILTRO_MEDIANA, 5, 0}}, 1},
+    {"ema0.2", {{FILTRO_EMA, 0.2f, 0}}, 1},
+    {"kalman", {{FILTRO_KALMAN, 1e-4f, 4e-4f}}, 1},
+    {"mediana5+ema0.2", {{FILTRO_MEDIANA, 5, 0}, {FILTRO_EMA, 0.2f, 0}}, 2},
+    {"mediana5+kalman", {{FILTRO_MEDIANA, 5, 0}, {FILTRO_KALMAN, 1e-4f, 4e-4f}}, 2},
+};
+
+static float entrada[MAX_AMOSTRAS], referencia[MAX_AMOSTRAS], saida[MAX_AMOSTRAS];
+
+static double agora_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static double gauss(void) {
+    double u1 = (rand() + 1.0) / (RAND_MAX + 2.0), u2 = (rand() + 1.0) / (RAND_MAX + 2.0);
+    return sqrt(-2.0 * log(u1)) * cos(2.0 * M_PI * u2);
+}
+
+static int gerar_sintetico(void) {
+    int n = 20000;
+    srand(1);
+    for (int i = 0; i < n; i++) {
+        float verdadeiro = 25.0f + 2.0f * sinf(i * 2.0f * (float)M_PI / 5000.0f);
+        float x = verdadeiro + 0.02f * (float)gauss();
+        if (rand() % 100 == 0) {
+            x += (rand() & 1 ? 1.0f : -1.0f) * 0.5f; // Pico isolado (leitura ruim)
+        }
+        referencia[i] = verdadeiro;
+        entrada[i] = x;
+    }
+    return n;
+}
+
+static int ler_csv(const char *caminho, int coluna) {
+    FILE *f = fopen(caminho, "r");
+    if (!f) {
+        perror(caminho);
+        exit(1);
+    }
+    char linha[512];
+    int n = 0;
+    while (n < MAX_AMOSTRAS && fgets(linha, sizeof(linha), f)) {
+        char *p = linha;
+        if (!strchr("0123456789-+.", *p)) {
+            continue;
+        }
+        for (int c = 0; c < coluna && p; c++) {
+            p = strchr(p, ',');
+            p = p ? p + 1 : NULL;
+        }
+        if (p) {
+            entrada[n++] = strtof(p, NULL);
+        }
+    }
+    fclose(f);
+
+    // Referência: média móvel centrada (não causal, só para comparar)
+    for (int i = 0; i < n; i++) {
+        double soma = 0;
+        int k = 0;
+        for (int j = i - 7; j <= i + 7; j++) {
+            if (j >= 0 && j < n) {
+                soma += entrada[j];
+                k++;
+            }
+        }
+        referencia[i] = (float)(soma / k);
+    }
+    return n;
+}
+
+static int comparar(const void *a, const void *b) {
+    float x = *(const float *)a, y = *(const float *)b;
+    return (x > y) - (x < y);
+}
+
+int main(int argc, char **argv) {
+    int coluna = 0;
+    double limite = NAN;
+    const char *arquivo = NULL;
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "-c") && i + 1 < argc) {
+            coluna = atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "-l") && i + 1 < argc) {
+            limite = atof(argv[++i]);
+        } else {
+            arquivo = argv[i];
+        }
+    }
+
+    int n = arquivo ? ler_csv(arquivo, coluna) : gerar_sintetico();
+    if (n == 0) {
+        fprintf(stderr, "Nenhuma amostra\n");
+        return 1;
+    }
+    if (isnan(limite)) {
+        memcpy(saida, entrada, n * sizeof(float));
+        qsort(saida, n, sizeof(float), comparar);
+        limite = saida[n / 2];
+    }
+    printf("%d amostras (%s), limite de alerta %.4f\n\n", n, arquivo ? arquivo : "sintetico", limite);
+    printf("%-18s %10s %12s %10s\n", "filtro", "ns/amostra", "erro_rms", "cruzamentos");
+
+    for (size_t k = 0; k < sizeof(configs) / sizeof(configs[0]); k++) {
+        filtro_canal_t canal;
+        double melhor = 1e30;
+        for (int r = 0; r < REPETICOES; r++) {
+            filtro_configurar(&canal, configs[k].estagios, configs[k].n);
+            double t0 = agora_ns();
+            for (int i = 0; i < n; i++) {
+                saida[i] = filtro_aplicar(&canal, entrada[i]);
+            }
+            double t = agora_ns() - t0;
+            if (t < melhor) {
+                melhor = t;
+            }
+        }
+
+        double erro = 0;
+        int cruzamentos = 0;
+        for (int i = 0; i < n; i++) {
+            erro += (saida[i] - referencia[i]) * (double)(saida[i] - referencia[i]);
+            if (i && (saida[i - 1] >= limite) != (saida[i] >= limite)) {
+                cruzamentos++;
+            }
+        }
+        printf("%-18s %10.1f %12.5f %10d\n", configs[k].nome, melhor / n, sqrt(erro / n), cruzamentos);
+    }
+    return 0;
+}
@@ -0,0 +1,378 @@
+// Micro-benchmarks no host dos caminhos quentes do firmware: conversão, telas, JSON e rotas HTTP
+//
+// Compilação: cmake -S tools -B build-host && cmake --build build-host   (alvo bench_host)
+// Uso:        ./bench_host [-f filtro] [-o resultado.json] [-b referencia.json] [-t tolerancia_%]
+//
+// Cada benchmark é calibrado para rodar ao menos 20 ms por medição e medido 7 vezes; o resultado é a mediana
+// em ns por operação (e o mínimo). A saída é JSON; com -b os tempos são comparados com uma execução
+// anterior salva com -o e o programa sai com 1 se algum ficou mais lento que a tolerância (padrão 10%).
+// Os números são do host: servem para comparar versões do código, não para prever o tempo no RP2040.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "conversao.h"
+#include "derivadas.h"
+#include "tendencia.h"
+#include "ssd1306.h"
+#include "telas.h"
+#include "amostra.h"
+#include "http.h"
+
+#define MEDICOES 7
+#define ALVO_NS 20e6 // Duração de cada medição
+#define MAX_RESULTADOS 64
+
+typedef struct {
+    const char *nome;
+    void (*executar)(uint32_t n); // Executa n operações
+} bench_t;
+
+typedef struct {
+    const char *nome;
+    double ns_op, min_ns_op;
+    uint64_t iteracoes;
+} resultado_t;
+
+static volatile uint32_t sumidouro; // Impede que o compilador descarte o trabalho medido
+
+static double agora_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+// --- Entradas
+
+// Calibração do exemplo do datasheet do BMP280 (adc_T = 519888 -> 25,08 °C; adc_P = 415148 -> 100653 Pa)
+static struct bmp280_calib_param calibracao = {
+    27504, 26435, -1000, 36477, -10685, 3024, 2855, 140, -7, 15500, -14600, 6000,
+};
+
+#define N_ENTRADAS 256 // Potência de 2
+static int32_t adc_t[N_ENTRADAS], adc_p[N_ENTRADAS];
+static uint8_t rajadas[N_ENTRADAS][BMP280_BURST_LEN], quadros_aht20[N_ENTRADAS][AHT20_QUADRO_LEN];
+static float pressoes[N_ENTRADAS];
+
+static void preparar_entradas(void) {
+    srand(1);
+    for (int i = 0; i < N_ENTRADAS; i++) {
+        adc_t[i] = 519888 + rand() % 4096 - 2048;
+        adc_p[i] = 415148 + rand() % 8192 - 4096;
+        uint8_t *r = rajadas[i];
+        r[0] = 0x00, r[1] = 0x8f, r[2] = 0x90, r[3] = 0x00;
+        r[4] = (uint8_t)(adc_p[i] >> 12), r[5] = (uint8_t)(adc_p[i] >> 4), r[6] = (uint8_t)(adc_p[i] << 4);
+        r[7] = (uint8_t)(adc_t[i] >> 12), r[8] = (uint8_t)(adc_t[i] >> 4), r[9] = (uint8_t)(adc_t[i] << 4);
+        uint8_t *q = quadros_aht20[i];
+        q[0] = 0x1c;
+        for (int k = 1; k < AHT20_QUADRO_LEN; k++) {
+            q[k] = (uint8_t)rand();
+        }
+        pressoes[i] = 90000.0f + (float)(rand() % 20000);
+    }
+}
+
+// Estado típico do firmware: entradas das derivadas presentes e histórico de tendência cheio
+static void preparar_estado(void) {
+    derivadas_configurar(0.0f, 101325.0f);
+    derivadas_entrada(DERIVADAS_TEMPERATURA, 25.3f);
+    derivadas_entrada(DERIVADAS_UMIDADE, 61.2f);
+    derivadas_entrada(DERIVADAS_PRESSAO, 100.65f);
+    tendencia_configurar(TENDENCIA_JANELA_CURTA, TENDENCIA_JANELA_LONGA);
+    for (int i = 0; i < 4 * 3600; i++) {
+        tendencia_observar(100650.0f - i * 0.05f, (uint64_t)i * 1000000);
+    }
+}
+
+// --- Conversão
+
+static void b_convert_temp(uint32_t n) {
+    int32_t s = 0;
+    for (uint32_t i = 0; i < n; i++) {
+        s += bmp280_convert_temp(adc_t[i & (N_ENTRADAS - 1)], &calibracao);
+    }
+    sumidouro = (uint32_t)s;
+}
+
+static void b_convert_pressure(uint32_t n) {
+    int32_t s = 0;
+    for (uint32_t i = 0; i < n; i++) {
+        uint32_t k = i & (N_ENTRADAS - 1);
+        s += bmp280_convert_pressure(adc_p[k], adc_t[k], &calibracao);
+    }
+    sumidouro = (uint32_t)s;
+}
+
+static void b_decode_burst(uint32_t n) {
+    int32_t s = 0, t, p;
+    for (uint32_t i = 0; i < n; i++) {
+        if (bmp280_decode_burst(rajadas[i & (N_ENTRADAS - 1)], &t, &p)) {
+            s += t ^ p;
+        }
+    }
+    sumidouro = (uint32_t)s;
+}
+
+static void b_aht20_parse(uint32_t n) {
+    float s = 0;
+    AHT20_Data d;
+    for (uint32_t i = 0; i < n; i++) {
+        if (aht20_parse(quadros_aht20[i & (N_ENTRADAS - 1)], &d)) {
+            s += d.temperature + d.humidity;
+        }
+    }
+    sumidouro = (uint32_t)s;
+}
+
+// Substituto de calculo_altitude (fórmula barométrica com powf)
+static void b_altitude(uint32_t n) {
+    float s = 0;
+    for (uint32_t i = 0; i < n; i++) {
+        s += derivadas_altitude(pressoes[i & (N_ENTRADAS - 1)]);
+    }
+    sumidouro = (uint32_t)s;
+}
+
+// --- Telas do display (só o desenho no buffer)
+
+static ssd1306_t ssd;
+static const amostra_t amostra = {
+    .temperatura = 25.3f, .pressao_kpa = 100.65f, .altitude = 56.0f, .umidade = 61.2f,
+    .temperatura_bruta = 25.31f, .umidade_bruta = 61.18f, .pressao_bruta = 100652,
+};
+static amostra_derivadas_t derivadas_tela;
+static telas_dados_t dados_tela = {
+    .temperatura = 25.3f, .pressao_kpa = 100.65f, .altitude = 56.0f, .umidade = 61.2f,
+    .temperatura_min = 10.0f, .temperatura_max = 35.0f, .umidade_min = 30.0f, .umidade_max = 70.0f,
+    .wifi = TELAS_WIFI_CONECTADO, .ip = "192.168.100.42", .alerta_temperatura = 0, .alerta_umidade = 1,
+    .amostra = &amostra, .derivadas = &derivadas_tela,
+};
+
+static void desenhar(int tela, uint32_t n) {
+    for (uint32_t i = 0; i < n; i++) {
+        dados_tela.temperatura = 25.0f + (i & 7) * 0.1f; // O texto muda como no firmware
+        telas_desenhar(&ssd, tela, &dados_tela);
+    }
+    sumidouro = ssd.ram_buffer[1 + (n & 127)];
+}
+
+static void b_tela1(uint32_t n) { desenhar(TELA_INICIAL, n); }
+static void b_tela2(uint32_t n) { desenhar(TELA_GERAL, n); }
+static void b_tela3(uint32_t n) { desenhar(TELA_TEMPERATURA, n); }
+static void b_tela4(uint32_t n) { desenhar(TELA_UMIDADE, n); }
+static void b_tela5(uint32_t n) { desenhar(TELA_TENDENCIA, n); }
+static void b_tela6(uint32_t n) { desenhar(TELA_CONFORTO, n); }
+
+// --- JSON de /dados e rotas HTTP (mesma amostra das telas)
+
+static char resposta[20000];
+
+static void b_dados_json(uint32_t n) {
+    size_t s = 0;
+    for (uint32_t i = 0; i < n; i++) {
+        s += amostra_json(resposta, sizeof(resposta), &amostra);
+    }
+    sumidouro = (uint32_t)s;
+}
+
+static size_t rota_dados(const char *req, char *corpo, size_t cap, const char **tipo) {
+    (void)req;
+    *tipo = HTTP_JSON;
+    return amostra_json(corpo, cap, &amostra);
+}
+
+static size_t rota_texto(const char *req, char *corpo, size_t cap, const char **tipo) {
+    (void)req;
+    (void)tipo;
+    return http_texto(corpo, cap, "ok");
+}
+
+// Mesmos caminhos da tabela rotas_http do firmware
+static const http_rota_t rotas[] = {
+    { "/dados", rota_dados }, { "/set_limits", rota_texto }, { "/set_offsets", rota_texto },
+    { "/set_periodo", rota_texto }, { "/set_amostragem", rota_texto }, { "/set_altitude", rota_texto },
+    { "/set_gravacao", rota_texto }, { "/set_bmp280", rota_texto }, { "/tendencia", rota_texto },
+    { "/alertas", rota_texto }, { "/amostragem", rota_texto }, { "/tarefas", rota_texto },
+    { "/sensores", rota_texto }, { "/i2c", rota_texto }, { "/metrics", rota_texto },
+    { "/trace", rota_texto }, { NULL, rota_texto },
+};
+#define N_ROTAS (int)(sizeof(rotas) / sizeof(rotas[0]))
+
+static const char *requisicoes[] = {
+    "GET /dados HTTP/1.1\r\nHost: 192.168.100.42\r\nAccept: */*\r\n\r\n",
+    "GET /set_limits?temp_min=10&temp_max=35&umi_min=30&umi_max=70 HTTP/1.1\r\nHost: x\r\n\r\n",
+    "GET /metrics HTTP/1.1\r\nHost: x\r\n\r\n",
+    "GET / HTTP/1.1\r\nHost: x\r\n\r\n",
+};
+#define N_REQUISICOES (sizeof(requisicoes) / sizeof(requisicoes[0]))
+
+static void b_http_rotear(uint32_t n) {
+    uintptr_t s = 0;
+    for (uint32_t i = 0; i < n; i++) {
+        s += (uintptr_t)http_encontrar(rotas, N_ROTAS, requisicoes[i % N_REQUISICOES]);
+    }
+    sumidouro = (uint32_t)s;
+}
+
+static void b_http_dados(uint32_t n) {
+    size_t s = 0, len;
+    for (uint32_t i = 0; i < n; i++) {
+        if (http_responder(rotas, N_ROTAS, requisicoes[0], resposta, sizeof(resposta), &len)) {
+            s += len;
+        }
+    }
+    sumidouro = (uint32_t)s;
+}
+
+static const bench_t benchmarks[] = {
+    { "bmp280_convert_temp", b_convert_temp },
+    { "bmp280_convert_pressure", b_convert_pressure },
+    { "bmp280_decode_burst", b_decode_burst },
+    { "aht20_parse", b_aht20_parse },
+    { "altitude", b_altitude },
+    { "tela_1_inicial", b_tela1 },
+    { "tela_2_geral", b_tela2 },
+    { "tela_3_temperatura", b_tela3 },
+    { "tela_4_umidade", b_tela4 },
+    { "tela_5_tendencia", b_tela5 },
+    { "tela_6_conforto", b_tela6 },
+    { "dados_json", b_dados_json },
+    { "http_rotear", b_http_rotear },
+    { "http_responder_dados", b_http_dados },
+};
+#define N_BENCHMARKS (int)(sizeof(benchmarks) / sizeof(benchmarks[0]))
+
+static int comparar_double(const void *a, const void *b) {
+    double x = *(const double *)a, y = *(const double *)b;
+    return x < y ? -1 : x > y;
+}
+
+static resultado_t medir(const bench_t *b) {
+    // Calibração: dobra n até uma execução levar o alvo (uma preempção só faz parar mais cedo)
+    uint32_t n = 16;
+    for (;;) {
+        double t0 = agora_ns();
+        b->executar(n);
+        if (agora_ns() - t0 >= ALVO_NS || n >= (1u << 30)) {
+            break;
+        }
+        n *= 2;
+    }
+
+    double amostras[MEDICOES];
+    for (int m = 0; m < MEDICOES; m++) {
+        double t0 = agora_ns();
+        b->executar(n);
+        amostras[m] = (agora_ns() - t0) / n;
+    }
+    qsort(amostras, MEDICOES, sizeof(double), comparar_double);
+    return (resultado_t){ b->nome, amostras[MEDICOES / 2], amostras[0], (uint64_t)n * MEDICOES };
+}
+
+static void escrever_json(FILE *f, const resultado_t *r, int n) {
+    fprintf(f, "{\"versao\":1,\"resultados\":[\n");
+    for (int i = 0; i < n; i++) {
+        fprintf(f, "  {\"nome\":\"%s\",\"ns_op\":%.3f,\"min_ns_op\":%.3f,\"iteracoes\":%llu}%s\n", r[i].nome, r[i].ns_op,
+                r[i].min_ns_op, (unsigned long long)r[i].iteracoes, i + 1 < n ? "," : "");
+    }
+    fprintf(f, "]}\n");
+}
+
+// Lê "nome" e "ns_op" de cada resultado de um JSON gerado por escrever_json
+static int ler_referencia(const char *arquivo, char nomes[][64], double *ns, int max) {
+    FILE *f = fopen(arquivo, "r");
+    if (!f) {
+        return -1;
+    }
+    char linha[512];
+    int n = 0;
+    while (n < max && fgets(linha, sizeof(linha), f)) {
+        const char *p = strstr(linha, "\"nome\":\""), *q = strstr(linha, "\"ns_op\":");
+        if (!p || !q) {
+            continue;
+        }
+        p += 8;
+        size_t len = strcspn(p, "\"");
+        if (len >= sizeof(nomes[0])) {
+            continue;
+        }
+        memcpy(nomes[n], p, len);
+        nomes[n][len] = '\0';
+        ns[n] = strtod(q + 8, NULL);
+        n++;
+    }
+    fclose(f);
+    return n;
+}
+
+static int comparar(const char *arquivo, const resultado_t *r, int n, double tolerancia) {
+    static char nomes[MAX_RESULTADOS][64];
+    double ns[MAX_RESULTADOS];
+    int n_ref = ler_referencia(arquivo, nomes, ns, MAX_RESULTADOS);
+    if (n_ref < 0) {
+        perror(arquivo);
+        return 2;
+    }
+    int regressoes = 0;
+    fprintf(stderr, "%-24s %12s %12s %9s\n", "benchmark", "ref ns/op", "ns/op", "variacao");
+    for (int i = 0; i < n; i++) {
+        int k = 0;
+        while (k < n_ref && strcmp(nomes[k], r[i].nome) != 0) {
+            k++;
+        }
+        if (k == n_ref || ns[k] <= 0) {
+            fprintf(stderr, "%-24s %12s %12.2f %9s\n", r[i].nome, "-", r[i].ns_op, "novo");
+            continue;
+        }
+        double variacao = (r[i].ns_op / ns[k] - 1.0) * 100.0;
+        bool regressao = variacao > tolerancia;
+        regressoes += regressao;
+        fprintf(stderr, "%-24s %12.2f %12.2f %+8.1f%%%s\n", r[i].nome, ns[k], r[i].ns_op, variacao,
+                regressao ? "  REGRESSAO" : "");
+    }
+    fprintf(stderr, "%d regressao(oes) acima de %.0f%%\n", regressoes, tolerancia);
+    return regressoes ? 1 : 0;
+}
+
+int main(int argc, char **argv) {
+    const char *filtro = NULL, *saida = NULL, *referencia = NULL;
+    double tolerancia = 10.0;
+    int opt;
+    while ((opt = getopt(argc, argv, "f:o:b:t:")) != -1) {
+        switch (opt) {
+            case 'f': filtro = optarg; break;
+            case 'o': saida = optarg; break;
+            case 'b': referencia = optarg; break;
+            case 't': tolerancia = atof(optarg); break;
+            default:
+                fprintf(stderr, "uso: %s [-f filtro] [-o resultado.json] [-b referencia.json] [-t tolerancia_%%]\n", argv[0]);
+                return 2;
+        }
+    }
+
+    preparar_entradas();
+    preparar_estado();
+    ssd1306_init(&ssd, WIDTH, HEIGHT, false, 0x3C, NULL);
+
+    resultado_t resultados[MAX_RESULTADOS];
+    int n = 0;
+    for (int i = 0; i < N_BENCHMARKS; i++) {
+        if (filtro && !strstr(benchmarks[i].nome, filtro)) {
+            continue;
+        }
+        resultados[n++] = medir(&benchmarks[i]);
+    }
+
+    FILE *f = saida ? fopen(saida, "w") : stdout;
+    if (!f) {
+        perror(saida);
+        return 2;
+    }
+    escrever_json(f, resultados, n);
+    if (f != stdout) {
+        fclose(f);
+    }
+    return referencia ? comparar(referencia, resultados, n, tolerancia) : 0;
+}
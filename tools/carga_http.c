@@ -0,0 +1,337 @@
+// Teste de carga do servidor HTTP do firmware rodando sobre o lwIP no Linux (port Unix, interface tap)
+//
+// Compilação: cmake -S tools -B build-host -DLWIP_DIR=$PICO_SDK_PATH/lib/lwip && cmake --build build-host --target carga_http
+// Preparação (uma vez, como root):
+//             ip tuntap add tap0 mode tap user $USER && ip addr add 192.168.0.1/24 dev tap0 && ip link set tap0 up
+// Uso:        PRECONFIGURED_TAPIF=tap0 ./carga_http [-a ip_lwip] [-g ip_host] [-c conexoes] [-d segundos]
+//                                                  [-p caminhos] [-i intervalo_ms] [-T timeout_ms] [-s atraso_us]
+//
+// O lwIP roda na thread principal com o mesmo lwipopts.h do firmware (MEM_SIZE, PBUF_POOL_SIZE, TCP_SND_BUF)
+// e o mesmo lib/servidor_http.c + lib/http.c; as rotas devolvem corpos do tamanho dos do firmware.
+// Cada uma das -c threads do gerador repete pelos sockets do Linux o ciclo conectar -> GET -> ler até o
+// fechamento, percorrendo os caminhos de -p (padrão: a página seguida de /dados, como o painel aberto).
+// Ao final imprime um resumo e o JSON com requisições/s, latências (p50/p90/p99/máx), conexões recusadas,
+// expiradas e incompletas, e os picos de MEM_SIZE e dos pools do lwIP (PBUF_POOL, TCP_PCB, TCP_SEG...).
+// -s atrasa cada atendimento (o lwIP fica parado, como no firmware durante o tratamento de uma requisição).
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+#include "lwip/init.h"
+#include "lwip/netif.h"
+#include "lwip/timeouts.h"
+#include "lwip/stats.h"
+#include "lwip/memp.h"
+#include "netif/tapif.h"
+#include "http.h"
+#include "amostra.h"
+#include "servidor_http.h"
+
+#define CAMINHOS_MAX 16
+#define PAGINA_BYTES 5934 // Tamanho de HTML_BODY no firmware
+
+// --- Servidor (contexto do lwIP)
+
+static unsigned atraso_us;
+static char pagina[PAGINA_BYTES + 1];
+static char grande[SERVIDOR_HTTP_RESPOSTA_MAX - HTTP_CABECALHO_MAX]; // Como /trace e /metrics cheios
+
+static size_t rota_dados(const char *req, char *corpo, size_t cap, const char **tipo) {
+    static const amostra_t a = {
+        .temperatura = 25.3f, .pressao_kpa = 100.65f, .altitude = 56.0f, .umidade = 61.2f,
+        .temperatura_bruta = 25.31f, .umidade_bruta = 61.18f, .pressao_bruta = 100652,
+    };
+    (void)req;
+    *tipo = HTTP_JSON;
+    return amostra_json(corpo, cap, &a);
+}
+
+static size_t rota_config(const char *req, char *corpo, size_t cap, const char **tipo) {
+    (void)req;
+    (void)tipo;
+    return http_texto(corpo, cap, "Limites atualizados com sucesso");
+}
+
+static size_t rota_grande(const char *req, char *corpo, size_t cap, const char **tipo) {
+    (void)req;
+    (void)tipo;
+    return http_texto(corpo, cap, grande);
+}
+
+static size_t rota_pagina(const char *req, char *corpo, size_t cap, const char **tipo) {
+    (void)req;
+    *tipo = HTTP_HTML;
+    return http_texto(corpo, cap, pagina);
+}
+
+static const http_rota_t rotas[] = {
+    { "/dados", rota_dados },
+    { "/set_limits", rota_config },
+    { "/metrics", rota_grande },
+    { "/trace", rota_grande },
+    { NULL, rota_pagina },
+};
+
+static const char *atender(const char *req, char *buf, size_t cap, size_t *len) {
+    if (atraso_us) {
+        usleep(atraso_us);
+    }
+    return http_responder(rotas, sizeof(rotas) / sizeof(rotas[0]), req, buf, cap, len);
+}
+
+// --- Gerador de carga (sockets do Linux, uma thread por conexão simultânea)
+
+typedef enum { OK, RECUSADA, EXPIRADA, INCOMPLETA, ERRO } resultado_t;
+
+typedef struct {
+    pthread_t thread;
+    uint32_t *latencias_us; // Requisições concluídas
+    size_t n, cap;
+    uint32_t contagem[ERRO + 1];
+} gerador_t;
+
+static struct sockaddr_in destino;
+static const char *caminhos[CAMINHOS_MAX];
+static int n_caminhos;
+static unsigned intervalo_ms, timeout_ms = 5000;
+static atomic_bool parar;
+
+static uint64_t agora_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+static resultado_t requisitar(const char *caminho) {
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) {
+        return ERRO;
+    }
+    struct timeval tv = { timeout_ms / 1000, (timeout_ms % 1000) * 1000 };
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+
+    resultado_t r = ERRO;
+    if (connect(fd, (struct sockaddr *)&destino, sizeof(destino)) != 0) {
+        r = errno == ECONNREFUSED || errno == ECONNRESET ? RECUSADA
+            : errno == EINPROGRESS || errno == ETIMEDOUT ? EXPIRADA : ERRO;
+        close(fd);
+        return r;
+    }
+
+    char buf[4096];
+    int n = snprintf(buf, sizeof(buf), "GET %s HTTP/1.1\r\nHost: estacao\r\nAccept: */*\r\n\r\n", caminho);
+    if (send(fd, buf, (size_t)n, MSG_NOSIGNAL) != n) {
+        close(fd);
+        return errno == ECONNRESET || errno == EPIPE ? RECUSADA : ERRO;
+    }
+
+    // Lê até o servidor fechar; confere o corpo com o Content-Length
+    char cabecalho[HTTP_CABECALHO_MAX + 1];
+    size_t n_cab = 0, total = 0;
+    for (;;) {
+        ssize_t k = recv(fd, buf, sizeof(buf), 0);
+        if (k == 0) {
+            break;
+        }
+        if (k < 0) {
+            // RST antes de qualquer byte: o servidor abortou a conexão ao aceitá-la (limite ou sem memória)
+            r = errno == EAGAIN || errno == EWOULDBLOCK ? EXPIRADA : total == 0 ? RECUSADA : INCOMPLETA;
+            close(fd);
+            return r;
+        }
+        if (n_cab < HTTP_CABECALHO_MAX) {
+            size_t c = (size_t)k < HTTP_CABECALHO_MAX - n_cab ? (size_t)k : HTTP_CABECALHO_MAX - n_cab;
+            memcpy(cabecalho + n_cab, buf, c);
+            n_cab += c;
+        }
+        total += (size_t)k;
+    }
+    close(fd);
+
+    cabecalho[n_cab] = '\0';
+    const char *cl = strstr(cabecalho, "Content-Length: ");
+    const char *fim = strstr(cabecalho, "\r\n\r\n");
+    if (!cl || !fim || strncmp(cabecalho, "HTTP/1.1 200", 12) != 0) {
+        return INCOMPLETA;
+    }
+    size_t esperado = (size_t)(fim + 4 - cabecalho) + strtoul(cl + 16, NULL, 10);
+    return total == esperado ? OK : INCOMPLETA;
+}
+
+static void *gerar(void *arg) {
+    gerador_t *g = arg;
+    for (int i = 0; !atomic_load(&parar); i = (i + 1) % n_caminhos) {
+        uint64_t t0 = agora_us();
+        resultado_t r = requisitar(caminhos[i]);
+        uint64_t dt = agora_us() - t0;
+        g->contagem[r]++;
+        if (r == OK) {
+            if (g->n == g->cap) {
+                g->cap = g->cap ? 2 * g->cap : 1024;
+                g->latencias_us = realloc(g->latencias_us, g->cap * sizeof(uint32_t));
+            }
+            g->latencias_us[g->n++] = dt > UINT32_MAX ? UINT32_MAX : (uint32_t)dt;
+        }
+        if (intervalo_ms) {
+            usleep(intervalo_ms * 1000);
+        }
+    }
+    return NULL;
+}
+
+// --- Relatório
+
+static int comparar_u32(const void *a, const void *b) {
+    uint32_t x = *(const uint32_t *)a, y = *(const uint32_t *)b;
+    return x < y ? -1 : x > y;
+}
+
+static uint32_t percentil(const uint32_t *v, size_t n, double p) {
+    return n ? v[(size_t)(p * (n - 1))] : 0;
+}
+
+static void relatorio(gerador_t *g, int conexoes, double segundos) {
+    size_t n = 0;
+    uint32_t contagem[ERRO + 1] = { 0 };
+    for (int i = 0; i < conexoes; i++) {
+        n += g[i].n;
+        for (int r = 0; r <= ERRO; r++) {
+            contagem[r] += g[i].contagem[r];
+        }
+    }
+    uint32_t *lat = malloc((n ? n : 1) * sizeof(uint32_t));
+    for (int i = 0, k = 0; i < conexoes; i++) {
+        memcpy(lat + k, g[i].latencias_us, g[i].n * sizeof(uint32_t));
+        k += (int)g[i].n;
+    }
+    qsort(lat, n, sizeof(uint32_t), comparar_u32);
+
+    const servidor_http_stats_t *s = servidor_http_stats();
+    fprintf(stderr, "%d conexoes, %.1f s: %.1f req/s\n", conexoes, segundos, n / segundos);
+    fprintf(stderr, "latencia us: p50 %u  p90 %u  p99 %u  max %u\n", percentil(lat, n, 0.5), percentil(lat, n, 0.9),
+            percentil(lat, n, 0.99), n ? lat[n - 1] : 0);
+    fprintf(stderr, "ok %u  recusadas %u  expiradas %u  incompletas %u  erros %u\n", contagem[OK], contagem[RECUSADA],
+            contagem[EXPIRADA], contagem[INCOMPLETA], contagem[ERRO]);
+    fprintf(stderr, "servidor: ativas_max %u (%u bytes de heap)  recusadas %u  sem_memoria %u  abortadas %u  expiradas %u  "
+            "escritas_adiadas %u\n", s->ativas_max, (unsigned)(s->ativas_max * (SERVIDOR_HTTP_RESPOSTA_MAX + 64)),
+            s->recusadas, s->sem_memoria, s->abortadas, s->expiradas, s->escritas_adiadas);
+    fprintf(stderr, "MEM_SIZE: max %u de %u bytes, %u falhas\n", (unsigned)lwip_stats.mem.max, (unsigned)MEM_SIZE,
+            (unsigned)lwip_stats.mem.err);
+
+    printf("{\"conexoes\":%d,\"segundos\":%.3f,\"req_s\":%.2f,", conexoes, segundos, n / segundos);
+    printf("\"latencia_us\":{\"p50\":%u,\"p90\":%u,\"p99\":%u,\"max\":%u},", percentil(lat, n, 0.5),
+           percentil(lat, n, 0.9), percentil(lat, n, 0.99), n ? lat[n - 1] : 0);
+    printf("\"cliente\":{\"ok\":%u,\"recusadas\":%u,\"expiradas\":%u,\"incompletas\":%u,\"erros\":%u},", contagem[OK],
+           contagem[RECUSADA], contagem[EXPIRADA], contagem[INCOMPLETA], contagem[ERRO]);
+    printf("\"servidor\":{\"conexoes\":%u,\"ativas_max\":%u,\"recusadas\":%u,\"sem_memoria\":%u,\"abortadas\":%u,"
+           "\"expiradas\":%u,\"escritas_adiadas\":%u},", s->conexoes, s->ativas_max, s->recusadas, s->sem_memoria,
+           s->abortadas, s->expiradas, s->escritas_adiadas);
+    printf("\"mem\":{\"max\":%u,\"total\":%u,\"falhas\":%u},\"pools\":{", (unsigned)lwip_stats.mem.max,
+           (unsigned)MEM_SIZE, (unsigned)lwip_stats.mem.err);
+    for (int i = 0; i < MEMP_MAX; i++) {
+        const struct stats_mem *p = lwip_stats.memp[i];
+        printf("%s\"%s\":{\"max\":%u,\"total\":%u,\"falhas\":%u}", i ? "," : "", p->name, (unsigned)p->max,
+               (unsigned)p->avail, (unsigned)p->err);
+        if (p->max > 0 || p->err > 0) {
+            fprintf(stderr, "%-14s max %3u de %3u, %u falhas\n", p->name, (unsigned)p->max, (unsigned)p->avail,
+                    (unsigned)p->err);
+        }
+    }
+    printf("}}\n");
+    free(lat);
+}
+
+int main(int argc, char **argv) {
+    const char *ip = "192.168.0.2", *gw = "192.168.0.1";
+    char lista[256] = "/,/dados,/dados,/dados";
+    int conexoes = 4;
+    double duracao = 10.0;
+    int opt;
+    while ((opt = getopt(argc, argv, "a:g:c:d:p:i:T:s:")) != -1) {
+        switch (opt) {
+            case 'a': ip = optarg; break;
+            case 'g': gw = optarg; break;
+            case 'c': conexoes = atoi(optarg); break;
+            case 'd': duracao = atof(optarg); break;
+            case 'p': snprintf(lista, sizeof(lista), "%s", optarg); break;
+            case 'i': intervalo_ms = (unsigned)atoi(optarg); break;
+            case 'T': timeout_ms = (unsigned)atoi(optarg); break;
+            case 's': atraso_us = (unsigned)atoi(optarg); break;
+            default:
+                fprintf(stderr, "uso: %s [-a ip_lwip] [-g ip_host] [-c conexoes] [-d segundos] [-p caminhos] "
+                        "[-i intervalo_ms] [-T timeout_ms] [-s atraso_us]\n", argv[0]);
+                return 2;
+        }
+    }
+    for (char *c = strtok(lista, ","); c && n_caminhos < CAMINHOS_MAX; c = strtok(NULL, ",")) {
+        caminhos[n_caminhos++] = c;
+    }
+    if (conexoes < 1 || n_caminhos == 0) {
+        return 2;
+    }
+    memset(pagina, 'x', PAGINA_BYTES);
+    memset(grande, 'y', sizeof(grande) - 1);
+
+    // lwIP com a interface tap
+    ip4_addr_t addr, mascara, gateway;
+    if (!ip4addr_aton(ip, &addr) || !ip4addr_aton(gw, &gateway)) {
+        fprintf(stderr, "endereco invalido\n");
+        return 2;
+    }
+    IP4_ADDR(&mascara, 255, 255, 255, 0);
+    lwip_init();
+    static struct netif netif;
+    if (!netif_add(&netif, &addr, &mascara, &gateway, NULL, tapif_init, netif_input)) {
+        fprintf(stderr, "falha ao abrir a interface tap\n");
+        return 1;
+    }
+    netif_set_default(&netif);
+    netif_set_up(&netif);
+    netif_set_link_up(&netif);
+    if (!servidor_http_iniciar(80, atender)) {
+        fprintf(stderr, "falha ao iniciar o servidor\n");
+        return 1;
+    }
+
+    destino.sin_family = AF_INET;
+    destino.sin_port = htons(80);
+    inet_pton(AF_INET, ip, &destino.sin_addr);
+
+    gerador_t *g = calloc((size_t)conexoes, sizeof(gerador_t));
+    uint64_t t0 = agora_us(), fim = t0 + (uint64_t)(duracao * 1e6);
+    for (int i = 0; i < conexoes; i++) {
+        pthread_create(&g[i].thread, NULL, gerar, &g[i]);
+    }
+
+    // Laço do lwIP (NO_SYS, como o cyw43_arch_poll do firmware) até o fim da carga e das threads
+    while (agora_us() < fim) {
+        tapif_poll(&netif);
+        sys_check_timeouts();
+    }
+    atomic_store(&parar, true);
+    for (int i = 0; i < conexoes; i++) {
+        // Mantém o lwIP rodando enquanto as últimas requisições terminam
+        while (pthread_tryjoin_np(g[i].thread, NULL) != 0) {
+            tapif_poll(&netif);
+            sys_check_timeouts();
+        }
+    }
+
+    relatorio(g, conexoes, (agora_us() - t0) / 1e6);
+    for (int i = 0; i < conexoes; i++) {
+        free(g[i].latencias_us);
+    }
+    free(g);
+    return 0;
+}
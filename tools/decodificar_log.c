@@ -0,0 +1,113 @@
+// Decodificador do log binário do firmware (lib/log.h)
+//
+// Compilação: gcc -O2 -Ilib -o decodificar_log tools/decodificar_log.c
+// Uso:        cat /dev/ttyACM0 | ./decodificar_log
+//
+// Linhas que começam com LOG_PREFIXO são reconstruídas a partir de lib/log_formatos.h;
+// o resto da saída USB é repassado sem alteração.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include "log.h"
+
+typedef struct {
+    const char *nome;
+    const char *nivel;
+    const char *formato;
+} log_formato_t;
+
+static const log_formato_t formatos[] = {
+#define LOG_FMT(id, nivel, fmt) { #id, #nivel, fmt },
+#include "log_formatos.h"
+#undef LOG_FMT
+};
+
+// Formata a mensagem interpretando cada palavra conforme o especificador correspondente
+static void imprimir(const char *fmt, const uint32_t *args, uint32_t n) {
+    uint32_t a = 0;
+    while (*fmt) {
+        if (*fmt != '%') {
+            putchar(*fmt++);
+            continue;
+        }
+        if (fmt[1] == '%') {
+            putchar('%');
+            fmt += 2;
+            continue;
+        }
+
+        // Copia o especificador completo (flags, largura, precisão e conversão)
+        char spec[16];
+        size_t len = 0;
+        spec[len++] = *fmt++;
+        while (*fmt && !strchr("diouxXcfFeEgGaA", *fmt) && len < sizeof(spec) - 2) {
+            spec[len++] = *fmt++;
+        }
+        char conv = *fmt;
+        if (conv) {
+            spec[len++] = *fmt++;
+        }
+        spec[len] = '\0';
+
+        if (a >= n) {
+            printf("<?>");
+            continue;
+        }
+        uint32_t v = args[a++];
+        if (strchr("fFeEgGaA", conv)) {
+            union { uint32_t u; float f; } c = { .u = v };
+            printf(spec, (double)c.f);
+        } else if (conv == 'd' || conv == 'i') {
+            printf(spec, (int32_t)v);
+        } else {
+            printf(spec, v);
+        }
+    }
+}
+
+int main(void) {
+    char linha[1024];
+    size_t n_formatos = sizeof(formatos) / sizeof(formatos[0]);
+    size_t prefixo = strlen(LOG_PREFIXO);
+
+    while (fgets(linha, sizeof(linha), stdin)) {
+        if (strncmp(linha, LOG_PREFIXO, prefixo) != 0) {
+            fputs(linha, stdout);
+            continue;
+        }
+
+        uint32_t palavras[LOG_ARGS_MAX + 2];
+        uint32_t n = 0;
+        const char *p = linha + prefixo;
+        while (n < LOG_ARGS_MAX + 2 && strlen(p) >= 8) {
+            char hex[9];
+            memcpy(hex, p, 8);
+            hex[8] = '\0';
+            palavras[n++] = strtoul(hex, NULL, 16);
+            p += 8;
+        }
+        if (n < 2) {
+            fputs(linha, stdout);
+            continue;
+        }
+
+        uint32_t id = palavras[0] & 0xFF;
+        uint32_t n_args = (palavras[0] >> 8) & 0xFF;
+        if (n_args > n - 2) {
+            n_args = n - 2;
+        }
+        printf("[%12.6f] ", palavras[1] / 1e6);
+        if (id >= n_formatos) {
+            printf("<mensagem desconhecida %u>\n", id);
+            continue;
+        }
+        if (strcmp(formatos[id].nivel, "INFO") != 0) {
+            printf("%s: ", formatos[id].nivel);
+        }
+        imprimir(formatos[id].formato, palavras + 2, n_args);
+        putchar('\n');
+    }
+    return 0;
+}
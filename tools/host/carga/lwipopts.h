@@ -0,0 +1,15 @@
+#ifndef HOST_CARGA_LWIPOPTS_H
+#define HOST_CARGA_LWIPOPTS_H
+
+// lwipopts.h do carga_http: as mesmas opções do firmware (MEM_SIZE, PBUF_POOL_SIZE, TCP_SND_BUF...).
+
+#include "../../../lib/lwipopts.h"
+
+#undef LWIP_STATS_DISPLAY
+#define LWIP_STATS_DISPLAY 1 // Mantém o nome de cada pool em lwip_stats.memp[i]->name
+
+// Endereço fixo na interface tap (o DHCP do firmware não é usado no host)
+#undef LWIP_DHCP
+#define LWIP_DHCP 0
+
+#endif // HOST_CARGA_LWIPOPTS_H
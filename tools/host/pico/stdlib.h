@@ -0,0 +1,23 @@
+#ifndef HOST_PICO_STDLIB_H
+#define HOST_PICO_STDLIB_H
+
+// Substituto mínimo do pico/stdlib.h para compilar no host os módulos que só usam tipos do SDK
+// (ssd1306.c nas ferramentas de tools/); não faz parte do firmware.
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#define _u(x) x##u
+
+typedef unsigned int uint;
+
+// Relógio e esperas do SDK: só declarados. Quem compila um módulo que os usa fornece as definições
+// (tools/teste_sensores.c, com um relógio simulado).
+typedef uint64_t absolute_time_t;
+absolute_time_t get_absolute_time(void);
+uint32_t to_ms_since_boot(absolute_time_t t);
+uint32_t time_us_32(void);
+void sleep_ms(uint32_t ms);
+
+#endif // HOST_PICO_STDLIB_H
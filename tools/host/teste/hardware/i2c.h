@@ -0,0 +1,14 @@
+#ifndef HOST_TESTE_HARDWARE_I2C_H
+#define HOST_TESTE_HARDWARE_I2C_H
+
+// Substituto do hardware/i2c.h para tools/teste_sensores.c: as operações bloqueantes da inicialização
+// vão para o barramento simulado do teste (retornam o número de bytes ou -1 com NACK).
+
+#include "pico/stdlib.h"
+
+typedef struct i2c_inst i2c_inst_t;
+
+int i2c_write_timeout_us(i2c_inst_t *i2c, uint8_t addr, const uint8_t *src, size_t len, bool nostop, uint timeout_us);
+int i2c_read_timeout_us(i2c_inst_t *i2c, uint8_t addr, uint8_t *dst, size_t len, bool nostop, uint timeout_us);
+
+#endif // HOST_TESTE_HARDWARE_I2C_H
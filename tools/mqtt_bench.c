@@ -0,0 +1,288 @@
+// Teste de latência e vazão MQTT no Linux (ex.: contra um mosquitto local)
+//
+// Compilação: gcc -O2 -Ilib -o mqtt_bench tools/mqtt_bench.c lib/mqtt_codec.c
+// Uso:        ./mqtt_bench [-h host] [-p porta] [-e estacao] [-n publicacoes] [-q qos] [-b lote] [-r taxa]
+//             ./mqtt_bench [-h host] [-e estacao] -l "temp_min=10&temp_max=35&umi_min=30&umi_max=70"
+//             ./mqtt_bench [-h host] [-e estacao] -o "temp_off=0&pres_off=0&alt_off=0&umi_off=0"
+//
+// Simula uma estação publicando em estacao/<id>/dados com o mesmo codec e o mesmo formato de
+// payload do firmware (uma conexão publica, outra assina o tópico) e mede:
+//   - vazão de publicações e amostras
+//   - latência PUBLISH -> PUBACK (QoS1, uma publicação em voo como no firmware)
+//   - latência fim a fim PUBLISH -> entrega ao assinante
+// Com -l/-o publica uma configuração no tópico de configuração da estação e termina.
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <poll.h>
+#include <unistd.h>
+#include <netdb.h>
+#include <sys/socket.h>
+#include "mqtt_codec.h"
+
+typedef struct {
+    int fd;
+    uint8_t rx[65536];
+    size_t rx_len;
+} conexao_t;
+
+static uint64_t agora_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000u + ts.tv_nsec / 1000;
+}
+
+static int cmp_u32(const void *a, const void *b) {
+    uint32_t x = *(const uint32_t *)a, y = *(const uint32_t *)b;
+    return x < y ? -1 : x > y;
+}
+
+static void relatorio(const char *nome, uint32_t *v, size_t n) {
+    if (n == 0) {
+        printf("  \"%s\": null,\n", nome);
+        return;
+    }
+    qsort(v, n, sizeof(v[0]), cmp_u32);
+    uint64_t soma = 0;
+    for (size_t i = 0; i < n; i++) {
+        soma += v[i];
+    }
+    printf("  \"%s\": {\"n\": %zu, \"media_us\": %.1f, \"p50_us\": %u, \"p99_us\": %u, \"max_us\": %u},\n",
+           nome, n, (double)soma / n, v[n / 2], v[(n * 99) / 100], v[n - 1]);
+}
+
+static int conectar_tcp(const char *host, const char *porta) {
+    struct addrinfo dica = {0}, *res;
+    dica.ai_family = AF_INET;
+    dica.ai_socktype = SOCK_STREAM;
+    if (getaddrinfo(host, porta, &dica, &res) != 0) {
+        return -1;
+    }
+    int fd = socket(res->ai_family, res->ai_socktype, 0);
+    if (fd >= 0 && connect(fd, res->ai_addr, res->ai_addrlen) < 0) {
+        close(fd);
+        fd = -1;
+    }
+    freeaddrinfo(res);
+    return fd;
+}
+
+static int enviar_tudo(int fd, const uint8_t *buf, size_t len) {
+    while (len > 0) {
+        ssize_t n = send(fd, buf, len, 0);
+        if (n <= 0) {
+            return -1;
+        }
+        buf += n;
+        len -= n;
+    }
+    return 0;
+}
+
+// Lê o que houver no socket e decodifica um pacote (retorna 1 se decodificou, 0 se não há pacote, -1 em erro)
+static int receber_pacote(conexao_t *c, mqtt_pacote_t *pct, int *usados, int bloquear) {
+    for (;;) {
+        int u = mqtt_codec_decodificar(c->rx, c->rx_len, pct);
+        if (u < 0) {
+            return -1;
+        }
+        if (u > 0) {
+            *usados = u;
+            return 1;
+        }
+        if (!bloquear) {
+            struct pollfd pfd = { c->fd, POLLIN, 0 };
+            if (poll(&pfd, 1, 0) <= 0) {
+                return 0;
+            }
+        }
+        ssize_t n = recv(c->fd, c->rx + c->rx_len, sizeof(c->rx) - c->rx_len, 0);
+        if (n <= 0) {
+            return -1;
+        }
+        c->rx_len += n;
+        bloquear = 0;
+    }
+}
+
+static void consumir(conexao_t *c, int usados) {
+    memmove(c->rx, c->rx + usados, c->rx_len - usados);
+    c->rx_len -= usados;
+}
+
+static int sessao(conexao_t *c, const char *host, const char *porta, const char *client_id) {
+    uint8_t buf[256];
+    c->rx_len = 0;
+    c->fd = conectar_tcp(host, porta);
+    if (c->fd < 0) {
+        return -1;
+    }
+    if (enviar_tudo(c->fd, buf, mqtt_codec_connect(buf, sizeof(buf), client_id, 60)) < 0) {
+        return -1;
+    }
+    mqtt_pacote_t pct;
+    int usados;
+    if (receber_pacote(c, &pct, &usados, 1) != 1 || pct.tipo != MQTT_CONNACK || pct.codigo != 0) {
+        return -1;
+    }
+    consumir(c, usados);
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    const char *host = "127.0.0.1";
+    const char *porta = "1883";
+    const char *estacao = "1";
+    const char *limites = NULL, *offsets = NULL;
+    int n_pub = 1000, qos = 1, lote = 1, taxa = 0;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "h:p:e:n:q:b:r:l:o:")) != -1) {
+        switch (opt) {
+        case 'h': host = optarg; break;
+        case 'p': porta = optarg; break;
+        case 'e': estacao = optarg; break;
+        case 'n': n_pub = atoi(optarg); break;
+        case 'q': qos = atoi(optarg) ? 1 : 0; break;
+        case 'b': lote = atoi(optarg) > 0 ? atoi(optarg) : 1; break;
+        case 'r': taxa = atoi(optarg); break;
+        case 'l': limites = optarg; break;
+        case 'o': offsets = optarg; break;
+        default:
+            fprintf(stderr, "uso: %s [-h host] [-p porta] [-e estacao] [-n pub] [-q qos] [-b lote] [-r taxa] [-l cfg] [-o cfg]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    static conexao_t pub, sub;
+    char topico[96];
+    static uint8_t tx[65536];
+
+    if (sessao(&pub, host, porta, "bench-pub") < 0) {
+        fprintf(stderr, "Falha ao conectar ao broker %s:%s\n", host, porta);
+        return 1;
+    }
+
+    // Modo de configuração: publica com QoS1 (retida para a estação receber ao reconectar)
+    if (limites || offsets) {
+        snprintf(topico, sizeof(topico), "estacao/%s/config/%s", estacao, limites ? "limites" : "offsets");
+        const char *cfg = limites ? limites : offsets;
+        size_t len = mqtt_codec_publish(tx, sizeof(tx), topico, cfg, strlen(cfg), 1, 1, false);
+        tx[0] |= 0x01; // Flag retain
+        enviar_tudo(pub.fd, tx, len);
+        mqtt_pacote_t pct;
+        int usados;
+        int ok = receber_pacote(&pub, &pct, &usados, 1) == 1 && pct.tipo == MQTT_PUBACK;
+        printf("%s -> %s: %s\n", cfg, topico, ok ? "ok" : "falha");
+        return ok ? 0 : 1;
+    }
+
+    if (sessao(&sub, host, porta, "bench-sub") < 0) {
+        fprintf(stderr, "Falha ao conectar o assinante\n");
+        return 1;
+    }
+    snprintf(topico, sizeof(topico), "estacao/%s/dados", estacao);
+    const char *topicos[] = { topico };
+    enviar_tudo(sub.fd, tx, mqtt_codec_subscribe(tx, sizeof(tx), 1, topicos, 1, 0));
+    {
+        mqtt_pacote_t pct;
+        int usados;
+        if (receber_pacote(&sub, &pct, &usados, 1) != 1 || pct.tipo != MQTT_SUBACK) {
+            fprintf(stderr, "SUBSCRIBE falhou\n");
+            return 1;
+        }
+        consumir(&sub, usados);
+    }
+
+    uint64_t *envio_us = calloc(n_pub, sizeof(uint64_t));
+    uint32_t *lat_puback = calloc(n_pub, sizeof(uint32_t));
+    uint32_t *lat_e2e = calloc(n_pub, sizeof(uint32_t));
+    size_t n_puback = 0, n_e2e = 0;
+    int enviados = 0;
+    uint16_t em_voo = 0;
+    uint32_t seq = 0;
+    char payload[60000];
+
+    uint64_t inicio = agora_us();
+    uint64_t ultimo_evento = inicio;
+    while (n_e2e < (size_t)n_pub && agora_us() - ultimo_evento < 5000000) {
+        uint64_t t = agora_us();
+        int pode_enviar = enviados < n_pub && (qos == 0 || em_voo == 0) &&
+                          (taxa <= 0 || (t - inicio) * (uint64_t)taxa >= (uint64_t)enviados * 1000000u);
+        if (pode_enviar) {
+            size_t len = 0;
+            if (lote > 1) {
+                payload[len++] = '[';
+            }
+            for (int i = 0; i < lote; i++) {
+                len += snprintf(payload + len, sizeof(payload) - len,
+                                "%s{\"seq\":%u,\"t\":%u,\"dt\":%u,\"tem\":%.1f,\"pre\":%.2f,\"alt\":%.0f,\"umi\":%.1f,\"tend\":%.2f,\"prev\":%u}",
+                                i ? "," : "", seq, (unsigned)(t / 1000), taxa > 0 ? 1000u / taxa : 0u, 25.3, 101.32, 12.0, 55.1,
+                                -0.45, 13u);
+                seq++;
+            }
+            if (lote > 1) {
+                payload[len++] = ']';
+            }
+            uint16_t id = (uint16_t)(enviados % 65535) + 1;
+            size_t n = mqtt_codec_publish(tx, sizeof(tx), topico, payload, len, qos, id, false);
+            envio_us[enviados] = t;
+            if (n == 0 || enviar_tudo(pub.fd, tx, n) < 0) {
+                fprintf(stderr, "Falha no envio\n");
+                break;
+            }
+            em_voo = qos ? id : 0;
+            enviados++;
+            ultimo_evento = t;
+        }
+
+        mqtt_pacote_t pct;
+        int usados;
+        while (receber_pacote(&pub, &pct, &usados, 0) == 1) {
+            if (pct.tipo == MQTT_PUBACK && pct.packet_id == em_voo) {
+                lat_puback[n_puback++] = (uint32_t)(agora_us() - envio_us[enviados - 1]);
+                em_voo = 0;
+            }
+            consumir(&pub, usados);
+        }
+        while (receber_pacote(&sub, &pct, &usados, 0) == 1) {
+            if (pct.tipo == MQTT_PUBLISH && pct.payload_len > 0) {
+                // A primeira amostra do lote identifica a publicação
+                char *p = memmem(pct.payload, pct.payload_len, "\"seq\":", 6);
+                if (p) {
+                    unsigned s = strtoul(p + 6, NULL, 10);
+                    unsigned idx = s / lote;
+                    if (idx < (unsigned)enviados) {
+                        lat_e2e[n_e2e++] = (uint32_t)(agora_us() - envio_us[idx]);
+                    }
+                }
+                ultimo_evento = agora_us();
+            }
+            consumir(&sub, usados);
+        }
+
+        if (!pode_enviar) {
+            struct pollfd pfd[2] = { { pub.fd, POLLIN, 0 }, { sub.fd, POLLIN, 0 } };
+            poll(pfd, 2, 1);
+        }
+    }
+    double duracao = (agora_us() - inicio) / 1e6;
+
+    printf("{\n");
+    printf("  \"broker\": \"%s:%s\", \"qos\": %d, \"lote\": %d, \"taxa\": %d,\n", host, porta, qos, lote, taxa);
+    printf("  \"publicacoes\": %d, \"recebidas\": %zu, \"perdidas\": %zu,\n", enviados, n_e2e, (size_t)enviados - n_e2e);
+    printf("  \"duracao_s\": %.3f, \"publicacoes_por_s\": %.1f, \"amostras_por_s\": %.1f,\n",
+           duracao, enviados / duracao, (double)enviados * lote / duracao);
+    relatorio("latencia_puback", lat_puback, n_puback);
+    relatorio("latencia_fim_a_fim", lat_e2e, n_e2e);
+    printf("  \"ok\": %s\n}\n", n_e2e == (size_t)enviados ? "true" : "false");
+
+    uint8_t buf[4];
+    enviar_tudo(pub.fd, buf, mqtt_codec_disconnect(buf, sizeof(buf)));
+    enviar_tudo(sub.fd, buf, mqtt_codec_disconnect(buf, sizeof(buf)));
+    return n_e2e == (size_t)enviados ? 0 : 1;
+}
@@ -0,0 +1,167 @@
+// Receptor de telemetria UDP para Linux (coletor de teste)
+//
+// Compilação: gcc -O2 -o receptor_udp tools/receptor_udp.c
+// Uso:        ./receptor_udp [endereco] [porta]
+//             (endereço multicast faz o receptor entrar no grupo; padrão 239.0.0.77:5005)
+//
+// A cada segundo mostra pacotes/s, amostras/s e as lacunas de sequência por estação.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include "../lib/telemetria_udp.h"
+
+#define MAX_ESTACOES 256
+
+typedef struct {
+    int ativa;
+    uint32_t prox_pacote;  // Próxima sequência de pacote esperada
+    uint32_t prox_amostra; // Próxima sequência de amostra esperada
+    uint64_t pacotes, amostras;
+    uint64_t pacotes_perdidos, amostras_perdidas, fora_de_ordem;
+} estacao_t;
+
+static estacao_t estacoes[MAX_ESTACOES];
+
+static double agora_s(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void processar(const uint8_t *buf, size_t n) {
+    telemetria_cabecalho_t cab;
+    if (n < sizeof(cab)) {
+        return;
+    }
+    memcpy(&cab, buf, sizeof(cab));
+    if (cab.magica != TELEMETRIA_UDP_MAGICA || cab.versao != TELEMETRIA_UDP_VERSAO) {
+        return;
+    }
+    if (n < sizeof(cab) + cab.n_amostras * sizeof(telemetria_amostra_t)) {
+        return;
+    }
+
+    estacao_t *e = &estacoes[cab.estacao];
+    if (!e->ativa) {
+        e->ativa = 1;
+        e->prox_pacote = cab.seq_pacote;
+    }
+
+    // Diferença com sinal: pacotes atrasados não contam como perda
+    int32_t dif = (int32_t)(cab.seq_pacote - e->prox_pacote);
+    if (dif > 0) {
+        e->pacotes_perdidos += dif;
+    } else if (dif < 0) {
+        e->fora_de_ordem++;
+    }
+    if (dif >= 0) {
+        e->prox_pacote = cab.seq_pacote + 1;
+    }
+    e->pacotes++;
+
+    for (int i = 0; i < cab.n_amostras; i++) {
+        telemetria_amostra_t a;
+        memcpy(&a, buf + sizeof(cab) + i * sizeof(a), sizeof(a));
+        if (e->amostras == 0) {
+            e->prox_amostra = a.seq;
+        }
+        int32_t dif_a = (int32_t)(a.seq - e->prox_amostra);
+        if (dif_a > 0) {
+            e->amostras_perdidas += dif_a;
+        }
+        if (dif_a >= 0) {
+            e->prox_amostra = a.seq + 1;
+        }
+        e->amostras++;
+
+        if (i == cab.n_amostras - 1) {
+            char tendencia[16] = "-";
+            if (a.tendencia != TELEMETRIA_SEM_TENDENCIA) {
+                snprintf(tendencia, sizeof(tendencia), "%+.2f", a.tendencia / 100.0);
+            }
+            printf("[est %3u] seq=%u t=%ums dt=%ums T=%.2fC U=%.2f%% P=%.3fkPa A=%.2fm tend=%shPa/3h Z=%u\n",
+                   cab.estacao, a.seq, a.tempo_ms, a.intervalo_ms, a.temperatura / 100.0, a.umidade / 100.0,
+                   a.pressao / 1000.0, a.altitude / 100.0, tendencia, a.zambretti);
+        }
+    }
+}
+
+int main(int argc, char **argv) {
+    const char *endereco = argc > 1 ? argv[1] : TELEMETRIA_UDP_DESTINO;
+    int porta = argc > 2 ? atoi(argv[2]) : TELEMETRIA_UDP_PORTA;
+
+    int fd = socket(AF_INET, SOCK_DGRAM, 0);
+    if (fd < 0) {
+        perror("socket");
+        return 1;
+    }
+    int um = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &um, sizeof(um));
+
+    struct sockaddr_in local = {0};
+    local.sin_family = AF_INET;
+    local.sin_port = htons(porta);
+    local.sin_addr.s_addr = htonl(INADDR_ANY);
+    if (bind(fd, (struct sockaddr *)&local, sizeof(local)) < 0) {
+        perror("bind");
+        return 1;
+    }
+
+    struct in_addr grupo;
+    if (inet_aton(endereco, &grupo) && IN_MULTICAST(ntohl(grupo.s_addr))) {
+        struct ip_mreq mreq = {0};
+        mreq.imr_multiaddr = grupo;
+        mreq.imr_interface.s_addr = htonl(INADDR_ANY);
+        if (setsockopt(fd, IPPROTO_IP, IP_ADD_MEMBERSHIP, &mreq, sizeof(mreq)) < 0) {
+            perror("IP_ADD_MEMBERSHIP");
+            return 1;
+        }
+    }
+
+    struct timeval tv = {0, 200000};
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+
+    printf("Aguardando telemetria em %s:%d\n", endereco, porta);
+
+    uint8_t buf[2048];
+    uint64_t pacotes_janela = 0, amostras_janela = 0, amostras_total_ant = 0;
+    double inicio_janela = agora_s();
+    for (;;) {
+        ssize_t n = recv(fd, buf, sizeof(buf), 0);
+        if (n > 0) {
+            processar(buf, (size_t)n);
+            pacotes_janela++;
+        }
+
+        double t = agora_s();
+        if (t - inicio_janela >= 1.0) {
+            uint64_t amostras_total = 0;
+            for (int i = 0; i < MAX_ESTACOES; i++) {
+                amostras_total += estacoes[i].amostras;
+            }
+            amostras_janela = amostras_total - amostras_total_ant;
+            amostras_total_ant = amostras_total;
+
+            double dt = t - inicio_janela;
+            printf("-- %.1f pacotes/s, %.1f amostras/s\n", pacotes_janela / dt, amostras_janela / dt);
+            for (int i = 0; i < MAX_ESTACOES; i++) {
+                estacao_t *e = &estacoes[i];
+                if (e->ativa) {
+                    printf("   est %3d: pacotes=%llu perdidos=%llu amostras=%llu perdidas=%llu fora_de_ordem=%llu\n", i,
+                           (unsigned long long)e->pacotes, (unsigned long long)e->pacotes_perdidos,
+                           (unsigned long long)e->amostras, (unsigned long long)e->amostras_perdidas,
+                           (unsigned long long)e->fora_de_ordem);
+                }
+            }
+            pacotes_janela = 0;
+            inicio_janela = t;
+        }
+    }
+}
@@ -0,0 +1,449 @@
+// Reprodução das leituras brutas gravadas pelo firmware (lib/gravacao.h) no host
+//
+// Compilação: cmake -S tools -B build-host && cmake --build build-host --target replay
+// Gravação:   cat /dev/ttyACM0 > gravacao.txt   (envie 'g' pela USB ou GET /set_gravacao?ativa=1)
+// Uso:        ./replay [-r repeticoes] [-a altitude_m] [-q] gravacao.txt > saida.csv
+//             ./replay -g ciclos > sintetica.txt   (gera uma gravação sintética)
+//
+// Cada ciclo gravado passa pelo mesmo código do firmware: conversão dos bytes do BMP280 e do AHT20 e
+// detecção de conversões repetidas (lib/conversao.c), filtros, valores finais, derivadas, tendência e
+// alertas (lib/estacao.c), publicação da amostra e o JSON de /dados (lib/amostra.c) e os relatórios;
+// a saída tem uma linha CSV por ciclo. A assinatura no fim é um hash dos bits de todos os
+// valores produzidos: duas versões do código que dão a mesma assinatura sobre a mesma gravação são
+// bit a bit equivalentes. Depois da primeira passagem a gravação é reproduzida mais vezes só para medir
+// o tempo por ciclo (sem E/S); todas as passagens partem do mesmo estado e devem dar a mesma assinatura.
+//
+// Offsets zerados e limiares de alerta padrão. O período adaptativo não entra: os instantes das amostras
+// já vêm da gravação. No modo forçado do BMP280 toda leitura gravada conta como disparo aceito.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <unistd.h>
+#include "conversao.h"
+#include "derivadas.h"
+#include "tendencia.h"
+#include "alertas.h"
+#include "amostra.h"
+#include "estacao.h"
+#include "gravacao.h"
+
+#define REGISTROS_INICIAL 4096 // Capacidade inicial do vetor de registros (dobra conforme a gravação)
+#define SENSORES_MAX 8
+#define REPETICOES 20
+
+// Tipos de sensor_tipo_t (lib/sensores.h)
+#define SENSOR_BMP280 0
+#define SENSOR_AHT20 1
+
+#define SEA_LEVEL_PRESSURE 101325.0f
+
+// --- Gravação carregada na memória
+
+typedef struct {
+    uint8_t n;
+    uint8_t bytes[GRAVACAO_REGISTRO_MAX];
+} registro_t;
+
+static registro_t *registros;
+static int n_registros = 0, cap_registros = 0;
+
+static struct {
+    bool presente;
+    uint8_t tipo;
+    struct bmp280_calib_param calibracao;
+    bmp280_config_t config;       // BMP280
+    bmp280_repeticao_t repeticao; // BMP280
+} sensores[SENSORES_MAX];
+
+// --- Estado da reprodução (o do pipeline fica em lib/estacao.c)
+
+static float temperatura_bmp;
+static bool bmp_valido, aht_valido; // Leitura válida no ciclo corrente (amostra_t.velhos)
+static float altitude_estacao = 0.0f;
+static uint32_t falhas_conversao;
+static uint32_t inconsistentes; // Ciclos cujas derivadas não correspondem às entradas do próprio ciclo
+
+static char json_dados[512], json_tendencia[512], json_alertas[1536], linha[512];
+
+static double agora_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static int hex_valor(char c) {
+    return c >= '0' && c <= '9' ? c - '0' : c >= 'a' && c <= 'f' ? c - 'a' + 10 : c >= 'A' && c <= 'F' ? c - 'A' + 10 : -1;
+}
+
+static int carregar(FILE *f) {
+    char buf[1024];
+    while (fgets(buf, sizeof(buf), f)) {
+        const char *p = strstr(buf, GRAVACAO_PREFIXO);
+        if (!p) {
+            continue;
+        }
+        if (n_registros == cap_registros) {
+            int cap = cap_registros ? 2 * cap_registros : REGISTROS_INICIAL;
+            registro_t *r = realloc(registros, sizeof(registro_t) * cap);
+            if (!r) {
+                perror("replay");
+                break; // Reproduz o que coube na memória
+            }
+            registros = r;
+            cap_registros = cap;
+        }
+        p += strlen(GRAVACAO_PREFIXO);
+        registro_t *r = &registros[n_registros];
+        r->n = 0;
+        int a, b;
+        while ((a = hex_valor(p[0])) >= 0 && (b = hex_valor(p[1])) >= 0 && r->n < GRAVACAO_REGISTRO_MAX) {
+            r->bytes[r->n++] = (uint8_t)(a << 4 | b);
+            p += 2;
+        }
+        if (r->n) {
+            n_registros++;
+        }
+    }
+    return n_registros;
+}
+
+// FNV-1a de 64 bits sobre os bits dos valores
+static uint64_t misturar(uint64_t h, const void *dados, size_t n) {
+    const uint8_t *b = dados;
+    for (size_t i = 0; i < n; i++) {
+        h = (h ^ b[i]) * 0x100000001b3ull;
+    }
+    return h;
+}
+
+static void reiniciar(void) {
+    estacao_iniciar(NULL);
+    tendencia_configurar(TENDENCIA_JANELA_CURTA, TENDENCIA_JANELA_LONGA);
+    derivadas_configurar(altitude_estacao, SEA_LEVEL_PRESSURE);
+    derivadas_entrada(DERIVADAS_TEMPERATURA, NAN);
+    derivadas_entrada(DERIVADAS_UMIDADE, NAN);
+    derivadas_entrada(DERIVADAS_PRESSAO, NAN);
+    temperatura_bmp = 0;
+    bmp_valido = aht_valido = false;
+    falhas_conversao = inconsistentes = 0;
+    memset(sensores, 0, sizeof(sensores));
+}
+
+// Como sensores_primeiro: o firmware só usa o primeiro sensor presente de cada tipo
+static bool primeiro(int id) {
+    for (int i = 0; i < id; i++) {
+        if (sensores[i].presente && sensores[i].tipo == sensores[id].tipo) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Conversão de sensores.c e ler_bmp280 / ler_aht10 do firmware sobre os bytes gravados
+static void leitura(const gravacao_leitura_t *r) {
+    if (r->id >= SENSORES_MAX || !sensores[r->id].presente || !primeiro(r->id)) {
+        return;
+    }
+    if (sensores[r->id].tipo == SENSOR_BMP280 && r->n == BMP280_BURST_LEN) {
+        int32_t t, p;
+        if (!bmp280_decode_burst(r->dados, &t, &p)) {
+            falhas_conversao++;
+            return;
+        }
+        bmp_valido = true;
+        if (!bmp280_conversoes_novas(&sensores[r->id].repeticao, &sensores[r->id].config, true, t, p, r->fim_us)) {
+            return; // Mesma conversão lida de novo: mantém a última leitura
+        }
+        temperatura_bmp = bmp280_convert_temp(t, &sensores[r->id].calibracao) / 100.0f;
+        estacao_pressao(bmp280_convert_pressure(p, t, &sensores[r->id].calibracao));
+    } else if (sensores[r->id].tipo == SENSOR_AHT20 && r->n == AHT20_QUADRO_LEN) {
+        AHT20_Data d;
+        if (!aht20_parse(r->dados, &d)) {
+            falhas_conversao++;
+            return;
+        }
+        aht_valido = true;
+        estacao_temperatura_umidade(d.temperature, d.humidity);
+    }
+}
+
+// Referências independentes de lib/derivadas.c, calculadas com os valores da própria amostra publicada
+static bool confere(float obtido, float esperado) {
+    return isnan(obtido) ? isnan(esperado) : fabsf(obtido - esperado) <= 1e-3f * fmaxf(1.0f, fabsf(esperado));
+}
+
+static bool derivadas_coerentes(const amostra_t *a, amostra_derivadas_t *cache) {
+    float t = a->temperatura, u = a->umidade;
+    float orvalho = NAN;
+    if (u > 0) {
+        float g = logf(u / 100.0f) + 17.62f * t / (243.12f + t);
+        orvalho = 243.12f * g / (17.62f - g);
+    }
+    float absoluta = 6.112f * expf(17.67f * t / (t + 243.5f)) * u * 2.1674f / (273.15f + t);
+    return confere(amostra_derivada(a, DERIVADA_PONTO_ORVALHO, cache), orvalho) &&
+           confere(amostra_derivada(a, DERIVADA_UMIDADE_ABSOLUTA, cache), absoluta);
+}
+
+// Restante de tarefa_coleta_sensores, tarefa_alerta e de /dados; retorna o tamanho da linha formatada
+static size_t fechar_ciclo(uint64_t tempo_us, uint32_t intervalo_ms, uint64_t *assinatura) {
+    static const estacao_offsets_t offsets = {0};
+    uint8_t velhos = (bmp_valido ? 0 : AMOSTRA_VELHA_PRESSAO) |
+                     (aht_valido ? 0 : AMOSTRA_VELHA_TEMPERATURA | AMOSTRA_VELHA_UMIDADE);
+    bmp_valido = aht_valido = false;
+    const amostra_t *atual = estacao_atualizar(&offsets, velhos, intervalo_ms);
+    uint8_t previsao;
+    float tendencia_3h = estacao_tendencia(atual, tempo_us, &previsao);
+
+    // Alertas e /dados leem a amostra publicada, como no firmware
+    static amostra_derivadas_t derivadas; // Como o display: calculadas da cópia lida, uma vez por amostra
+    amostra_t a;
+    amostra_ler(&a);
+    if (!derivadas_coerentes(&a, &derivadas)) {
+        inconsistentes++;
+    }
+    estacao_alertas(&a, tempo_us);
+    uint32_t ativos = 0;
+    for (int i = 0; i < ESTACAO_REGRAS; i++) {
+        ativos |= (uint32_t)alertas_ativo(i) << i;
+    }
+
+    // Formatação: relatórios servidos por HTTP e a linha da amostra
+    float pressao_mar = amostra_derivada(&a, DERIVADA_PRESSAO_MAR, &derivadas);
+    size_t n_dados = amostra_json(json_dados, sizeof(json_dados), &a);
+    tendencia_relatorio(json_tendencia, sizeof(json_tendencia), pressao_mar);
+    alertas_relatorio(json_alertas, sizeof(json_alertas));
+
+    const float saida[] = {
+        (float)a.pressao_bruta, temperatura_bmp, a.temperatura_bruta, a.umidade_bruta, a.temperatura, a.umidade,
+        a.pressao_kpa, a.altitude, amostra_derivada(&a, DERIVADA_PONTO_ORVALHO, &derivadas),
+        amostra_derivada(&a, DERIVADA_INDICE_CALOR, &derivadas),
+        pressao_mar, tendencia_3h,
+    };
+    *assinatura = misturar(*assinatura, saida, sizeof(saida));
+    *assinatura = misturar(*assinatura, &previsao, sizeof(previsao));
+    *assinatura = misturar(*assinatura, &ativos, sizeof(ativos));
+    // O JSON de /dados a partir do primeiro campo depois de "seq" (a sequência continua entre passagens)
+    const char *campos = memchr(json_dados, ',', n_dados);
+    if (campos) {
+        *assinatura = misturar(*assinatura, campos, json_dados + n_dados - campos);
+    }
+
+    int n = snprintf(linha, sizeof(linha), "%.3f,%ld,%.2f,%.2f,%.2f,%.4f,%.4f,%.5f,%.2f,%.3f,%.3f,%.2f,%.3f,%u,%lu\n",
+                     tempo_us / 1e3, (long)a.pressao_bruta, temperatura_bmp, a.temperatura_bruta, a.umidade_bruta,
+                     a.temperatura, a.umidade, a.pressao_kpa, a.altitude, saida[8], saida[9], pressao_mar,
+                     tendencia_3h, previsao, (unsigned long)ativos);
+    return n > 0 ? (size_t)n : 0;
+}
+
+// Uma passagem pela gravação; com saida != NULL escreve o CSV
+static uint64_t reproduzir(FILE *saida, uint32_t *ciclos, uint32_t *leituras, uint32_t *perdas) {
+    uint64_t assinatura = 0xcbf29ce484222325ull;
+    bool em_ciclo = false;
+    uint64_t tempo_ciclo = 0;
+    uint32_t intervalo_ciclo = 0;
+    *ciclos = *leituras = *perdas = 0;
+    reiniciar();
+
+    for (int i = 0; i < n_registros; i++) {
+        const registro_t *r = &registros[i];
+        switch (r->bytes[0]) {
+            case GRAVACAO_SENSOR: {
+                gravacao_sensor_t s = {0};
+                memcpy(&s, r->bytes, r->n < sizeof(s) ? r->n : sizeof(s));
+                if (s.id < SENSORES_MAX) {
+                    sensores[s.id].presente = true;
+                    sensores[s.id].tipo = s.sensor;
+                    sensores[s.id].calibracao = s.calibracao;
+                    sensores[s.id].config = (bmp280_config_t){ s.config[0], s.config[1], s.config[2], s.config[3], s.config[4] };
+                    sensores[s.id].repeticao.anterior = false; // Reconfiguração: recomeça a detecção de repetidas
+                }
+                break;
+            }
+            case GRAVACAO_CICLO: {
+                if (em_ciclo) {
+                    size_t n = fechar_ciclo(tempo_ciclo, intervalo_ciclo, &assinatura);
+                    if (saida) {
+                        fwrite(linha, 1, n, saida);
+                    }
+                    (*ciclos)++;
+                }
+                gravacao_ciclo_t c = {0};
+                memcpy(&c, r->bytes, r->n < sizeof(c) ? r->n : sizeof(c));
+                if (r->n < sizeof(c)) {
+                    // Versão 1, sem o intervalo: aproximado pela distância entre os instantes dos ciclos
+                    c.intervalo_ms = em_ciclo ? (uint32_t)((c.tempo_us - tempo_ciclo) / 1000) : 0;
+                }
+                tempo_ciclo = c.tempo_us;
+                intervalo_ciclo = c.intervalo_ms;
+                em_ciclo = true;
+                break;
+            }
+            case GRAVACAO_LEITURA: {
+                gravacao_leitura_t l = {0};
+                memcpy(&l, r->bytes, r->n < sizeof(l) ? r->n : sizeof(l));
+                if (em_ciclo) {
+                    leitura(&l);
+                    (*leituras)++;
+                }
+                break;
+            }
+            case GRAVACAO_PERDA:
+                (*perdas)++;
+                break;
+            default:
+                break;
+        }
+    }
+    if (em_ciclo) {
+        size_t n = fechar_ciclo(tempo_ciclo, intervalo_ciclo, &assinatura);
+        if (saida) {
+            fwrite(linha, 1, n, saida);
+        }
+        (*ciclos)++;
+    }
+    return assinatura;
+}
+
+// Só a conversão dos bytes brutos (custo de lib/conversao.c isolado)
+static double medir_conversao(int repeticoes) {
+    volatile int32_t destino = 0;
+    uint32_t n = 0;
+    double t0 = agora_ns();
+    for (int k = 0; k < repeticoes; k++) {
+        for (int i = 0; i < n_registros; i++) {
+            const registro_t *r = &registros[i];
+            if (r->bytes[0] == GRAVACAO_SENSOR) {
+                gravacao_sensor_t s = {0};
+                memcpy(&s, r->bytes, r->n < sizeof(s) ? r->n : sizeof(s));
+                if (s.id < SENSORES_MAX) {
+                    sensores[s.id].tipo = s.sensor;
+                    sensores[s.id].calibracao = s.calibracao;
+                }
+            } else if (r->bytes[0] == GRAVACAO_LEITURA) {
+                const gravacao_leitura_t *l = (const gravacao_leitura_t *)r->bytes;
+                int32_t t, p;
+                AHT20_Data d;
+                if (l->id >= SENSORES_MAX) {
+                    continue;
+                }
+                if (sensores[l->id].tipo == SENSOR_BMP280 && bmp280_decode_burst(l->dados, &t, &p)) {
+                    destino += bmp280_convert_temp(t, &sensores[l->id].calibracao);
+                    destino += bmp280_convert_pressure(p, t, &sensores[l->id].calibracao);
+                } else if (sensores[l->id].tipo == SENSOR_AHT20 && aht20_parse(l->dados, &d)) {
+                    destino += (int32_t)(d.temperature + d.humidity);
+                }
+                n++;
+            }
+        }
+    }
+    return n ? (agora_ns() - t0) / n : 0;
+}
+
+// --- Gravação sintética: calibração do exemplo do datasheet do BMP280 e sinais com deriva e ruído
+
+static void imprimir_registro(const void *r, size_t n) {
+    fputs(GRAVACAO_PREFIXO, stdout);
+    for (size_t i = 0; i < n; i++) {
+        printf("%02x", ((const uint8_t *)r)[i]);
+    }
+    putchar('\n');
+}
+
+static void gerar(int ciclos) {
+    srand(1);
+    gravacao_inicio_t ini = { GRAVACAO_INICIO, GRAVACAO_VERSAO, 2, 0, 0 };
+    gravacao_sensor_t bmp = { GRAVACAO_SENSOR, 0, SENSOR_BMP280, 0x76, -1, { 1, 3, 4, 4, 3 },
+                              { 27504, 26435, -1000, 36477, -10685, 3024, 2855, 140, -7, 15500, -14600, 6000 } };
+    gravacao_sensor_t aht = { GRAVACAO_SENSOR, 1, SENSOR_AHT20, 0x38, -1, { 0 }, { 0 } };
+    imprimir_registro(&ini, sizeof(ini));
+    imprimir_registro(&bmp, sizeof(bmp));
+    imprimir_registro(&aht, sizeof(aht));
+
+    uint64_t t = 10000000;
+    for (int i = 0; i < ciclos; i++, t += 5000000) {
+        gravacao_ciclo_t c = { GRAVACAO_CICLO, t, i ? 5000 : 0 };
+        imprimir_registro(&c, sizeof(c));
+
+        // adc_T = 519888 e adc_P = 415148 dão 25,08 °C e 100653 Pa; pressão cai lentamente
+        int32_t adc_t = 519888 + (int32_t)(2000.0 * sin(i / 500.0)) + rand() % 16;
+        int32_t adc_p = 415148 + i / 4 + rand() % 32;
+        gravacao_leitura_t l = { GRAVACAO_LEITURA, 0, BMP280_BURST_LEN, (uint32_t)t + 300,
+                                 { 0x00, 0x8f, 0x90, 0x00,
+                                   (uint8_t)(adc_p >> 12), (uint8_t)(adc_p >> 4), (uint8_t)(adc_p << 4),
+                                   (uint8_t)(adc_t >> 12), (uint8_t)(adc_t >> 4), (uint8_t)(adc_t << 4) } };
+        imprimir_registro(&l, sizeof(l));
+
+        uint32_t umi = (uint32_t)((55.0 + 20.0 * sin(i / 300.0) + (rand() % 100) / 500.0) / 100.0 * 1048576.0);
+        uint32_t tem = (uint32_t)((25.0 + 12.0 * sin(i / 500.0) + (rand() % 100) / 2000.0 + 50.0) / 200.0 * 1048576.0);
+        gravacao_leitura_t a = { GRAVACAO_LEITURA, 1, AHT20_QUADRO_LEN, (uint32_t)t + 600,
+                                 { 0x1c, (uint8_t)(umi >> 12), (uint8_t)(umi >> 4), (uint8_t)(umi << 4 | (tem >> 16 & 0x0F)),
+                                   (uint8_t)(tem >> 8), (uint8_t)tem } };
+        imprimir_registro(&a, sizeof(a) - sizeof(a.dados) + AHT20_QUADRO_LEN);
+    }
+}
+
+int main(int argc, char **argv) {
+    int repeticoes = REPETICOES, opt;
+    bool quieto = false;
+    while ((opt = getopt(argc, argv, "r:a:qg:")) != -1) {
+        switch (opt) {
+            case 'r': repeticoes = atoi(optarg); break;
+            case 'a': altitude_estacao = strtof(optarg, NULL); break;
+            case 'q': quieto = true; break;
+            case 'g': gerar(atoi(optarg)); return 0;
+            default:
+                fprintf(stderr, "uso: %s [-r repeticoes] [-a altitude_m] [-q] [gravacao.txt] | -g ciclos\n", argv[0]);
+                return 1;
+        }
+    }
+
+    FILE *f = optind < argc ? fopen(argv[optind], "r") : stdin;
+    if (!f) {
+        perror(optind < argc ? argv[optind] : "replay");
+        return 1;
+    }
+    carregar(f);
+    if (f != stdin) {
+        fclose(f);
+    }
+
+    uint32_t ciclos, leituras, perdas;
+    if (!quieto) {
+        printf("t_ms,pressao_pa,temp_bmp280,temp_aht20,umidade,temperatura,umidade_final,pressao_kpa,altitude,"
+               "ponto_orvalho,indice_calor,pressao_mar,tendencia_3h,zambretti,alertas\n");
+    }
+    uint64_t assinatura = reproduzir(quieto ? NULL : stdout, &ciclos, &leituras, &perdas);
+    if (!ciclos) {
+        fprintf(stderr, "Nenhum ciclo na gravação (%d registros)\n", n_registros);
+        return 1;
+    }
+    uint32_t derivadas_erradas = inconsistentes; // As passagens seguintes zeram o contador
+
+    // Passagens cronometradas (sem E/S)
+    bool estavel = true;
+    double t0 = agora_ns();
+    for (int k = 0; k < repeticoes; k++) {
+        uint32_t c, l, p;
+        if (reproduzir(NULL, &c, &l, &p) != assinatura) {
+            estavel = false;
+        }
+    }
+    double ns_ciclo = repeticoes ? (agora_ns() - t0) / ((double)repeticoes * ciclos) : 0;
+    double ns_conversao = medir_conversao(repeticoes);
+
+    fprintf(stderr, "registros: %d  ciclos: %u  leituras: %u  falhas de conversao: %u  perdas: %u\n",
+            n_registros, ciclos, leituras, falhas_conversao, perdas);
+    fprintf(stderr, "pipeline: %.1f ns/ciclo (%.0f ciclos/s)  conversao: %.1f ns/leitura\n",
+            ns_ciclo, ns_ciclo > 0 ? 1e9 / ns_ciclo : 0, ns_conversao);
+    fprintf(stderr, "assinatura: %016llx%s\n", (unsigned long long)assinatura,
+            estavel ? "" : "  (ATENCAO: passagens divergentes, estado vazando entre execucoes)");
+    if (derivadas_erradas) {
+        fprintf(stderr, "ATENCAO: derivadas de %u ciclos nao correspondem a temperatura e umidade do proprio ciclo\n",
+                derivadas_erradas);
+        return 3;
+    }
+    return estavel ? 0 : 2;
+}
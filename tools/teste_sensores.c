@@ -0,0 +1,355 @@
+// Teste do registro de sensores (lib/sensores.c) sobre um barramento I2C simulado
+//
+// Compilação: pelo tools/CMakeLists.txt (alvo teste_sensores; `ctest` na pasta de build roda o teste)
+//
+// A fila de transações (lib/i2c_fila.h) é substituída por uma simulada: as transações ficam na fila até
+// alguém aguardar uma delas e então são executadas em ordem de envio, como no controlador real com todas
+// na mesma prioridade. Atrás de um TCA9548A simulado respondem dois BMP280 e um AHT20. O teste confere:
+// - a troca de canal do multiplexador antes de cada sensor, só quando o canal muda;
+// - o lote: disparos antes das leituras e todas as leituras na fila antes da primeira espera;
+// - um NACK em um canal: o sensor falha, sai do ciclo após SENSORES_FALHAS_MAX e os outros continuam;
+//   depois da espera é reinicializado;
+// - conversões novas com os mesmos valores brutos não são contadas como repetidas.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "sensores.h"
+#include "aht20.h"
+#include "metricas.h"
+#include "gravacao.h"
+#include "log.h"
+
+#define MUX SENSORES_MUX_ENDERECO
+
+static int falhas = 0;
+
+#define CHECAR(cond) do { \
+        if (!(cond)) { \
+            printf("FALHA %s:%d: %s\n", __FILE__, __LINE__, #cond); \
+            falhas++; \
+        } \
+    } while (0)
+
+// --- Relógio simulado e dependências do firmware que o teste não exercita
+
+static uint64_t relogio_us = 1000000;
+
+absolute_time_t get_absolute_time(void) {
+    return relogio_us;
+}
+
+uint32_t to_ms_since_boot(absolute_time_t t) {
+    return (uint32_t)(t / 1000);
+}
+
+uint32_t time_us_32(void) {
+    return (uint32_t)relogio_us;
+}
+
+void sleep_ms(uint32_t ms) {
+    relogio_us += (uint64_t)ms * 1000;
+}
+
+static void avancar_ms(uint32_t ms) {
+    relogio_us += (uint64_t)ms * 1000;
+}
+
+uint32_t metricas_contadores[MC_N];
+metricas_hist_t metricas_hist[MH_N];
+
+void log_registrar(log_id_t id, const uint32_t *args, uint32_t n) {
+    (void)id, (void)args, (void)n;
+}
+
+void gravacao_sensor(int id) {
+    (void)id;
+}
+
+void gravacao_leitura(int id, uint32_t fim_us, const uint8_t *dados, uint8_t n) {
+    (void)id, (void)fim_us, (void)dados, (void)n;
+}
+
+// --- Dispositivos simulados
+
+typedef struct {
+    int canal;         // Canal do TCA9548A
+    uint8_t endereco;
+    sensor_tipo_t tipo;
+    bool nack;         // Não responde a nada
+    bool nack_escrita; // Responde às leituras, mas não aceita escrita de registradores (disparo perdido)
+    uint8_t regs[256]; // BMP280: mapa de registradores
+    uint8_t ponteiro;  // BMP280: registrador corrente
+    uint8_t quadro[AHT20_QUADRO_LEN]; // AHT20: resultado da última medição
+    int32_t temp_bruta, pressao_bruta; // BMP280: valores da próxima conversão
+    uint32_t conversoes;
+} dispositivo_t;
+
+enum { BMP_A, AHT_B, BMP_C, N_DISPOSITIVOS };
+static dispositivo_t dispositivos[N_DISPOSITIVOS];
+static uint8_t mux_mascara = 0;
+
+// Transações executadas no barramento, em texto ("M02 W38 R76 ..."; "!" = NACK)
+static char registro[512];
+
+static void registrar(char op, uint8_t endereco, bool ok) {
+    size_t len = strlen(registro);
+    snprintf(registro + len, sizeof(registro) - len, "%s%c%02x%s", len ? " " : "", op, endereco, ok ? "" : "!");
+}
+
+static dispositivo_t *selecionado(uint8_t endereco) {
+    for (int i = 0; i < N_DISPOSITIVOS; i++) {
+        dispositivo_t *d = &dispositivos[i];
+        if (d->endereco == endereco && (mux_mascara & (1u << d->canal))) {
+            return d;
+        }
+    }
+    return NULL;
+}
+
+// Dados da conversão nos registradores de REG_PRESSURE_MSB a REG_TEMP_XLSB
+static void bmp280_converter_simulado(dispositivo_t *d) {
+    d->regs[REG_PRESSURE_MSB] = d->pressao_bruta >> 12;
+    d->regs[REG_PRESSURE_LSB] = d->pressao_bruta >> 4;
+    d->regs[REG_PRESSURE_XLSB] = (d->pressao_bruta & 0xF) << 4;
+    d->regs[REG_TEMP_MSB] = d->temp_bruta >> 12;
+    d->regs[REG_TEMP_LSB] = d->temp_bruta >> 4;
+    d->regs[REG_TEMP_XLSB] = (d->temp_bruta & 0xF) << 4;
+    d->conversoes++;
+}
+
+// Escrita de n bytes; false = NACK
+static bool escrever(uint8_t endereco, const uint8_t *dados, size_t n) {
+    if (endereco == MUX) {
+        mux_mascara = n ? dados[0] : mux_mascara;
+        return true;
+    }
+    dispositivo_t *d = selecionado(endereco);
+    if (!d || d->nack || (d->nack_escrita && n > 1)) {
+        return false;
+    }
+    if (d->tipo == SENSOR_AHT20) {
+        if (n && dados[0] == AHT20_CMD_TRIGGER) {
+            d->conversoes++;
+        }
+        return true;
+    }
+    // BMP280: registrador seguido de pares registrador/valor
+    if (n) {
+        d->ponteiro = dados[0];
+    }
+    for (size_t i = 0; i + 1 < n; i += 2) {
+        d->regs[dados[i]] = dados[i + 1];
+        if (dados[i] == REG_CTRL_MEAS && (dados[i + 1] & 3) == BMP280_MODO_FORCADO) {
+            bmp280_converter_simulado(d);
+            d->regs[REG_CTRL_MEAS] &= ~3; // Volta ao sleep ao fim da conversão
+        }
+    }
+    return true;
+}
+
+static bool ler(uint8_t endereco, uint8_t *dest, size_t n) {
+    dispositivo_t *d = selecionado(endereco);
+    if (endereco == MUX || !d || d->nack) {
+        return false;
+    }
+    for (size_t i = 0; i < n; i++) {
+        dest[i] = d->tipo == SENSOR_AHT20 ? d->quadro[i < AHT20_QUADRO_LEN ? i : 0] : d->regs[(uint8_t)(d->ponteiro + i)];
+    }
+    return true;
+}
+
+// Operações bloqueantes da inicialização (tools/host/teste/hardware/i2c.h)
+int i2c_write_timeout_us(i2c_inst_t *i2c, uint8_t addr, const uint8_t *src, size_t len, bool nostop, uint timeout_us) {
+    (void)i2c, (void)nostop, (void)timeout_us;
+    bool ok = escrever(addr, src, len);
+    registrar('w', addr, ok);
+    return ok ? (int)len : -1;
+}
+
+int i2c_read_timeout_us(i2c_inst_t *i2c, uint8_t addr, uint8_t *dst, size_t len, bool nostop, uint timeout_us) {
+    (void)i2c, (void)nostop, (void)timeout_us;
+    bool ok = ler(addr, dst, len);
+    registrar('r', addr, ok);
+    return ok ? (int)len : -1;
+}
+
+// --- Fila simulada (lib/i2c_fila.h)
+
+struct i2c_inst {
+    int id;
+};
+
+static struct i2c_inst barramento = {0};
+static bool fila_ativa = false;
+static i2c_transacao_t *fila[32];
+static int n_fila = 0;
+static int na_fila_primeira_espera = -1; // Transações na fila na primeira espera do ciclo (-1 = sem espera)
+
+bool i2c_fila_ativa(i2c_inst_t *i2c) {
+    (void)i2c;
+    return fila_ativa;
+}
+
+bool i2c_fila_enviar(i2c_inst_t *i2c, i2c_transacao_t *t) {
+    (void)i2c;
+    if (n_fila >= (int)(sizeof(fila) / sizeof(fila[0]))) {
+        return false;
+    }
+    t->estado = I2C_TRANS_NA_FILA;
+    t->enfileirada_us = time_us_32();
+    fila[n_fila++] = t;
+    return true;
+}
+
+// Executa a transação mais antiga: M = seleção do canal, W = só escrita, R = escrita do registrador e leitura
+static void executar_proxima(void) {
+    i2c_transacao_t *t = fila[0];
+    memmove(fila, fila + 1, --n_fila * sizeof(fila[0]));
+    t->inicio_us = time_us_32();
+    uint8_t escrita[I2C_FILA_MAX_PALAVRAS];
+    size_t n = 0;
+    for (int i = 0; i < t->n_cabecalho; i++) {
+        escrita[n++] = t->cabecalho[i];
+    }
+    for (int i = 0; i < t->n_tx; i++) {
+        escrita[n++] = t->tx[i];
+    }
+    bool ok = (!n || escrever(t->endereco, escrita, n)) && (!t->n_rx || ler(t->endereco, t->rx, t->n_rx));
+    registrar(t->endereco == MUX ? 'M' : t->n_rx ? 'R' : 'W', t->endereco == MUX ? mux_mascara : t->endereco, ok);
+    t->fim_us = time_us_32();
+    t->estado = ok ? I2C_TRANS_OK : I2C_TRANS_ERRO;
+}
+
+bool i2c_fila_aguardar(i2c_transacao_t *t, uint32_t timeout_us) {
+    (void)timeout_us;
+    if (na_fila_primeira_espera < 0) {
+        na_fila_primeira_espera = n_fila;
+    }
+    while (!i2c_fila_concluida(t) && n_fila) {
+        executar_proxima();
+    }
+    return t->estado == I2C_TRANS_OK;
+}
+
+// --- Cenários
+
+// Um ciclo da amostragem: disparo, espera da conversão e coleta
+static void ciclo(uint32_t periodo_ms) {
+    registro[0] = '\0';
+    na_fila_primeira_espera = -1;
+    uint32_t espera = sensores_disparar();
+    avancar_ms(espera);
+    sensores_coletar();
+    avancar_ms(periodo_ms - espera);
+}
+
+// Coeficientes e valores brutos do exemplo da folha de dados do BMP280 (25,08 °C, ~100653 Pa)
+static const uint8_t calibracao[BMP280_CALIB_LEN] = {
+    0x70, 0x6B, 0x43, 0x67, 0x18, 0xFC, 0x7D, 0x8E, 0x43, 0xD6, 0xD0, 0x0B,
+    0x27, 0x0B, 0x8C, 0x00, 0xF9, 0xFF, 0x8C, 0x3C, 0xF8, 0xC6, 0x70, 0x17,
+};
+
+static void montar_dispositivos(void) {
+    const int canais[N_DISPOSITIVOS] = {0, 1, 2};
+    for (int i = 0; i < N_DISPOSITIVOS; i++) {
+        dispositivo_t *d = &dispositivos[i];
+        memset(d, 0, sizeof(*d));
+        d->canal = canais[i];
+        d->tipo = i == AHT_B ? SENSOR_AHT20 : SENSOR_BMP280;
+        d->endereco = i == AHT_B ? 0x38 : ADDR;
+        memcpy(&d->regs[REG_DIG_T1_LSB], calibracao, sizeof(calibracao));
+        d->temp_bruta = 519888;
+        d->pressao_bruta = 415148;
+        bmp280_converter_simulado(d); // Modo normal: os registradores sempre têm a última conversão
+        // AHT20: calibrado e livre; 50 % e 25 °C
+        const uint8_t quadro[AHT20_QUADRO_LEN] = {0x18, 0x80, 0x00, 0x06, 0x00, 0x00};
+        memcpy(d->quadro, quadro, sizeof(quadro));
+    }
+}
+
+static void testar_ciclo_normal(void) {
+    ciclo(600);
+    // Disparo do AHT20 (canal 1) e depois as leituras de cada canal, com uma troca de canal antes de cada uma
+    CHECAR(!strcmp(registro, "M02 W38 M01 R76 M02 R38 M04 R76"));
+    CHECAR(na_fila_primeira_espera == 8);
+
+    const sensor_t *a = sensores_obter(BMP_A);
+    const sensor_t *b = sensores_obter(AHT_B);
+    CHECAR(a->valido && fabsf(a->temperatura - 25.08f) < 0.01f && abs(a->pressao - 100653) <= 5);
+    CHECAR(b->valido && fabsf(b->umidade - 50.0f) < 0.01f && fabsf(b->temperatura - 25.0f) < 0.01f);
+    CHECAR(sensores_obter(BMP_C)->valido);
+
+    // Modo normal: mesma conversão relida antes do fim do período é repetida; depois do período, nova
+    uint32_t repetidas = a->repetidas;
+    ciclo(100); // Lida 600 ms depois da anterior: nova
+    CHECAR(a->valido && a->novas == 1 && a->repetidas == repetidas);
+    ciclo(600); // Relida 100 ms depois: mesma conversão
+    CHECAR(a->valido && a->novas == 0 && a->repetidas == repetidas + 1);
+    ciclo(600); // Mesmos valores brutos, mas um período depois: nova
+    CHECAR(a->valido && a->novas == 1 && a->repetidas == repetidas + 1);
+}
+
+static void testar_nack(void) {
+    dispositivos[BMP_C].nack = true;
+    for (int i = 0; i < SENSORES_FALHAS_MAX; i++) {
+        ciclo(600);
+        const sensor_t *c = sensores_obter(BMP_C);
+        CHECAR(!c->valido && c->falhas_seguidas == (uint32_t)(i + 1));
+        CHECAR(sensores_obter(BMP_A)->valido && sensores_obter(AHT_B)->valido);
+        CHECAR(!strcmp(registro, "M02 W38 M01 R76 M02 R38 M04 R76!"));
+    }
+    const sensor_t *c = sensores_obter(BMP_C);
+    CHECAR(c->saude == SENSOR_AUSENTE && !c->presente);
+
+    // Fora do ciclo: o canal 2 não aparece mais
+    ciclo(600);
+    CHECAR(!strcmp(registro, "M02 W38 M01 R76 M02 R38"));
+
+    // O sensor volta: reinicializado (calibração e configuração) depois da espera
+    dispositivos[BMP_C].nack = false;
+    avancar_ms(SENSORES_ESPERA_MIN_MS);
+    ciclo(600);
+    CHECAR(c->presente && c->saude == SENSOR_OK && c->reinicios == 1 && c->valido);
+}
+
+static void testar_modo_forcado(void) {
+    bmp280_config_t cfg = BMP280_CONFIG_PADRAO;
+    cfg.modo = BMP280_MODO_FORCADO;
+    CHECAR(sensores_configurar_bmp280(BMP_A, &cfg));
+    ciclo(600); // Aplica a configuração e faz a primeira conversão forçada
+
+    // Ar estável: conversões novas com os mesmos valores brutos
+    const sensor_t *a = sensores_obter(BMP_A);
+    uint32_t repetidas = a->repetidas;
+    uint32_t conversoes = dispositivos[BMP_A].conversoes;
+    ciclo(100);
+    CHECAR(dispositivos[BMP_A].conversoes == conversoes + 1);
+    CHECAR(a->valido && a->novas == 1 && a->repetidas == repetidas);
+
+    // Disparo recusado: os registradores ainda têm a conversão anterior
+    dispositivos[BMP_A].nack_escrita = true;
+    ciclo(100);
+    CHECAR(a->valido && a->novas == 0 && a->repetidas == repetidas + 1);
+    dispositivos[BMP_A].nack_escrita = false;
+}
+
+int main(void) {
+    montar_dispositivos();
+    CHECAR(sensores_registrar("bmp280_a", SENSOR_BMP280, 0, ADDR) == BMP_A);
+    CHECAR(sensores_registrar("aht20_b", SENSOR_AHT20, 1, 0x38) == AHT_B);
+    CHECAR(sensores_registrar("bmp280_c", SENSOR_BMP280, 2, ADDR) == BMP_C);
+    sensores_iniciar(&barramento);
+    for (int i = 0; i < N_DISPOSITIVOS; i++) {
+        CHECAR(sensores_obter(i)->presente);
+    }
+    fila_ativa = true;
+
+    testar_ciclo_normal();
+    testar_nack();
+    testar_modo_forcado();
+
+    printf("%s (%d falha%s)\n", falhas ? "FALHOU" : "OK", falhas, falhas == 1 ? "" : "s");
+    return falhas ? 1 : 0;
+}